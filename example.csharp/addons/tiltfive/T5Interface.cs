@@ -9,7 +9,8 @@ public partial class T5Interface : Node
 		E_SERVICE_STOPPED = 1,
 		E_SERVICE_RUNNING = 2,
 		E_SERVICE_T5_UNAVAILABLE = 3,
-		E_SERVICE_T5_INCOMPATIBLE_VERSION = 4
+		E_SERVICE_T5_INCOMPATIBLE_VERSION = 4,
+		E_SERVICE_T5_ATTENTION_REQUIRED = 5
 	}
 
 	enum GlassesEventType
@@ -73,6 +74,15 @@ public partial class T5Interface : Node
 		base._ExitTree();
 	}
 
+	public override void _Notification(int what)
+	{
+		// Textures of dropped glasses are kept for a while in case they come back
+		if (what == NotificationOsMemoryWarning && xrInterface != null)
+		{
+			xrInterface.Call("release_standby_textures");
+		}
+	}
+
 	public override void _Ready()
 	{
 		base._Ready();
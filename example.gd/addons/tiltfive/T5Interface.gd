@@ -54,6 +54,11 @@ func _exit_tree():
 		XRServer.remove_interface(tilt_five_xr_interface)
 		tilt_five_xr_interface = null
 
+func _notification(what):
+	# Textures of dropped glasses are kept for a while in case they come back
+	if what == NOTIFICATION_OS_MEMORY_WARNING and tilt_five_xr_interface:
+		tilt_five_xr_interface.release_standby_textures()
+
 func _ready():
 	if not t5_manager:
 		push_error("T5Manager is not set in T5Interface")
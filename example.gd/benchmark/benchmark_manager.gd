@@ -0,0 +1,30 @@
+extends "res://addons/tiltfive/T5ManagerBase.gd"
+## Reserves glasses up to glasses_allowed and gives each a T5XRRig
+
+const xr_rig_scene = preload("res://addons/tiltfive/scenes/T5XRRig.tscn")
+
+## Glasses beyond this count are left alone
+var glasses_allowed := 0
+
+var xr_rigs : Array[T5XRRig] = []
+var _accepted_ids : Array[String] = []
+
+func should_use_glasses(glasses_id : String) -> bool:
+	if _accepted_ids.has(glasses_id):
+		return true
+	if _accepted_ids.size() >= glasses_allowed:
+		return false
+	_accepted_ids.append(glasses_id)
+	return true
+
+func create_xr_rig(glasses_id : String) -> T5XRRig:
+	var xr_rig = xr_rig_scene.instantiate() as T5XRRig
+	xr_rig._glasses_id = glasses_id
+	add_child(xr_rig)
+	xr_rigs.append(xr_rig)
+	return xr_rig
+
+func release_xr_rig(xr_rig : T5XRRig) -> void:
+	xr_rigs.erase(xr_rig)
+	remove_child(xr_rig)
+	xr_rig.queue_free()
@@ -0,0 +1,160 @@
+extends Node3D
+## Measures how the per-frame CPU cost of the Tilt Five interface grows
+## with the number of glasses. For 1 to max glasses it reserves one more
+## glasses, each rendering this scene into its own SubViewport, then
+## reports the time per frame of _process, _pre_draw_viewport,
+## _end_frame and the service scheduler (part of _process).
+##
+## It runs against the mock NDK with no GPU. Build the mock with
+## `scons mock_library`, copy it over addons/tiltfive/bin/libTiltFiveNative.so
+## and run
+##
+##   T5MOCK_GLASSES=8 godot --headless --path example.gd res://benchmark/multi_glasses_benchmark.tscn -- --frames=300
+##
+## Engines that only draw for windows need a display instead, with
+## --rendering-driver dummy in place of --headless.
+##
+## Options after "--":
+##   --frames=N       frames measured per glasses count, 300
+##   --warmup=N       frames skipped after the glasses connect, 60
+##   --max-glasses=N  8
+##   --objects=N      boxes in the shared scene, 200
+##   --csv=PATH       also write the results as CSV
+##
+## Percentiles cover the last 512 frames, means every frame measured.
+
+const STAGES := ["process", "pre_draw_viewport", "end_frame", "scheduler"]
+const CONNECT_TIMEOUT_MSEC := 10000
+
+@onready var manager := $BenchmarkManager
+
+var frames := 300
+var warmup_frames := 60
+var max_glasses := 8
+var object_count := 200
+var csv_path := ""
+
+func _ready():
+	_parse_args()
+	_add_objects()
+	# The headless display server skips drawing unless an output other
+	# than a window needs it, engines without this can't run headless
+	if DisplayServer.has_method("register_additional_output"):
+		DisplayServer.call("register_additional_output", self)
+	_run.call_deferred()
+
+func _exit_tree():
+	if DisplayServer.has_method("unregister_additional_output"):
+		DisplayServer.call("unregister_additional_output", self)
+
+func _parse_args():
+	for arg in OS.get_cmdline_user_args():
+		var parts = arg.split("=", true, 1)
+		var value = parts[1] if parts.size() > 1 else ""
+		match parts[0]:
+			"--frames":
+				frames = max(1, value.to_int())
+			"--warmup":
+				warmup_frames = max(0, value.to_int())
+			"--max-glasses":
+				max_glasses = clamp(value.to_int(), 1, 8)
+			"--objects":
+				object_count = max(0, value.to_int())
+			"--csv":
+				csv_path = value
+			_:
+				push_warning("Unknown benchmark option " + arg)
+
+# A grid of boxes on the gameboard that every glasses draws
+func _add_objects():
+	var mesh := BoxMesh.new()
+	mesh.size = Vector3(0.02, 0.02, 0.02)
+	var columns := int(ceil(sqrt(object_count)))
+	for i in object_count:
+		var box := MeshInstance3D.new()
+		box.mesh = mesh
+		box.position = Vector3((i % columns) * 0.04 - columns * 0.02, 0.01, (i / columns) * 0.04 - columns * 0.02)
+		$Scene.add_child(box)
+
+func _run():
+	var xr_interface := T5Interface.get_tilt_five_xr_interface()
+	if not xr_interface or not xr_interface.is_initialized():
+		_finish([], "The Tilt Five interface didn't initialize")
+		return
+
+	var results := []
+	for glasses_count in range(1, max_glasses + 1):
+		manager.glasses_allowed = glasses_count
+		# Glasses already available are only offered again on an event
+		T5Interface._process_glasses()
+		if not await _wait_for_displays(glasses_count):
+			_finish(results, "Only %d glasses started, is T5MOCK_GLASSES at least %d?" % [manager.xr_rigs.size(), max_glasses])
+			return
+
+		for frame in warmup_frames:
+			await get_tree().process_frame
+		xr_interface.reset_frame_timings()
+		var start_usec := Time.get_ticks_usec()
+		for frame in frames:
+			await get_tree().process_frame
+		var frame_usec := float(Time.get_ticks_usec() - start_usec) / frames
+
+		var timings : Dictionary = xr_interface.get_frame_timings()
+		if timings["end_frame"]["frames"] == 0:
+			_finish(results, "No viewports were drawn. This engine doesn't draw with the headless display server, run with --rendering-driver dummy on a display (xvfb-run say) instead of --headless.")
+			return
+		results.append({ "glasses": glasses_count, "frame_usec": frame_usec, "timings": timings })
+		_print_row(results.back())
+
+	_finish(results, "")
+
+func _wait_for_displays(glasses_count : int) -> bool:
+	var end_msec := Time.get_ticks_msec() + CONNECT_TIMEOUT_MSEC
+	while manager.xr_rigs.size() < glasses_count:
+		if Time.get_ticks_msec() > end_msec:
+			return false
+		await get_tree().process_frame
+	return true
+
+func _print_row(result : Dictionary):
+	if result["glasses"] == 1:
+		print("Tilt Five frame stages, %d frames per glasses count, times in usec" % frames)
+		print("%-8s %-10s %-18s %10s %8s %8s %8s %8s" % ["glasses", "frame", "stage", "mean", "p50", "p95", "p99", "max"])
+	for stage in STAGES:
+		var timing : Dictionary = result["timings"][stage]
+		print("%-8d %-10.0f %-18s %10.1f %8d %8d %8d %8d" % [
+				result["glasses"],
+				result["frame_usec"],
+				stage,
+				timing["mean_usec"],
+				timing["p50_usec"],
+				timing["p95_usec"],
+				timing["p99_usec"],
+				timing["max_usec"]])
+
+func _finish(results : Array, error : String):
+	if not error.is_empty():
+		push_error(error)
+	if not csv_path.is_empty() and not results.is_empty():
+		_write_csv(results)
+	get_tree().quit(0 if error.is_empty() else 1)
+
+func _write_csv(results : Array):
+	var file := FileAccess.open(csv_path, FileAccess.WRITE)
+	if not file:
+		push_error("Couldn't write " + csv_path)
+		return
+	file.store_line("glasses,frame_usec,stage,frames,mean_usec,p50_usec,p95_usec,p99_usec,max_usec")
+	for result in results:
+		for stage in STAGES:
+			var timing : Dictionary = result["timings"][stage]
+			file.store_line("%d,%.1f,%s,%d,%.2f,%d,%d,%d,%d" % [
+					result["glasses"],
+					result["frame_usec"],
+					stage,
+					timing["frames"],
+					timing["mean_usec"],
+					timing["p50_usec"],
+					timing["p95_usec"],
+					timing["p99_usec"],
+					timing["max_usec"]])
@@ -0,0 +1,595 @@
+#include <Headless.h>
+#include <T5Mock.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Runs a full session against the mock NDK with no frame pacing and
+// reports what each stage of the per-frame work costs.
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+using T5Integration::CallSite;
+using T5Integration::CallSiteStats;
+using T5Integration::FrameTimer;
+using T5Integration::g_t5_exclusivity_group_1;
+using T5Headless::Glasses;
+using T5Headless::GlassesEvent;
+using T5Headless::HeadlessObjectRegistry;
+using T5Headless::HeadlessService;
+using T5Integration::WandButtons;
+using T5Integration::WandList;
+using T5Integration::WandRecording;
+using T5Integration::WandReplayMode;
+using T5Integration::WandService;
+
+using Clock = steady_clock;
+
+struct Options {
+	int glasses_count = 1;
+	int wands_per_glasses = 2;
+	int frames = 10000;
+	double pose_rate_hz = 0.0;
+	double wand_rate_hz = 0.0;
+	std::string record_wands;
+	std::string replay_wands;
+	int replay_passes = 20;
+	int contention_threads = 0;
+	int contention_hold_us = 50;
+	bool is_tracking_sweep = false;
+	bool is_frame_sweep = false;
+	int polling_seconds = 0;
+};
+
+class StageStats {
+public:
+	StageStats(const char* name) :
+			_name(name) {}
+
+	void add(Clock::duration elapsed) {
+		_samples.push_back(duration_cast<nanoseconds>(elapsed).count());
+	}
+
+	int64_t total() const {
+		int64_t sum = 0;
+		for (auto sample : _samples)
+			sum += sample;
+		return sum;
+	}
+
+	double mean() const {
+		return _samples.empty() ? 0.0 : static_cast<double>(total()) / _samples.size();
+	}
+
+	// In nanoseconds, 1.0 is the maximum
+	double percentile(double p) {
+		if (_samples.empty())
+			return 0.0;
+		std::sort(_samples.begin(), _samples.end());
+		return static_cast<double>(_samples[std::min(_samples.size() - 1, static_cast<size_t>(p * _samples.size()))]);
+	}
+
+	void print(int64_t frame_total) {
+		if (_samples.empty())
+			return;
+		auto sum = total();
+		std::printf("  %-18s %9.2f %9.2f %9.2f %9.2f %6.1f%%\n",
+				_name,
+				mean() / 1000.0,
+				percentile(0.50) / 1000.0,
+				percentile(0.99) / 1000.0,
+				percentile(1.0) / 1000.0,
+				frame_total > 0 ? 100.0 * sum / frame_total : 0.0);
+	}
+
+private:
+	const char* _name;
+	std::vector<int64_t> _samples;
+};
+
+class StageTimer {
+public:
+	StageTimer(StageStats& stats) :
+			_stats(stats), _start(Clock::now()) {}
+	~StageTimer() { _stats.add(Clock::now() - _start); }
+
+private:
+	StageStats& _stats;
+	Clock::time_point _start;
+};
+
+// Housekeeping load on exclusivity group 1: threads that each hold it
+// for a slow NDK call, back to back, as parameter queries would
+class BackgroundContention {
+public:
+	BackgroundContention(int thread_count, microseconds hold_time) {
+		for (int i = 0; i < thread_count; ++i) {
+			_threads.emplace_back([this, hold_time]() {
+				while (!_is_stopping) {
+					auto lock = g_t5_exclusivity_group_1.acquire(CallSite::PARAMETERS);
+					auto end_time = Clock::now() + hold_time;
+					while (Clock::now() < end_time) {
+					}
+				}
+			});
+		}
+	}
+
+	~BackgroundContention() {
+		_is_stopping = true;
+		for (auto& thread : _threads)
+			thread.join();
+	}
+
+private:
+	std::atomic_bool _is_stopping = false;
+	std::vector<std::thread> _threads;
+};
+
+std::vector<CallSiteStats> get_call_site_stats() {
+	std::vector<CallSiteStats> result;
+	for (int i = 0; i < static_cast<int>(CallSite::Count); ++i)
+		result.push_back(g_t5_exclusivity_group_1.get_stats(static_cast<CallSite>(i)));
+	return result;
+}
+
+void print_call_site_stats(const std::vector<CallSiteStats>& call_site_stats) {
+	std::printf("  %-18s %9s %9s %9s %9s %9s\n", "lock (us)", "calls", "contended", "mean wait", "max wait", "mean hold");
+	for (int i = 0; i < static_cast<int>(CallSite::Count); ++i) {
+		auto site = static_cast<CallSite>(i);
+		auto& stats = call_site_stats[i];
+		if (stats.acquisitions == 0)
+			continue;
+		std::printf("  %-18s %9llu %8.1f%% %9.2f %9.2f %9.2f\n",
+				T5Integration::call_site_name(site),
+				(unsigned long long)stats.acquisitions,
+				100.0 * stats.contended / stats.acquisitions,
+				stats.total_wait.count() / 1000.0 / stats.acquisitions,
+				stats.max_wait.count() / 1000.0,
+				stats.total_hold.count() / 1000.0 / stats.acquisitions);
+	}
+}
+
+// What the Godot layer reads from each wand every frame
+void read_wand_inputs(Glasses& glasses) {
+	float x, y, z, w;
+	WandButtons buttons;
+	for (int wand_idx = 0; wand_idx < glasses.get_num_wands(); ++wand_idx) {
+		if (!glasses.is_wand_pose_valid(wand_idx))
+			continue;
+		glasses.get_wand_position(wand_idx, x, y, z);
+		glasses.get_wand_orientation(wand_idx, x, y, z, w);
+		glasses.get_wand_linear_velocity(wand_idx, x, y, z);
+		glasses.get_wand_angular_velocity(wand_idx, x, y, z);
+		glasses.get_wand_trigger(wand_idx, x);
+		glasses.get_wand_stick(wand_idx, x, y);
+		glasses.get_wand_buttons(wand_idx, buttons);
+	}
+}
+
+bool parse_options(int argc, char** argv, Options& options) {
+	for (int i = 1; i < argc; ++i) {
+		auto has_value = i + 1 < argc;
+		if (!std::strcmp(argv[i], "--glasses") && has_value)
+			options.glasses_count = std::max(1, std::atoi(argv[++i]));
+		else if (!std::strcmp(argv[i], "--wands") && has_value)
+			options.wands_per_glasses = std::clamp(std::atoi(argv[++i]), 0, 2);
+		else if (!std::strcmp(argv[i], "--frames") && has_value)
+			options.frames = std::max(1, std::atoi(argv[++i]));
+		else if (!std::strcmp(argv[i], "--pose-hz") && has_value)
+			options.pose_rate_hz = std::atof(argv[++i]);
+		else if (!std::strcmp(argv[i], "--wand-hz") && has_value)
+			options.wand_rate_hz = std::atof(argv[++i]);
+		else if (!std::strcmp(argv[i], "--record-wands") && has_value)
+			options.record_wands = argv[++i];
+		else if (!std::strcmp(argv[i], "--replay-wands") && has_value)
+			options.replay_wands = argv[++i];
+		else if (!std::strcmp(argv[i], "--contention") && has_value)
+			options.contention_threads = std::max(0, std::atoi(argv[++i]));
+		else if (!std::strcmp(argv[i], "--contention-hold-us") && has_value)
+			options.contention_hold_us = std::max(0, std::atoi(argv[++i]));
+		else if (!std::strcmp(argv[i], "--tracking-sweep"))
+			options.is_tracking_sweep = true;
+		else if (!std::strcmp(argv[i], "--frame-sweep"))
+			options.is_frame_sweep = true;
+		else if (!std::strcmp(argv[i], "--polling") && has_value)
+			options.polling_seconds = std::max(1, std::atoi(argv[++i]));
+		else {
+			std::printf("usage: %s [--glasses N] [--wands 0-2] [--frames N] [--pose-hz HZ] [--wand-hz HZ] [--record-wands RECORDING]\n"
+						"          [--contention THREADS] [--contention-hold-us US]\n"
+						"       %s --replay-wands RECORDING\n"
+						"       %s --tracking-sweep [--frames N] [--contention THREADS] [--contention-hold-us US]\n"
+						"       %s --frame-sweep [--frames N] [--wands 0-2] [--pose-hz HZ] [--wand-hz HZ]\n"
+						"       %s --polling SECONDS\n"
+						"  rates of 0 (the default) produce new samples as fast as they are read\n"
+						"  contention threads hold the NDK lock as housekeeping calls would\n",
+					argv[0],
+					argv[0],
+					argv[0],
+					argv[0],
+					argv[0]);
+			return false;
+		}
+	}
+	return true;
+}
+
+// Input path cost: decode a wand recording and apply it to a WandService
+int bench_wand_replay(const Options& options) {
+	auto recording = WandRecording::open(options.replay_wands);
+	if (!recording) {
+		std::printf("Could not open wand recording %s\n", options.replay_wands.c_str());
+		return 1;
+	}
+
+	size_t event_count = 0;
+	T5_WandStreamEvent event;
+	WandRecording::Reader reader(*recording);
+	while (reader.next(event))
+		++event_count;
+
+	StageStats pass_stats("replay pass");
+	for (int pass = 0; pass < options.replay_passes; ++pass) {
+		StageTimer timer(pass_stats);
+		WandService service;
+		service.replay_from(recording, WandReplayMode::AS_FAST_AS_POSSIBLE);
+		service.start(nullptr);
+		while (!service.is_replay_finished())
+			std::this_thread::yield();
+		service.stop();
+	}
+
+	auto per_pass = pass_stats.total() / 1e9 / options.replay_passes;
+	std::printf("Wand replay: %zu events, %d passes\n", event_count, options.replay_passes);
+	std::printf("  %.0f events/s, %.1f ns/event\n", event_count / per_pass, per_pass * 1e9 / std::max<size_t>(event_count, 1));
+	return 0;
+}
+
+// update_tracking for 1 to 8 glasses, reading every pose under one
+// lock acquisition against one acquisition per glasses
+int bench_tracking_sweep(const Options& options) {
+	std::printf("Tracking update: %d frames, %d contention threads holding %dus\n", options.frames, options.contention_threads, options.contention_hold_us);
+	std::printf("  %-8s %-10s %9s %9s %9s %11s %11s\n", "glasses", "poses", "mean us", "p99 us", "max us", "lock waits", "max wait us");
+
+	for (int glasses_count = 1; glasses_count <= 8; ++glasses_count) {
+		auto config = T5Mock::make_config(glasses_count, 0);
+		config.pose_rate_hz = 0;
+		T5Mock::reset(config);
+
+		auto service = HeadlessObjectRegistry::service();
+		auto scheduler = T5Integration::ObjectRegistry::scheduler();
+		std::vector<GlassesEvent> events;
+		service->start_service("com.tiltfive.t5bench", "1.0");
+
+		auto all_tracking = [&]() {
+			if (service->get_glasses_count() != glasses_count)
+				return false;
+			for (int i = 0; i < glasses_count; ++i) {
+				if (!service->get_glasses(i)->is_tracking())
+					return false;
+			}
+			return true;
+		};
+		auto end_time = Clock::now() + 10s;
+		while (!all_tracking() && Clock::now() < end_time)
+			service->run_frame(events);
+		if (!all_tracking()) {
+			std::printf("Session did not reach tracking on %d glasses\n", glasses_count);
+			return 1;
+		}
+
+		for (bool is_batched : { true, false }) {
+			StageStats stats(is_batched ? "batched" : "per glasses");
+			auto contention = std::make_unique<BackgroundContention>(options.contention_threads, microseconds(options.contention_hold_us));
+			g_t5_exclusivity_group_1.reset_stats();
+
+			for (int frame = 0; frame < options.frames; ++frame) {
+				StageTimer timer(stats);
+				if (is_batched) {
+					service->update_tracking();
+				} else {
+					// What update_tracking did before batching
+					scheduler->schedule_tasks();
+					scheduler->log_exceptions([](auto) {});
+					for (int i = 0; i < glasses_count; ++i)
+						service->get_glasses(i)->update_tracking();
+				}
+			}
+			contention.reset();
+
+			auto pose_stats = g_t5_exclusivity_group_1.get_stats(CallSite::GLASSES_POSE);
+			std::printf("  %-8d %-10s %9.2f %9.2f %9.2f %11llu %11.2f\n",
+					glasses_count,
+					is_batched ? "batched" : "separate",
+					stats.mean() / 1000.0,
+					stats.percentile(0.99) / 1000.0,
+					stats.percentile(1.0) / 1000.0,
+					(unsigned long long)pose_stats.contended,
+					pose_stats.max_wait.count() / 1000.0);
+		}
+		service->stop_service();
+	}
+	return 0;
+}
+
+// The frame stages timed by the service's FrameTimer for 1 to 8
+// glasses, each connected and rendering. Means cover every frame,
+// the p99 and max the last RollingHistogram window of them.
+int bench_frame_sweep(const Options& options) {
+	const std::pair<FrameTimer::Stage, const char*> stages[] = {
+		{ FrameTimer::PROCESS, "process" },
+		{ FrameTimer::PRE_DRAW, "pre draw" },
+		{ FrameTimer::END_FRAME, "end frame" },
+		{ FrameTimer::SCHEDULER, "scheduler" },
+	};
+	std::printf("Frame stages: %d frames, %d wands per glasses\n", options.frames, options.wands_per_glasses);
+	std::printf("  %-8s", "glasses");
+	for (auto& [stage, name] : stages)
+		std::printf(" %29s", name);
+	std::printf("\n  %-8s", "");
+	for (size_t i = 0; i < std::size(stages); ++i)
+		std::printf(" %9s %9s %9s", "mean us", "p99 us", "max us");
+	std::printf("\n");
+
+	for (int glasses_count = 1; glasses_count <= 8; ++glasses_count) {
+		auto config = T5Mock::make_config(glasses_count, options.wands_per_glasses);
+		config.pose_rate_hz = options.pose_rate_hz;
+		config.wand_rate_hz = options.wand_rate_hz;
+		T5Mock::reset(config);
+
+		auto service = HeadlessObjectRegistry::service();
+		std::vector<GlassesEvent> events;
+		service->start_service("com.tiltfive.t5bench", "1.0");
+
+		auto all_tracking = [&]() {
+			if (service->get_glasses_count() != glasses_count)
+				return false;
+			for (int i = 0; i < glasses_count; ++i) {
+				if (!service->get_glasses(i)->is_tracking())
+					return false;
+			}
+			return true;
+		};
+		auto end_time = Clock::now() + 10s;
+		while (!all_tracking() && Clock::now() < end_time)
+			service->run_frame(events);
+		if (!all_tracking()) {
+			std::printf("Session did not reach tracking on %d glasses\n", glasses_count);
+			return 1;
+		}
+
+		auto frame_timer = service->get_frame_timer();
+		frame_timer->clear();
+		for (int frame = 0; frame < options.frames; ++frame) {
+			events.clear();
+			service->run_frame(events);
+		}
+
+		std::printf("  %-8d", glasses_count);
+		for (auto& [stage, name] : stages) {
+			auto report = frame_timer->get_report(stage);
+			double mean = report.frames ? report.total.count() / 1000.0 / report.frames : 0.0;
+			std::printf(" %9.2f %9lld %9lld", mean, (long long)report.summary.p99.count(), (long long)report.summary.max.count());
+		}
+		std::printf("\n");
+		service->stop_service();
+	}
+	return 0;
+}
+
+// Monitor polls of one connected, one idle and one unavailable
+// glasses with fixed intervals and with the adaptive policy
+int bench_polling(const Options& options) {
+	using T5Mock::Call;
+	std::printf("Monitor polling: 3 glasses (connected, idle, reserved elsewhere), %ds per policy\n", options.polling_seconds);
+	std::printf("  %-10s %18s %18s %12s\n", "policy", "state calls/min", "param calls/min", "total/min");
+
+	double fixed_total = 0.0;
+	for (bool is_adaptive : { false, true }) {
+		auto config = T5Mock::make_config(3, 0);
+		config.glasses[2].is_reserved_elsewhere = true;
+		T5Mock::reset(config);
+
+		auto service = HeadlessObjectRegistry::service();
+		service->set_reserve_filter([](int glasses_idx) { return glasses_idx != 1; });
+		if (!is_adaptive)
+			service->get_polling_policy()->use_fixed_rates(100ms, 2s);
+
+		std::vector<GlassesEvent> events;
+		service->start_service("com.tiltfive.t5bench", "1.0");
+		auto end_time = Clock::now() + seconds(options.polling_seconds);
+		while (Clock::now() < end_time) {
+			service->run_frame(events);
+			std::this_thread::sleep_for(16ms);
+		}
+		service->stop_service();
+
+		auto per_minute = 60.0 / options.polling_seconds;
+		auto state_calls = T5Mock::get_call_count(Call::GetGlassesConnectionState) * per_minute;
+		auto param_calls = T5Mock::get_call_count(Call::GetChangedGlassesParams) * per_minute;
+		param_calls += T5Mock::get_call_count(Call::GetChangedSystemParams) * per_minute;
+		auto total = state_calls + param_calls;
+		std::printf("  %-10s %18.1f %18.1f %12.1f\n", is_adaptive ? "adaptive" : "fixed", state_calls, param_calls, total);
+		if (is_adaptive)
+			std::printf("  saved %.1f calls/min\n", fixed_total - total);
+		fixed_total = total;
+	}
+	return 0;
+}
+
+int main(int argc, char** argv) {
+	Options options;
+	if (!parse_options(argc, argv, options))
+		return 2;
+
+	if (!options.replay_wands.empty())
+		return bench_wand_replay(options);
+
+	if (options.is_tracking_sweep) {
+		HeadlessObjectRegistry registry;
+		return bench_tracking_sweep(options);
+	}
+
+	if (options.is_frame_sweep) {
+		HeadlessObjectRegistry registry;
+		return bench_frame_sweep(options);
+	}
+
+	if (options.polling_seconds > 0) {
+		HeadlessObjectRegistry registry;
+		return bench_polling(options);
+	}
+
+	auto config = T5Mock::make_config(options.glasses_count, options.wands_per_glasses);
+	config.pose_rate_hz = options.pose_rate_hz;
+	config.wand_rate_hz = options.wand_rate_hz;
+	T5Mock::reset(config);
+
+	HeadlessObjectRegistry registry;
+	auto service = HeadlessObjectRegistry::service();
+	auto scheduler = T5Integration::ObjectRegistry::scheduler();
+	std::vector<GlassesEvent> events;
+
+	// Discovery and reserve are paced by the polling intervals in
+	// T5Integration so they are reported as wall time
+	auto session_start = Clock::now();
+	service->start_service("com.tiltfive.t5bench", "1.0");
+
+	auto run_until = [&](auto predicate, milliseconds timeout) {
+		auto end_time = Clock::now() + timeout;
+		while (Clock::now() < end_time) {
+			service->run_frame(events);
+			if (predicate())
+				return true;
+		}
+		return false;
+	};
+
+	bool is_started = run_until([&]() { return service->is_service_started(); }, 10s);
+	auto startup_time = Clock::now() - session_start;
+
+	bool is_discovered = is_started && run_until([&]() { return service->get_glasses_count() == options.glasses_count; }, 10s);
+	auto discovery_time = Clock::now() - session_start;
+
+	if (is_discovered && !options.record_wands.empty())
+		service->get_glasses(0)->set_wand_recording_path(options.record_wands);
+
+	auto all_tracking = [&]() {
+		for (int i = 0; i < options.glasses_count; ++i) {
+			if (!service->get_glasses(i)->is_tracking())
+				return false;
+		}
+		return true;
+	};
+	bool is_connected = is_discovered && run_until(all_tracking, 10s);
+	auto connect_time = Clock::now() - session_start;
+
+	if (!is_connected) {
+		std::printf("Session did not reach tracking on all glasses\n");
+		return 1;
+	}
+
+	std::vector<uint64_t> frames_before(options.glasses_count);
+	std::vector<uint64_t> wand_events_before(options.glasses_count);
+	for (int i = 0; i < options.glasses_count; ++i) {
+		frames_before[i] = T5Mock::get_frames_sent(i);
+		wand_events_before[i] = T5Mock::get_wand_events_read(i);
+	}
+
+	StageStats frame_stats("frame");
+	StageStats scheduler_stats("schedule_tasks");
+	StageStats connection_stats("update_connection");
+	StageStats tracking_stats("update_tracking");
+	StageStats event_stats("glasses_events");
+	StageStats wand_stats("wand_inputs");
+	StageStats send_stats("send_frame");
+
+	auto contention = std::make_unique<BackgroundContention>(options.contention_threads, microseconds(options.contention_hold_us));
+	g_t5_exclusivity_group_1.reset_stats();
+
+	auto steady_start = Clock::now();
+	for (int frame = 0; frame < options.frames; ++frame) {
+		StageTimer frame_timer(frame_stats);
+		{
+			StageTimer timer(scheduler_stats);
+			scheduler->schedule_tasks();
+		}
+		{
+			StageTimer timer(connection_stats);
+			service->update_connection();
+		}
+		{
+			StageTimer timer(tracking_stats);
+			service->update_tracking();
+		}
+		{
+			StageTimer timer(event_stats);
+			events.clear();
+			service->get_glasses_events(events);
+		}
+		{
+			StageTimer timer(wand_stats);
+			for (int i = 0; i < options.glasses_count; ++i)
+				read_wand_inputs(*service->get_glasses(i));
+		}
+		{
+			StageTimer timer(send_stats);
+			for (int i = 0; i < options.glasses_count; ++i) {
+				auto glasses = service->get_glasses(i);
+				glasses->begin_frame();
+				glasses->send_frame();
+			}
+		}
+	}
+	auto steady_time = duration<double>(Clock::now() - steady_start).count();
+	contention.reset();
+	auto call_site_stats = get_call_site_stats();
+
+	uint64_t frames_sent = 0;
+	uint64_t wand_events = 0;
+	for (int i = 0; i < options.glasses_count; ++i) {
+		frames_sent += T5Mock::get_frames_sent(i) - frames_before[i];
+		wand_events += T5Mock::get_wand_events_read(i) - wand_events_before[i];
+	}
+
+	std::vector<T5Integration::Glasses::BringUpTimes> bring_up_times;
+	for (int i = 0; i < options.glasses_count; ++i)
+		bring_up_times.push_back(service->get_glasses(i)->get_bring_up_times());
+
+	service->stop_service();
+
+	auto to_ms = [](Clock::duration d) { return duration<double, std::milli>(d).count(); };
+	auto since_start = [&](Clock::time_point time) { return time == Clock::time_point{} ? -1.0 : to_ms(time - session_start); };
+	std::printf("Session: %d glasses, %d wands each, %d frames\n", options.glasses_count, options.wands_per_glasses, options.frames);
+	std::printf("  service running   %9.1f ms\n", to_ms(startup_time));
+	std::printf("  glasses found     %9.1f ms\n", to_ms(discovery_time));
+	std::printf("  glasses tracking  %9.1f ms\n", to_ms(connect_time));
+	std::printf("  %-18s %9s %9s %9s %9s\n", "bring up (ms)", "created", "reserve", "connected", "1st frame");
+	for (int i = 0; i < options.glasses_count; ++i) {
+		auto& times = bring_up_times[i];
+		std::printf("  glasses %-10d %9.1f %9.1f %9.1f %9.1f\n",
+				i,
+				since_start(times.created),
+				since_start(times.reserve_requested),
+				since_start(times.connected),
+				since_start(times.first_frame));
+	}
+	std::printf("Steady state: %.0f frames/s, %.0f frames sent/s, %.0f wand events/s\n",
+			options.frames / steady_time,
+			frames_sent / steady_time,
+			wand_events / steady_time);
+	std::printf("  %-18s %9s %9s %9s %9s %7s\n", "stage (us)", "mean", "p50", "p99", "max", "share");
+	auto frame_total = frame_stats.total();
+	for (auto stats : { &scheduler_stats, &connection_stats, &tracking_stats, &event_stats, &wand_stats, &send_stats, &frame_stats })
+		stats->print(frame_total);
+	print_call_site_stats(call_site_stats);
+	std::printf("  exclusivity group 1 overlaps: %llu\n", (unsigned long long)T5Mock::get_exclusivity_violations());
+	return 0;
+}
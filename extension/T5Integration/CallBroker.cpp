@@ -0,0 +1,101 @@
+#include <CallBroker.h>
+#include <iterator>
+
+namespace T5Integration {
+
+const char* call_site_name(CallSite site) {
+	static const char* names[] = {
+		"glasses pose",
+		"connection",
+		"release",
+		"parameters",
+		"glasses handle",
+		"service",
+		"gameboard",
+		"haptics",
+		"wand stream",
+	};
+	static_assert(std::size(names) == static_cast<size_t>(CallSite::Count));
+	auto idx = static_cast<size_t>(site);
+	return idx < std::size(names) ? names[idx] : "unknown";
+}
+
+CallBroker::Lock CallBroker::acquire(CallSite site) {
+	bool is_hot = is_hot_call_site(site);
+	auto& stats = _stats[static_cast<size_t>(site)];
+
+	std::unique_lock lock(_access);
+	auto is_available = [this, is_hot]() { return !_is_held && (is_hot || _hot_waiting == 0); };
+
+	// Only read the clock for the wait when there is one
+	int64_t wait_ns = 0;
+	if (!is_available()) {
+		auto wait_start = Clock::now();
+		if (is_hot)
+			++_hot_waiting;
+		_released.wait(lock, is_available);
+		if (is_hot)
+			--_hot_waiting;
+		wait_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - wait_start).count();
+	}
+	_is_held = true;
+	if (_wait_histogram)
+		_wait_histogram->record(wait_ns / 1e6);
+	lock.unlock();
+
+	++stats.acquisitions;
+	if (wait_ns > 0) {
+		++stats.contended;
+		stats.total_wait_ns += wait_ns;
+		auto max_wait = stats.max_wait_ns.load();
+		while (wait_ns > max_wait && !stats.max_wait_ns.compare_exchange_weak(max_wait, wait_ns)) {
+		}
+	}
+	return Lock(this, site, Clock::now());
+}
+
+void CallBroker::release(CallSite site, Clock::time_point acquire_time) {
+	auto hold_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - acquire_time).count();
+	_stats[static_cast<size_t>(site)].total_hold_ns += hold_ns;
+
+	{
+		std::lock_guard lock(_access);
+		_is_held = false;
+	}
+	_released.notify_all();
+}
+
+void CallBroker::set_wait_histogram(Histogram* histogram) {
+	std::lock_guard lock(_access);
+	_wait_histogram = histogram;
+}
+
+void CallBroker::clear_wait_histogram(Histogram* histogram) {
+	std::lock_guard lock(_access);
+	if (_wait_histogram == histogram)
+		_wait_histogram = nullptr;
+}
+
+CallSiteStats CallBroker::get_stats(CallSite site) const {
+	auto& stats = _stats[static_cast<size_t>(site)];
+
+	CallSiteStats result;
+	result.acquisitions = stats.acquisitions;
+	result.contended = stats.contended;
+	result.total_wait = std::chrono::nanoseconds(stats.total_wait_ns);
+	result.max_wait = std::chrono::nanoseconds(stats.max_wait_ns);
+	result.total_hold = std::chrono::nanoseconds(stats.total_hold_ns);
+	return result;
+}
+
+void CallBroker::reset_stats() {
+	for (auto& stats : _stats) {
+		stats.acquisitions = 0;
+		stats.contended = 0;
+		stats.total_wait_ns = 0;
+		stats.max_wait_ns = 0;
+		stats.total_hold_ns = 0;
+	}
+}
+
+} //namespace T5Integration
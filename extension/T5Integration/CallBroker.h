@@ -0,0 +1,105 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <Metrics.h>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+namespace T5Integration {
+
+// Where an exclusivity group 1 call is made from. Calls made together
+// under one acquisition share a call site.
+enum class CallSite : uint8_t {
+	GLASSES_POSE,
+	CONNECTION,
+	RELEASE,
+	PARAMETERS,
+	GLASSES_HANDLE,
+	SERVICE,
+	GAMEBOARD,
+	HAPTICS,
+	WAND_STREAM,
+	Count
+};
+
+const char* call_site_name(CallSite site);
+
+// Hot call sites are made from the main thread every frame and are
+// granted the lock ahead of waiting housekeeping calls
+inline bool is_hot_call_site(CallSite site) {
+	return site == CallSite::GLASSES_POSE;
+}
+
+struct CallSiteStats {
+	uint64_t acquisitions = 0;
+	// Acquisitions that had to wait for another holder
+	uint64_t contended = 0;
+	std::chrono::nanoseconds total_wait{ 0 };
+	std::chrono::nanoseconds max_wait{ 0 };
+	std::chrono::nanoseconds total_hold{ 0 };
+};
+
+// Arbitrates the NDK calls of one exclusivity group. Only one caller
+// holds it at a time, hot call sites go ahead of housekeeping ones
+// and wait and hold times are tracked per call site.
+class CallBroker {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	class Lock {
+	public:
+		Lock(Lock&& other) noexcept :
+				_broker(std::exchange(other._broker, nullptr)), _site(other._site), _acquire_time(other._acquire_time) {}
+		Lock(const Lock&) = delete;
+		Lock& operator=(const Lock&) = delete;
+		~Lock() {
+			if (_broker)
+				_broker->release(_site, _acquire_time);
+		}
+
+	private:
+		friend CallBroker;
+		Lock(CallBroker* broker, CallSite site, Clock::time_point acquire_time) :
+				_broker(broker), _site(site), _acquire_time(acquire_time) {}
+
+		CallBroker* _broker;
+		CallSite _site;
+		Clock::time_point _acquire_time;
+	};
+
+	[[nodiscard]] Lock acquire(CallSite site);
+
+	CallSiteStats get_stats(CallSite site) const;
+	void reset_stats();
+
+	// Records the wait of every acquisition in milliseconds. Recorded
+	// under the broker's mutex, so once cleared the histogram is no
+	// longer used and can be freed.
+	void set_wait_histogram(Histogram* histogram);
+	// Stops recording into histogram, if it's still the one set
+	void clear_wait_histogram(Histogram* histogram);
+
+private:
+	struct AtomicStats {
+		std::atomic<uint64_t> acquisitions = 0;
+		std::atomic<uint64_t> contended = 0;
+		std::atomic<int64_t> total_wait_ns = 0;
+		std::atomic<int64_t> max_wait_ns = 0;
+		std::atomic<int64_t> total_hold_ns = 0;
+	};
+
+	void release(CallSite site, Clock::time_point acquire_time);
+
+	std::mutex _access;
+	std::condition_variable _released;
+	bool _is_held = false;
+	int _hot_waiting = 0;
+
+	std::array<AtomicStats, static_cast<size_t>(CallSite::Count)> _stats;
+	Histogram* _wait_histogram = nullptr;
+};
+
+} //namespace T5Integration
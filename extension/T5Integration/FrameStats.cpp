@@ -0,0 +1,106 @@
+#include <FrameStats.h>
+#include <algorithm>
+#include <bit>
+
+namespace T5Integration {
+
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+
+// Values below 8 have a bucket each. Above that each octave is split
+// into 8 buckets by the 3 bits after the leading one.
+int RollingHistogram::to_bucket(uint64_t usec) {
+	if (usec < 8)
+		return static_cast<int>(usec);
+	int octave = std::bit_width(usec) - 1;
+	int sub = static_cast<int>(usec >> (octave - 3)) & 7;
+	return std::min(8 + (octave - 3) * 8 + sub, bucket_count - 1);
+}
+
+// Middle of the bucket
+uint64_t RollingHistogram::from_bucket(int bucket) {
+	if (bucket < 8)
+		return bucket;
+	int octave = (bucket - 8) / 8 + 3;
+	uint64_t lower = static_cast<uint64_t>(8 + (bucket & 7)) << (octave - 3);
+	return lower + ((uint64_t(1) << (octave - 3)) >> 1);
+}
+
+void RollingHistogram::add(microseconds sample) {
+	auto bucket = to_bucket(static_cast<uint64_t>(std::max<int64_t>(sample.count(), 0)));
+	if (_count == window_size)
+		--_buckets[_window[_next]];
+	else
+		++_count;
+	_window[_next] = static_cast<uint8_t>(bucket);
+	++_buckets[bucket];
+	_next = (_next + 1) % window_size;
+}
+
+RollingHistogram::Summary RollingHistogram::get_summary() const {
+	return { _count, get_percentile(50), get_percentile(95), get_percentile(99), get_percentile(100) };
+}
+
+void RollingHistogram::clear() {
+	_buckets.fill(0);
+	_next = 0;
+	_count = 0;
+}
+
+microseconds RollingHistogram::get_percentile(int percent) const {
+	if (_count == 0)
+		return microseconds(0);
+	// Nearest rank
+	int rank = std::max((_count * percent + 99) / 100, 1);
+	int seen = 0;
+	for (int bucket = 0; bucket < bucket_count; ++bucket) {
+		seen += _buckets[bucket];
+		if (seen >= rank)
+			return microseconds(from_bucket(bucket));
+	}
+	return microseconds(from_bucket(bucket_count - 1));
+}
+
+void FrameStats::record_submit(Clock::time_point submit_start, Clock::time_point submit_end, std::optional<Clock::time_point> pose_time, T5_Result result) {
+	std::lock_guard lock(_access);
+	if (_last_submit != Clock::time_point{})
+		_submit_interval.add(duration_cast<microseconds>(submit_start - _last_submit));
+	_last_submit = submit_start;
+	_submit_duration.add(duration_cast<microseconds>(submit_end - submit_start));
+
+	if (result != T5_SUCCESS) {
+		++_errors[result];
+		return;
+	}
+	++_frames_submitted;
+	if (pose_time && *pose_time != Clock::time_point{})
+		_pose_age.add(duration_cast<microseconds>(submit_start - *pose_time));
+}
+
+void FrameStats::record_skip(Skip reason) {
+	std::lock_guard lock(_access);
+	if (reason == Skip::NOT_CONNECTED)
+		++_skipped_not_connected;
+	else
+		++_skipped_not_tracking;
+}
+
+void FrameStats::restart_interval() {
+	std::lock_guard lock(_access);
+	_last_submit = Clock::time_point{};
+}
+
+FrameStats::Report FrameStats::get_report() {
+	std::lock_guard lock(_access);
+	return {
+		_submit_interval.get_summary(),
+		_pose_age.get_summary(),
+		_submit_duration.get_summary(),
+		_frames_submitted,
+		_skipped_not_connected,
+		_skipped_not_tracking,
+		_errors
+	};
+}
+
+} //namespace T5Integration
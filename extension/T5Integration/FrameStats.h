@@ -0,0 +1,90 @@
+#pragma once
+#include <TiltFiveNative.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+
+namespace T5Integration {
+
+// Times of the last window_size samples, kept as counts in buckets
+// an eighth of an octave wide, so a percentile is within 12.5% of
+// the sample it stands for. Adding a sample is constant time.
+class RollingHistogram {
+public:
+	static constexpr int window_size = 512;
+
+	struct Summary {
+		// Samples in the window
+		int count;
+		std::chrono::microseconds p50;
+		std::chrono::microseconds p95;
+		std::chrono::microseconds p99;
+		std::chrono::microseconds max;
+	};
+
+	void add(std::chrono::microseconds sample);
+	Summary get_summary() const;
+	void clear();
+
+private:
+	static constexpr int bucket_count = 240;
+
+	static int to_bucket(uint64_t usec);
+	static uint64_t from_bucket(int bucket);
+	std::chrono::microseconds get_percentile(int percent) const;
+
+	std::array<uint16_t, bucket_count> _buckets{};
+	std::array<uint8_t, window_size> _window{};
+	int _next = 0;
+	int _count = 0;
+};
+
+// Frame pacing and submission results of one glasses. Frames are
+// recorded by the renderer and read from any thread.
+class FrameStats {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	enum class Skip {
+		NOT_CONNECTED,
+		NOT_TRACKING
+	};
+
+	struct Report {
+		// Between the starts of consecutive submits
+		RollingHistogram::Summary submit_interval;
+		// From the pose being read to the frame rendered
+		// from it being submitted, resent frames excluded
+		RollingHistogram::Summary pose_age;
+		// Time spent in t5SendFrameToGlasses
+		RollingHistogram::Summary submit_duration;
+		uint64_t frames_submitted;
+		uint64_t skipped_not_connected;
+		uint64_t skipped_not_tracking;
+		// Failed submits by result code
+		std::map<T5_Result, uint64_t> errors;
+	};
+
+	void record_submit(Clock::time_point submit_start, Clock::time_point submit_end, std::optional<Clock::time_point> pose_time, T5_Result result);
+	void record_skip(Skip reason);
+	// The next submit starts a new interval, after the display restarts
+	void restart_interval();
+
+	Report get_report();
+
+private:
+	std::mutex _access;
+	Clock::time_point _last_submit;
+	RollingHistogram _submit_interval;
+	RollingHistogram _pose_age;
+	RollingHistogram _submit_duration;
+	uint64_t _frames_submitted = 0;
+	uint64_t _skipped_not_connected = 0;
+	uint64_t _skipped_not_tracking = 0;
+	std::map<T5_Result, uint64_t> _errors;
+};
+
+} //namespace T5Integration
@@ -0,0 +1,36 @@
+#include <FrameTimer.h>
+
+namespace T5Integration {
+
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::nanoseconds;
+
+void FrameTimer::add(Stage stage, Clock::duration elapsed) {
+	_current[stage].fetch_add(duration_cast<nanoseconds>(elapsed).count(), std::memory_order_relaxed);
+}
+
+void FrameTimer::end_frame(Stage stage) {
+	auto frame = nanoseconds(_current[stage].exchange(0, std::memory_order_relaxed));
+
+	std::lock_guard lock(_access);
+	_frames[stage].add(duration_cast<microseconds>(frame));
+	++_frame_counts[stage];
+	_totals[stage] += frame;
+}
+
+FrameTimer::Report FrameTimer::get_report(Stage stage) {
+	std::lock_guard lock(_access);
+	return { _frames[stage].get_summary(), _frame_counts[stage], _totals[stage] };
+}
+
+void FrameTimer::clear() {
+	std::lock_guard lock(_access);
+	for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+		_frames[stage].clear();
+		_frame_counts[stage] = 0;
+		_totals[stage] = nanoseconds(0);
+	}
+}
+
+} //namespace T5Integration
@@ -0,0 +1,72 @@
+#pragma once
+#include <FrameStats.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace T5Integration {
+
+// CPU time spent in each stage of a frame. A stage can be timed
+// several times a frame, once per viewport for instance, and a frame
+// of that stage is the sum. Stages are timed on any thread, a frame of
+// a stage ends when its owner calls end_frame.
+class FrameTimer {
+public:
+	using Ptr = std::shared_ptr<FrameTimer>;
+	using Clock = std::chrono::steady_clock;
+
+	enum Stage {
+		// Main thread update of the interface, the scheduler included
+		PROCESS,
+		// Setting up every glasses viewport for drawing
+		PRE_DRAW,
+		// Submitting the frames of every glasses
+		END_FRAME,
+		// Running the service tasks due
+		SCHEDULER,
+		STAGE_COUNT
+	};
+
+	struct Report {
+		// Time per frame
+		RollingHistogram::Summary summary;
+		// Since the last clear, for the mean
+		uint64_t frames;
+		std::chrono::nanoseconds total;
+	};
+
+	// Times from construction to destruction
+	class Scope {
+	public:
+		Scope(FrameTimer& timer, Stage stage) :
+				_timer(timer), _stage(stage), _start(Clock::now()) {}
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+		~Scope() { _timer.add(_stage, Clock::now() - _start); }
+
+	private:
+		FrameTimer& _timer;
+		Stage _stage;
+		Clock::time_point _start;
+	};
+
+	void add(Stage stage, Clock::duration elapsed);
+	void end_frame(Stage stage);
+
+	Report get_report(Stage stage);
+	void clear();
+
+private:
+	// Nanoseconds of the frame in progress
+	std::array<std::atomic<int64_t>, STAGE_COUNT> _current{};
+
+	std::mutex _access;
+	std::array<RollingHistogram, STAGE_COUNT> _frames;
+	std::array<uint64_t, STAGE_COUNT> _frame_counts{};
+	std::array<std::chrono::nanoseconds, STAGE_COUNT> _totals{};
+};
+
+} //namespace T5Integration
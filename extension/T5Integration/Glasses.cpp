@@ -7,6 +7,7 @@
 using TaskSystem::run_in_foreground;
 using TaskSystem::run_now;
 using TaskSystem::task_sleep;
+using TaskSystem::task_sleep_until;
 
 namespace T5Integration {
 
@@ -21,6 +22,8 @@ Glasses::SwapChainFrame::SwapChainFrame() {
 	glasses_pose.gameboardType = kT5_GameboardType_None;
 	left_eye_handle = 0;
 	right_eye_handle = 0;
+	is_sent = false;
+	sent_render_frame = 0;
 }
 
 Glasses::Glasses(const std::string_view id) :
@@ -32,7 +35,11 @@ Glasses::Glasses(const std::string_view id) :
 	_previous_event_state.reset(GlassesState::UNAVAILABLE);
 	_previous_update_state.reset(GlassesState::UNAVAILABLE);
 
+	_tracked_pose = SwapChainFrame().glasses_pose;
+	_spectator_pose = _tracked_pose;
 	set_swap_chain_size(1);
+	publish_swap_chain();
+	take_swap_chain();
 }
 
 Glasses::~Glasses() {
@@ -40,14 +47,12 @@ Glasses::~Glasses() {
 }
 
 void Glasses::get_pose(T5_Vec3& out_position, T5_Quat& out_orientation) {
-	auto& pose = _swap_chain_frames[_current_frame_idx].glasses_pose;
-
-	out_position = pose.posGLS_GBD;
-	out_orientation = pose.rotToGLS_GBD;
+	out_position = _tracked_pose.posGLS_GBD;
+	out_orientation = _tracked_pose.rotToGLS_GBD;
 }
 
 void Glasses::get_glasses_position(float& out_pos_x, float& out_pos_y, float& out_pos_z) {
-	auto& pose = _swap_chain_frames[_current_frame_idx].glasses_pose;
+	auto& pose = _tracked_pose;
 
 	out_pos_x = pose.posGLS_GBD.x;
 	out_pos_y = pose.posGLS_GBD.y;
@@ -55,7 +60,7 @@ void Glasses::get_glasses_position(float& out_pos_x, float& out_pos_y, float& ou
 }
 
 void Glasses::get_glasses_orientation(float& out_quat_x, float& out_quat_y, float& out_quat_z, float& out_quat_w) {
-	auto& pose = _swap_chain_frames[_current_frame_idx].glasses_pose;
+	auto& pose = _tracked_pose;
 
 	out_quat_x = pose.rotToGLS_GBD.x;
 	out_quat_y = pose.rotToGLS_GBD.y;
@@ -63,6 +68,17 @@ void Glasses::get_glasses_orientation(float& out_quat_x, float& out_quat_y, floa
 	out_quat_w = pose.rotToGLS_GBD.w;
 }
 
+void Glasses::set_spectator_enabled(bool is_enabled) {
+	_is_spectator_enabled = is_enabled;
+	if (!is_enabled)
+		_is_spectator_tracking = false;
+}
+
+void Glasses::get_spectator_pose(T5_Vec3& out_position, T5_Quat& out_orientation) {
+	out_position = _spectator_pose.posGLS_GBD;
+	out_orientation = _spectator_pose.rotToGLS_GBD;
+}
+
 bool Glasses::is_wand_state_set(int wand_num, uint8_t flags) {
 	return wand_num < _wand_list.size() && (_wand_list[wand_num]._state & flags) == flags;
 }
@@ -104,6 +120,26 @@ void Glasses::get_wand_orientation(int wand_num, float& out_quat_x, float& out_q
 	}
 }
 
+void Glasses::get_wand_linear_velocity(int wand_num, float& out_vel_x, float& out_vel_y, float& out_vel_z) {
+	if (wand_num < _wand_list.size()) {
+		out_vel_x = _wand_list[wand_num]._pose.linearVelocity_GBD.x;
+		out_vel_y = _wand_list[wand_num]._pose.linearVelocity_GBD.y;
+		out_vel_z = _wand_list[wand_num]._pose.linearVelocity_GBD.z;
+	} else {
+		out_vel_x = out_vel_y = out_vel_z = 0;
+	}
+}
+
+void Glasses::get_wand_angular_velocity(int wand_num, float& out_vel_x, float& out_vel_y, float& out_vel_z) {
+	if (wand_num < _wand_list.size()) {
+		out_vel_x = _wand_list[wand_num]._pose.angularVelocity_GBD.x;
+		out_vel_y = _wand_list[wand_num]._pose.angularVelocity_GBD.y;
+		out_vel_z = _wand_list[wand_num]._pose.angularVelocity_GBD.z;
+	} else {
+		out_vel_x = out_vel_y = out_vel_z = 0;
+	}
+}
+
 void Glasses::get_wand_trigger(int wand_num, float& out_trigger) {
 	out_trigger = 0;
 	if (wand_num < _wand_list.size()) {
@@ -127,30 +163,123 @@ void Glasses::get_wand_buttons(int wand_num, WandButtons& buttons) {
 }
 
 void Glasses::trigger_haptic_pulse(int wand_num, float amplitude, uint16_t duration) {
+	// Sent from monitor_haptics so the caller never waits on the NDK
 	if (wand_num < _wand_list.size() && _state.is_current(GlassesState::CONNECTED)) {
-		std::lock_guard lock(g_t5_exclusivity_group_1);
-		t5SendImpulse(_glasses_handle, _wand_list[wand_num]._handle, amplitude, duration);
+		_haptic_queue.push(_wand_list[wand_num]._handle, amplitude, duration);
+		if (!_is_sending_haptics.exchange(true))
+			_scheduler->add_task(monitor_haptics());
 	}
 }
 
+void Glasses::set_wand_recording_path(const std::string_view path) {
+	_wand_recording_path = path;
+}
+
+void Glasses::set_wand_replay(WandRecording::Ptr recording, WandReplayMode mode) {
+	_wand_replay = recording;
+	_wand_replay_mode = mode;
+}
+
+void Glasses::set_session_recorder(SessionRecorder::Ptr recorder, int glasses_idx) {
+	_session_recorder = recorder;
+	_session_glasses_idx = glasses_idx;
+}
+
 void Glasses::set_swap_chain_size(int size) {
-	_swap_chain_frames.resize(size);
+	for (auto& frame : _pending_swap_chain)
+		retire_resources(std::move(frame.resources));
+	_pending_swap_chain.assign(size, SwapChainFrame());
+}
+
+Glasses::SwapChainStats Glasses::get_swap_chain_stats() {
+	return { static_cast<int>(_pending_swap_chain.size()), get_frames_in_flight(), _frames_sent, _early_reuses, _frames_resent, _display_start_time };
 }
 
 void Glasses::set_swap_chain_texture_pair(int swap_chain_idx, intptr_t left_eye_handle, intptr_t right_eye_handle) {
-	_swap_chain_frames[swap_chain_idx].left_eye_handle = left_eye_handle;
-	_swap_chain_frames[swap_chain_idx].right_eye_handle = right_eye_handle;
+	_pending_swap_chain[swap_chain_idx].left_eye_handle = left_eye_handle;
+	_pending_swap_chain[swap_chain_idx].right_eye_handle = right_eye_handle;
 }
 
 void Glasses::set_swap_chain_texture_array(int swap_chain_idx, intptr_t array_handle) {
-	_swap_chain_frames[swap_chain_idx].right_eye_handle = 0;
-	_swap_chain_frames[swap_chain_idx].left_eye_handle = array_handle;
+	_pending_swap_chain[swap_chain_idx].right_eye_handle = 0;
+	_pending_swap_chain[swap_chain_idx].left_eye_handle = array_handle;
+}
+
+void Glasses::set_swap_chain_resources(int swap_chain_idx, SwapChainResources::Ptr resources) {
+	retire_resources(std::move(_pending_swap_chain[swap_chain_idx].resources));
+	_pending_swap_chain[swap_chain_idx].resources = std::move(resources);
+}
+
+void Glasses::publish_swap_chain() {
+	_swap_chain_handoff.publish({ _pending_swap_chain, ++_published_generation });
+}
+
+void Glasses::retire_resources(SwapChainResources::Ptr resources) {
+	if (resources)
+		_retired_resources.push_back({ std::move(resources), _published_generation + 1 });
+}
+
+void Glasses::release_retired_resources() {
+	auto taken = _taken_generation.load(std::memory_order_acquire);
+	std::erase_if(_retired_resources, [taken](const RetiredResources& retired) { return retired.generation <= taken; });
+}
+
+void Glasses::take_swap_chain() {
+	PublishedSwapChain published;
+	if (!_swap_chain_handoff.take(published))
+		return;
+
+	// New slots start unsent with the latest pose. A frame sent
+	// before may use textures that are gone.
+	T5_GlassesPose pose = SwapChainFrame().glasses_pose;
+	Clock::time_point pose_time;
+	if (!_swap_chain_frames.empty()) {
+		pose = _swap_chain_frames[_current_frame_idx].glasses_pose;
+		pose_time = _swap_chain_frames[_current_frame_idx].pose_time;
+	}
+	_swap_chain_frames = std::move(published.frames);
+	for (auto& frame : _swap_chain_frames) {
+		frame.glasses_pose = pose;
+		frame.pose_time = pose_time;
+	}
+	_current_frame_idx = 0;
+	_last_frame.reset();
+	_taken_generation.store(published.generation, std::memory_order_release);
+}
+
+void Glasses::begin_frame() {
+	take_swap_chain();
+	SampledPose sampled;
+	if (_pose_handoff.take(sampled)) {
+		auto& frame = _swap_chain_frames[_current_frame_idx];
+		frame.glasses_pose = sampled.pose;
+		frame.pose_time = sampled.time;
+	}
+}
+
+bool Glasses::add_frame_time(std::chrono::microseconds cpu_time, std::chrono::microseconds gpu_time) {
+	auto scale = _render_scale.get_scale();
+	RenderScaleLimits limits;
+	if (_render_scale_limits.take(limits))
+		_render_scale.set_limits(limits);
+	if (_is_render_scale_reset.exchange(false))
+		_render_scale.reset();
+	_render_scale.add_frame_time(cpu_time, gpu_time);
+	_published_render_scale = _render_scale.get_scale();
+	return _render_scale.get_scale() != scale;
+}
+
+void Glasses::get_frame_pose(T5_Vec3& out_position, T5_Quat& out_orientation) {
+	auto& pose = _swap_chain_frames[_current_frame_idx].glasses_pose;
+
+	out_position = pose.posGLS_GBD;
+	out_orientation = pose.rotToGLS_GBD;
 }
 
 bool Glasses::allocate_handle(T5_Context context) {
 	T5_Result result;
 	{
-		std::lock_guard lock(g_t5_exclusivity_group_1);
+		auto lock = g_t5_exclusivity_group_1.acquire(CallSite::GLASSES_HANDLE);
 		result = t5CreateGlasses(context, _id.c_str(), &_glasses_handle);
 	}
 	if (result != T5_SUCCESS) {
@@ -159,7 +288,12 @@ bool Glasses::allocate_handle(T5_Context context) {
 	}
 	_state.set(GlassesState::CREATED);
 	_state.clear(GlassesState::UNAVAILABLE);
-	_scheduler->add_task(monitor_parameters());
+	_bring_up_times = BringUpTimes{};
+	_bring_up_times.created = Clock::now();
+	// Later changes are read by T5Service::watch_parameters. The name
+	// isn't needed to render so it doesn't hold up the IPD.
+	_scheduler->add_task(query_ipd());
+	_scheduler->add_task(query_friendly_name());
 
 	return true;
 }
@@ -167,24 +301,51 @@ bool Glasses::allocate_handle(T5_Context context) {
 void Glasses::destroy_handle() {
 	_state.clear_all();
 	{
-		std::lock_guard lock(g_t5_exclusivity_group_1);
+		auto lock = g_t5_exclusivity_group_1.acquire(CallSite::GLASSES_HANDLE);
 		t5DestroyGlasses(&_glasses_handle);
 	}
 	_glasses_handle = nullptr;
 }
 
+void Glasses::mark_removed() {
+	stop_display();
+	release_standby();
+	disconnect();
+	_state.clear(GlassesState::CREATED | GlassesState::CONNECTED | GlassesState::TRACKING);
+}
+
+bool Glasses::destroy_removed_handle() {
+	if (_state.is_current(GlassesState::TRACKING_WANDS))
+		return false;
+	destroy_handle();
+	return true;
+}
+
 CotaskPtr Glasses::monitor_connection() {
 	T5_Result result;
+	int captured_connection_state = 0;
+	int previous_connection_state = 0;
+	auto polling_policy = _polling_policy;
+	PollSchedule poll_schedule(*polling_policy);
+	// Kept across polls, the renderer sets GRAPHICS_INIT between them
+	GlassesFlags previous_monitor_state;
+	previous_monitor_state.sync_from(_state);
 
 	while (_glasses_handle && _state.is_current(GlassesState::SUSTAIN_CONNECTION)) {
 		T5_ConnectionState connectionState;
-		GlassesFlags _previous_monitor_state;
-
-		_previous_monitor_state.sync_from(_state);
 
+		// The reserve or ready call the state calls for is
+		// made under the same acquisition
+		T5_Result connect_result = T5_SUCCESS;
 		{
-			std::lock_guard lock(g_t5_exclusivity_group_1);
+			auto lock = g_t5_exclusivity_group_1.acquire(CallSite::CONNECTION);
 			result = t5GetGlassesConnectionState(_glasses_handle, &connectionState);
+			if (result == T5_SUCCESS) {
+				if (connectionState == kT5_ConnectionState_NotExclusivelyConnected)
+					connect_result = t5ReserveGlasses(_glasses_handle, _application_name.c_str());
+				else if (connectionState == kT5_ConnectionState_ExclusiveReservation || connectionState == kT5_ConnectionState_Disconnected)
+					connect_result = t5EnsureGlassesReady(_glasses_handle);
+			}
 		}
 		if (result != T5_SUCCESS) {
 			// Doesn't seem to be anything recoverable here
@@ -193,14 +354,19 @@ CotaskPtr Glasses::monitor_connection() {
 			_state.reset(GlassesState::ERROR);
 			co_return;
 		}
+		if (_session_recorder && connectionState != captured_connection_state) {
+			_session_recorder->record_connection(_session_glasses_idx, connectionState);
+			captured_connection_state = connectionState;
+		}
+		if (connectionState != previous_connection_state) {
+			poll_schedule.reset();
+			previous_connection_state = connectionState;
+		}
 
 		switch (connectionState) {
 			case kT5_ConnectionState_NotExclusivelyConnected: {
 				_state.clear(GlassesState::READY);
-				{
-					std::lock_guard lock(g_t5_exclusivity_group_1);
-					result = t5ReserveGlasses(_glasses_handle, _application_name.c_str());
-				}
+				result = connect_result;
 				if (result == T5_SUCCESS || result == T5_ERROR_ALREADY_CONNECTED)
 					continue;
 				else if (result == T5_ERROR_UNAVAILABLE) {
@@ -224,11 +390,7 @@ CotaskPtr Glasses::monitor_connection() {
 			case kT5_ConnectionState_ExclusiveReservation:
 			case kT5_ConnectionState_Disconnected: {
 				_state.clear(GlassesState::READY);
-
-				{
-					std::lock_guard lock(g_t5_exclusivity_group_1);
-					result = t5EnsureGlassesReady(_glasses_handle);
-				}
+				result = connect_result;
 				if (result == T5_SUCCESS)
 					continue;
 				else if (result == T5_ERROR_TRY_AGAIN) {
@@ -253,80 +415,66 @@ CotaskPtr Glasses::monitor_connection() {
 			}
 			case kT5_ConnectionState_ExclusiveConnection: {
 				_state.set(GlassesState::READY);
-				if (!_state.is_current(GlassesState::GRAPHICS_INIT)) {
-					co_await run_in_foreground;
-					initialize_graphics();
-				}
+				// The wand stream is configured in the background
+				// while the renderer initializes graphics
+				start_wand_stream();
+				if (!_state.is_current(GlassesState::GRAPHICS_INIT))
+					_is_graphics_init_requested = true;
 				break;
 			}
 		}
 
-		if (_state.any_changed(_previous_monitor_state, GlassesState::READY | GlassesState::GRAPHICS_INIT)) {
-			if (_state.is_current(GlassesState::READY | GlassesState::GRAPHICS_INIT))
+		GlassesFlags monitor_state;
+		monitor_state.sync_from(_state);
+		if (monitor_state.any_changed(previous_monitor_state, GlassesState::READY | GlassesState::GRAPHICS_INIT)) {
+			if (monitor_state.is_current(GlassesState::READY | GlassesState::GRAPHICS_INIT)) {
 				_state.set(GlassesState::CONNECTED);
-			else
+				if (_bring_up_times.connected == Clock::time_point{})
+					_bring_up_times.connected = Clock::now();
+			} else
 				_state.clear(GlassesState::CONNECTED);
 		}
-		if (_state.is_current(GlassesState::READY)) {
-			if (_state.set_and_was_toggled(GlassesState::TRACKING_WANDS)) {
-				_scheduler->add_task(monitor_wands());
-			}
-		}
+		previous_monitor_state.sync_from(monitor_state);
 
-		co_await task_sleep(
-				_state.is_current(GlassesState::CONNECTED) ? _poll_rate_for_monitoring : _poll_rate_for_connecting);
+		co_await task_sleep(poll_schedule.next(get_poll_state()));
 	}
 }
 
-CotaskPtr Glasses::monitor_parameters() {
-	co_await query_ipd();
-	co_await query_friendly_name();
-
-	T5_Result result;
-	std::vector<T5_ParamGlasses> _changed_params;
-
-	while (_glasses_handle && _state.is_current(GlassesState::CREATED)) {
-		co_await task_sleep(_poll_rate_for_monitoring);
-
-		uint16_t buffer_size = 16;
-		_changed_params.resize(buffer_size);
-		{
-			std::lock_guard lock(g_t5_exclusivity_group_1);
-			result = t5GetChangedGlassesParams(_glasses_handle, _changed_params.data(), &buffer_size);
-		}
-		if (result != T5_SUCCESS) {
-			co_await run_in_foreground;
-			LOG_T5_ERROR(result);
-			co_return;
-		}
-
-		if (buffer_size == 0)
-			continue;
+PollState Glasses::get_poll_state() {
+	if (_state.is_current(GlassesState::CONNECTED))
+		return PollState::CONNECTED;
+	if (_state.is_current(GlassesState::SUSTAIN_CONNECTION))
+		return PollState::CONNECTING;
+	if (_state.is_current(GlassesState::UNAVAILABLE))
+		return PollState::UNAVAILABLE;
+	return PollState::IDLE;
+}
 
-		_changed_params.resize(buffer_size);
-		for (auto param : _changed_params) {
-			switch (param) {
-				case kT5_ParamGlasses_Float_IPD: {
-					co_await query_ipd();
-				}
-				case kT5_ParamGlasses_UTF8_FriendlyName: {
-					co_await query_friendly_name();
-				}
-				default:
-					break;
-			}
-		}
+void Glasses::start_wand_stream() {
+	if (_state.set_and_was_toggled(GlassesState::TRACKING_WANDS)) {
+		_scheduler->add_task(monitor_wands());
 	}
 }
 
 CotaskPtr Glasses::monitor_wands() {
 	WandService wand_service;
+	wand_service.capture_to(_session_recorder, _session_glasses_idx);
+	wand_service.count_events_in(_metrics.wand_events);
+
+	bool is_recording_failed = !_wand_recording_path.empty() && !wand_service.record_to(_wand_recording_path);
+	if (_wand_replay) {
+		wand_service.replay_from(_wand_replay, _wand_replay_mode);
+	}
 
 	if (!wand_service.start(_glasses_handle))
 		co_return;
 
 	co_await run_in_foreground;
 
+	if (is_recording_failed) {
+		LOG_WARNING(("Could not open wand recording " + _wand_recording_path).c_str());
+	}
+
 	if (!wand_service.is_running()) {
 		_state.clear(GlassesState::TRACKING_WANDS);
 		LOG_T5_ERROR(wand_service.get_last_error());
@@ -353,12 +501,49 @@ CotaskPtr Glasses::monitor_wands() {
 	}
 }
 
+CotaskPtr Glasses::monitor_haptics() {
+	std::vector<HapticPulse> pulses;
+
+	while (_glasses_handle && _state.is_current(GlassesState::SUSTAIN_CONNECTION | GlassesState::TRACKING_WANDS)) {
+		T5_Result last_error = T5_SUCCESS;
+
+		_haptic_queue.take_ready(pulses);
+		if (!pulses.empty()) {
+			// All ready pulses go out under one acquisition
+			auto lock = g_t5_exclusivity_group_1.acquire(CallSite::HAPTICS);
+			for (auto& pulse : pulses) {
+				auto result = t5SendImpulse(_glasses_handle, pulse.wand_handle, pulse.amplitude, pulse.duration);
+				if (result != T5_SUCCESS)
+					last_error = result;
+			}
+		}
+		if (last_error != T5_SUCCESS) {
+			co_await run_in_foreground;
+			LOG_T5_ERROR(last_error);
+		}
+
+		auto next_send = _haptic_queue.get_next_send();
+		if (!next_send) {
+			// Ends once the queue is empty, trigger_haptic_pulse starts
+			// it again. A pulse queued before the flag was cleared is
+			// picked up here.
+			_is_sending_haptics = false;
+			if (!_haptic_queue.get_next_send() || _is_sending_haptics.exchange(true))
+				co_return;
+			continue;
+		}
+		co_await task_sleep_until(*next_send);
+	}
+	_haptic_queue.clear();
+	_is_sending_haptics = false;
+}
+
 CotaskPtr Glasses::query_ipd() {
 	double ipd;
 	T5_Result result;
 	for (int tries = 0; tries < 10; ++tries) {
 		{
-			std::lock_guard lock(g_t5_exclusivity_group_1);
+			auto lock = g_t5_exclusivity_group_1.acquire(CallSite::PARAMETERS);
 			result = t5GetGlassesFloatParam(_glasses_handle, 0, kT5_ParamGlasses_Float_IPD, &ipd);
 		}
 		if (result != T5_ERROR_NO_SERVICE && result != T5_ERROR_IO_FAILURE) {
@@ -366,6 +551,8 @@ CotaskPtr Glasses::query_ipd() {
 		}
 		co_await task_sleep(_poll_rate_for_connecting);
 	}
+	if (_session_recorder && result == T5_SUCCESS)
+		_session_recorder->record_parameter(_session_glasses_idx, kT5_ParamGlasses_Float_IPD, ipd);
 	co_await run_in_foreground;
 	if (result != T5_SUCCESS) {
 		LOG_T5_ERROR(result);
@@ -383,7 +570,7 @@ CotaskPtr Glasses::query_friendly_name() {
 	for (int tries = 0; tries < 10; ++tries) {
 		buffer_size = buffer.size();
 		{
-			std::lock_guard lock(g_t5_exclusivity_group_1);
+			auto lock = g_t5_exclusivity_group_1.acquire(CallSite::PARAMETERS);
 			result = t5GetGlassesUtf8Param(_glasses_handle, 0, kT5_ParamGlasses_UTF8_FriendlyName, buffer.data(), &buffer_size);
 		}
 		if (result == T5_ERROR_OVERFLOW) {
@@ -394,6 +581,8 @@ CotaskPtr Glasses::query_friendly_name() {
 		}
 		co_await task_sleep(_poll_rate_for_connecting);
 	}
+	if (_session_recorder && result == T5_SUCCESS)
+		_session_recorder->record_parameter(_session_glasses_idx, kT5_ParamGlasses_UTF8_FriendlyName, buffer.data());
 	co_await run_in_foreground;
 	if (result == T5_SUCCESS) {
 		buffer.resize(buffer_size);
@@ -407,6 +596,8 @@ CotaskPtr Glasses::query_friendly_name() {
 void Glasses::connect(const std::string_view application_name) {
 	if (_glasses_handle) {
 		_application_name = application_name;
+		if (_bring_up_times.reserve_requested == Clock::time_point{})
+			_bring_up_times.reserve_requested = Clock::now();
 
 		_state.set(GlassesState::SUSTAIN_CONNECTION);
 		_scheduler->add_task(monitor_connection());
@@ -417,7 +608,7 @@ void Glasses::disconnect() {
 	if (_state.is_current(GlassesState::READY)) {
 		T5_Result result;
 		{
-			std::lock_guard lock(g_t5_exclusivity_group_1);
+			auto lock = g_t5_exclusivity_group_1.acquire(CallSite::RELEASE);
 			result = t5ReleaseGlasses(_glasses_handle);
 		}
 		if (result != T5_SUCCESS) {
@@ -430,21 +621,58 @@ void Glasses::disconnect() {
 
 void Glasses::start_display() {
 	if (_state.set_and_was_toggled(GlassesState::DISPLAY_STARTED)) {
-		on_start_display();
+		auto start = Clock::now();
+		_is_render_scale_reset = true;
+		_published_render_scale = 1.0f;
+		// A slot can't be rendered into again until the frames in
+		// flight have passed since it was sent
+		int depth = std::max(_swap_chain_depth, get_frames_in_flight());
+		// Textures kept on standby are still set in the swap chain
+		if (is_on_standby() && depth == _pending_swap_chain.size()) {
+			_standby_expiry = Clock::time_point{};
+		} else {
+			release_standby();
+			set_swap_chain_size(depth);
+			on_start_display();
+		}
+		// Also drops the renderer's last frame, it isn't resent
+		// into a display that started again
+		publish_swap_chain();
+		_frame_stats.restart_interval();
+		_display_start_time = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
 	}
 }
 
 void Glasses::stop_display() {
 	if (_state.clear_and_was_toggled(GlassesState::DISPLAY_STARTED)) {
+		if (_standby_grace_period > 0ms) {
+			_standby_expiry = Clock::now() + _standby_grace_period;
+		} else {
+			on_stop_display();
+			publish_swap_chain();
+		}
+	}
+}
+
+void Glasses::release_standby() {
+	if (is_on_standby()) {
+		_standby_expiry = Clock::time_point{};
 		on_stop_display();
+		publish_swap_chain();
 	}
 }
 
+void Glasses::initialize_pending_graphics() {
+	if (_is_graphics_init_requested.exchange(false) && !_state.is_current(GlassesState::GRAPHICS_INIT))
+		initialize_graphics();
+}
+
 bool Glasses::initialize_graphics() {
 	auto service = ObjectRegistry::service();
 	auto graphics_api = service->get_graphics_api();
 	auto graphics_context = service->get_graphics_context_handle();
-	// t5 exclusivity group 3 - serialized in main thread
+	// t5 exclusivity group 3 - serialized in the render thread, which
+	// sends the frames
 	auto result = t5InitGlassesGraphicsContext(_glasses_handle, graphics_api, graphics_context);
 	// T5_ERROR_INVALID_STATE seems to mean previously initialized
 	bool is_graphics_initialized = (result == T5_SUCCESS || result == T5_ERROR_INVALID_STATE);
@@ -463,13 +691,29 @@ void Glasses::update_pose() {
 		return;
 
 	T5_Result result;
+	T5_GlassesPose pose;
+	T5_Result spectator_result = T5_SUCCESS;
+	T5_GlassesPose spectator_pose;
+	bool is_spectator = _is_spectator_enabled;
 	{
-		std::lock_guard lock(g_t5_exclusivity_group_1);
-		result = t5GetGlassesPose(_glasses_handle, kT5_GlassesPoseUsage_GlassesPresentation, &_swap_chain_frames[_current_frame_idx].glasses_pose);
+		auto lock = g_t5_exclusivity_group_1.acquire(CallSite::GLASSES_POSE);
+		result = t5GetGlassesPose(_glasses_handle, kT5_GlassesPoseUsage_GlassesPresentation, &pose);
+		if (is_spectator)
+			spectator_result = t5GetGlassesPose(_glasses_handle, kT5_GlassesPoseUsage_SpectatorPresentation, &spectator_pose);
 	}
+	apply_pose(result, pose);
+	if (is_spectator)
+		apply_spectator_pose(spectator_result, spectator_pose);
+}
+
+void Glasses::apply_pose(T5_Result result, const T5_GlassesPose& pose) {
+	if (_session_recorder)
+		_session_recorder->record_pose(_session_glasses_idx, result, pose);
 	bool isTracking = (result == T5_SUCCESS);
 
 	if (isTracking) {
+		_tracked_pose = pose;
+		_pose_handoff.publish({ pose, Clock::now() });
 		_state.set(GlassesState::TRACKING);
 	} else {
 		_state.clear(GlassesState::TRACKING);
@@ -487,6 +731,12 @@ void Glasses::update_pose() {
 	LOG_TOGGLE(false, isTracking, "Tracking started", "Tracking ended");
 }
 
+void Glasses::apply_spectator_pose(T5_Result result, const T5_GlassesPose& pose) {
+	_is_spectator_tracking = (result == T5_SUCCESS);
+	if (_is_spectator_tracking)
+		_spectator_pose = pose;
+}
+
 void Glasses::get_eye_position(Eye eye, T5_Vec3& pos) {
 	float dir = (eye == Left ? -1.0f : 1.0f);
 	auto ipd = get_ipd();
@@ -532,7 +782,8 @@ void Glasses::send_frame() {
 		frameInfo.leftTexHandle = (void*)_swap_chain_frames[_current_frame_idx].left_eye_handle;
 		frameInfo.rightTexHandle = (void*)_swap_chain_frames[_current_frame_idx].right_eye_handle;
 
-		auto& pose = _swap_chain_frames[_current_frame_idx].glasses_pose;
+		auto& frame = _swap_chain_frames[_current_frame_idx];
+		auto& pose = frame.glasses_pose;
 
 		get_eye_position(Left, frameInfo.posLVC_GBD);
 		frameInfo.rotToLVC_GBD = pose.rotToGLS_GBD;
@@ -543,23 +794,104 @@ void Glasses::send_frame() {
 		frameInfo.isUpsideDown = _is_upside_down_texture;
 		frameInfo.isSrgb = true;
 
-		// t5 exclusivity group 3 - serialized in main thread
-		T5_Result result = t5SendFrameToGlasses(_glasses_handle, &frameInfo);
-		_current_frame_idx = (_current_frame_idx + 1) % _swap_chain_frames.size();
+		T5_Result result = submit_frame(frameInfo, pose.timestampNanos, frame.pose_time);
+		_last_frame = frameInfo;
+		_last_frame_timestamp = pose.timestampNanos;
+		advance_swap_chain();
+		check_frame_result(result);
+	} else {
+		record_skipped_frame();
+	}
+}
 
-		LOG_TOGGLE(false, result == T5_SUCCESS, "Started sending frames", "Stoped sending frames");
-		if (result == T5_SUCCESS)
-			return;
-		LOG_T5_ERROR(result);
-		if (result == T5_ERROR_NOT_CONNECTED) {
-			_state.clear(GlassesState::CONNECTED);
-		}
-		// not sure how we might get here
-		else if (result == T5_ERROR_GFX_CONTEXT_INIT_FAIL || result == T5_ERROR_INVALID_GFX_CONTEXT) {
-			_state.clear(GlassesState::GRAPHICS_INIT);
-		} else {
-			_state.reset(GlassesState::ERROR);
+bool Glasses::should_render_frame() {
+	take_swap_chain();
+
+	bool is_requested = _is_render_requested.exchange(false);
+	bool should_render = true;
+	auto rate = _render_rate.load();
+	if (rate == RenderRate::HALF)
+		should_render = (_render_rate_tick++ % 2) == 0;
+	else if (rate == RenderRate::ON_CHANGE)
+		should_render = is_requested;
+
+	// Nothing to resend until a frame has been sent
+	return should_render || !_last_frame;
+}
+
+void Glasses::resend_frame() {
+	if (!_last_frame)
+		return;
+	if (_state.is_current(GlassesState::TRACKING | GlassesState::CONNECTED)) {
+		// The pose is as old as when it was rendered, its age
+		// would say how long the frame was resent for
+		T5_Result result = submit_frame(*_last_frame, _last_frame_timestamp, std::nullopt);
+		++_frames_resent;
+		check_frame_result(result);
+	} else {
+		record_skipped_frame();
+	}
+}
+
+T5_Result Glasses::submit_frame(const T5_FrameInfo& frame_info, uint64_t timestamp, std::optional<Clock::time_point> pose_time) {
+	// t5 exclusivity group 3 - serialized in main thread
+	auto submit_start = Clock::now();
+	T5_Result result = t5SendFrameToGlasses(_glasses_handle, &frame_info);
+	auto submit_end = Clock::now();
+	_frame_stats.record_submit(submit_start, submit_end, pose_time, result);
+	if (result == T5_SUCCESS && _metrics.frames_submitted)
+		_metrics.frames_submitted->add();
+	if (_session_recorder)
+		_session_recorder->record_frame(_session_glasses_idx, result, submit_end - submit_start, timestamp, frame_info);
+	return result;
+}
+
+void Glasses::record_skipped_frame() {
+	// Only frames a started display went without
+	if (!_state.is_current(GlassesState::DISPLAY_STARTED))
+		return;
+	if (!_state.is_current(GlassesState::CONNECTED))
+		_frame_stats.record_skip(FrameStats::Skip::NOT_CONNECTED);
+	else
+		_frame_stats.record_skip(FrameStats::Skip::NOT_TRACKING);
+}
+
+void Glasses::check_frame_result(T5_Result result) {
+	LOG_TOGGLE(false, result == T5_SUCCESS, "Started sending frames", "Stoped sending frames");
+	if (result == T5_SUCCESS) {
+		if (_bring_up_times.first_frame == Clock::time_point{}) {
+			_bring_up_times.first_frame = Clock::now();
+			auto time_to_first_frame = std::chrono::duration_cast<std::chrono::milliseconds>(_bring_up_times.first_frame - _bring_up_times.created);
+			log_message("Glasses ", _id, " first frame ", time_to_first_frame.count(), "ms after discovery");
 		}
+		return;
+	}
+	LOG_T5_ERROR(result);
+	if (result == T5_ERROR_NOT_CONNECTED) {
+		_state.clear(GlassesState::CONNECTED);
+	}
+	// not sure how we might get here
+	else if (result == T5_ERROR_GFX_CONTEXT_INIT_FAIL || result == T5_ERROR_INVALID_GFX_CONTEXT) {
+		_state.clear(GlassesState::GRAPHICS_INIT);
+	} else {
+		_state.reset(GlassesState::ERROR);
+	}
+}
+
+void Glasses::advance_swap_chain() {
+	auto render_frame = get_render_frame();
+	auto& sent = _swap_chain_frames[_current_frame_idx];
+	sent.is_sent = true;
+	sent.sent_render_frame = render_frame;
+	++_frames_sent;
+
+	// Round robin makes the next slot the one sent longest ago. It is
+	// rendered into in the next render frame.
+	_current_frame_idx = (_current_frame_idx + 1) % _swap_chain_frames.size();
+	auto& next = _swap_chain_frames[_current_frame_idx];
+	if (next.is_sent && next.sent_render_frame + get_frames_in_flight() > render_frame + 1) {
+		if (_early_reuses++ == 0)
+			LOG_WARNING("Swap chain slot rendered into before its last frame was copied");
 	}
 }
 
@@ -573,6 +905,10 @@ bool Glasses::update_connection() {
 	}
 	_previous_update_state.sync_from(_state);
 
+	if (is_on_standby() && Clock::now() >= _standby_expiry)
+		release_standby();
+	release_retired_resources();
+
 	return true;
 }
 
@@ -1,9 +1,16 @@
 #pragma once
 
+#include <FrameStats.h>
+#include <Handoff.h>
+#include <Metrics.h>
+#include <PollingPolicy.h>
+#include <RenderScale.h>
 #include <StateFlags.h>
 #include <T5Math.h>
 #include <TaskSystem.h>
 #include <Wand.h>
+#include <algorithm>
+#include <atomic>
 #include <optional>
 
 namespace T5Integration {
@@ -32,6 +39,15 @@ namespace GlassesState {
 }
 // clang-format on
 
+// How often a displayed glasses renders a new frame. Engine frames
+// that don't render resend the last frame instead.
+enum class RenderRate : uint8_t {
+	FULL,
+	HALF,
+	// Only after request_render, for a static scene say
+	ON_CHANGE
+};
+
 struct GlassesEvent {
 	// clang-format off
 	enum EType
@@ -56,19 +72,68 @@ struct GlassesEvent {
 	EType event;
 };
 
+// Metrics shared by all glasses. Unset ones aren't collected. Frame
+// timings are kept per glasses in FrameStats.
+struct GlassesMetrics {
+	// Keeps the metrics below alive
+	MetricsRegistry::Ptr registry;
+	Counter* frames_submitted = nullptr;
+	Counter* wand_events = nullptr;
+};
+
 class Glasses {
 	friend T5Service;
 
 protected:
+	// Textures behind a swap chain slot. The main thread releases its
+	// reference once the renderer has taken the swap chain that
+	// replaced them, so they are always freed on the main thread.
+	struct SwapChainResources {
+		using Ptr = std::shared_ptr<SwapChainResources>;
+		virtual ~SwapChainResources() = default;
+	};
+
 	struct SwapChainFrame {
 		SwapChainFrame();
-		T5_GlassesPose glasses_pose;
+		T5_GlassesPose glasses_pose{};
+		// When glasses_pose was read
+		std::chrono::steady_clock::time_point pose_time;
 		intptr_t left_eye_handle;
 		intptr_t right_eye_handle;
+		SwapChainResources::Ptr resources;
+		// Render frame the slot was last sent in
+		bool is_sent;
+		uint64_t sent_render_frame;
 	};
 
 public:
 	using Ptr = std::shared_ptr<Glasses>;
+	using Clock = std::chrono::steady_clock;
+
+	// When each bring up step first completed since the handle was
+	// allocated. Unset steps are Clock::time_point{}.
+	struct BringUpTimes {
+		Clock::time_point created;
+		Clock::time_point reserve_requested;
+		Clock::time_point connected;
+		Clock::time_point first_frame;
+	};
+
+	struct SwapChainStats {
+		// Slots allocated, at least the renderer's frames in flight
+		int depth;
+		int frames_in_flight;
+		uint64_t frames_sent;
+		// Slots rendered into before the copy from their last send
+		// could have finished
+		uint64_t early_reuses;
+		// Engine frames that sent the last frame again
+		// instead of rendering a new one
+		uint64_t frames_resent;
+		// Time the last display start spent setting up the swap
+		// chain, near zero when standby textures were reused
+		std::chrono::microseconds start_time;
+	};
 
 	enum Eye {
 		Mono,
@@ -87,22 +152,78 @@ public:
 
 	bool allocate_handle(T5_Context context);
 	void destroy_handle();
+	bool is_created();
 	void connect(const std::string_view application_name);
 	void disconnect();
 	void start_display();
 	void stop_display();
+	// Display textures are kept for the grace period after the display
+	// stops and reused if it starts again before the period ends
+	bool is_on_standby() const { return _standby_expiry != Clock::time_point{}; }
+	void release_standby();
 
 	float get_ipd();
 	float get_fov();
 	void get_display_size(int& out_width, int& out_height);
 
+	// Latest tracked pose, on the main thread
 	void get_pose(T5_Vec3& out_position, T5_Quat& out_orientation);
 
 	void get_glasses_position(float& out_pos_x, float& out_pos_y, float& out_pos_z);
 	void get_glasses_orientation(float& out_quat_x, float& out_quat_y, float& out_quat_z, float& out_quat_w);
 
+	// The spectator pose is smoothed for a steady view of what the
+	// player sees on a monitor. It's read with the glasses pose.
+	void set_spectator_enabled(bool is_enabled);
+	bool is_spectator_enabled() { return _is_spectator_enabled; }
+	bool is_spectator_tracking() { return _is_spectator_tracking; }
+	void get_spectator_pose(T5_Vec3& out_position, T5_Quat& out_orientation);
+
+	// The calls below are made by the renderer, which may run on its
+	// own thread. The main thread hands poses and swap chain changes
+	// over through locked copies.
+
+	// Initializes the graphics context once the connection monitor
+	// asks for it. The NDK only takes frames from the thread that
+	// provided the context, so the renderer calls this every frame
+	// before any send.
+	void initialize_pending_graphics();
+	// Takes the latest pose for the frame about to be rendered. All
+	// frame poses until the frame is sent are this one.
+	void begin_frame();
+	void get_frame_pose(T5_Vec3& out_position, T5_Quat& out_orientation);
+
 	int get_current_frame_idx() { return _current_frame_idx; }
 	void send_frame();
+	// Takes swap chain changes without rendering, so the main thread
+	// can free the textures they replaced. Called every frame for
+	// glasses that aren't rendered.
+	void take_swap_chain();
+
+	void set_render_rate(RenderRate rate) { _render_rate = rate; }
+	RenderRate get_render_rate() { return _render_rate.load(); }
+	void request_render() { _is_render_requested = true; }
+	// Called once per engine frame, before begin_frame. If false the
+	// frame isn't rendered and resend_frame replaces send_frame.
+	bool should_render_frame();
+	// The glasses warp the last frame from the pose it was
+	// rendered at, so it keeps tracking head motion
+	void resend_frame();
+
+	// Takes effect the next time the display starts. Two slots keep
+	// latency and memory down, three or more let rendering run ahead.
+	void set_swap_chain_depth(int depth) { _swap_chain_depth = std::max(depth, 1); }
+	int get_swap_chain_depth() { return _swap_chain_depth; }
+	SwapChainStats get_swap_chain_stats();
+	FrameStats::Report get_frame_stats() { return _frame_stats.get_report(); }
+
+	// Dynamic resolution. The renderer reports the time each frame
+	// took and applies the scale when this returns true. Limits set
+	// and display restarts on the main thread reach the controller
+	// with the renderer's next report.
+	void set_render_scale_limits(const RenderScaleLimits& limits) { _render_scale_limits.publish(limits); }
+	bool add_frame_time(std::chrono::microseconds cpu_time, std::chrono::microseconds gpu_time);
+	float get_render_scale() const { return _published_render_scale; }
 
 	void set_upside_down_texture(bool is_upside_down);
 
@@ -119,18 +240,47 @@ public:
 	bool is_wand_pose_valid(int wand_num);
 	void get_wand_position(int wand_num, float& out_pos_x, float& out_pos_y, float& out_pos_z);
 	void get_wand_orientation(int wand_num, float& out_quat_x, float& out_quat_y, float& out_quat_z, float& out_quat_w);
+	void get_wand_linear_velocity(int wand_num, float& out_vel_x, float& out_vel_y, float& out_vel_z);
+	void get_wand_angular_velocity(int wand_num, float& out_vel_x, float& out_vel_y, float& out_vel_z);
 	void get_wand_trigger(int wand_num, float& out_trigger);
 	void get_wand_stick(int wand_num, float& out_stick_x, float& out_stick_y);
 	void get_wand_buttons(int wand_num, WandButtons& buttons);
 
 	void trigger_haptic_pulse(int wand_num, float amplitude, uint16_t duration);
 
+	// Take effect the next time the wand stream starts.
+	// An empty path stops recording, a null recording stops replay.
+	void set_wand_recording_path(const std::string_view path);
+	void set_wand_replay(WandRecording::Ptr recording, WandReplayMode mode = WandReplayMode::REAL_TIME);
+
+	// Set before the glasses handle is allocated
+	void set_session_recorder(SessionRecorder::Ptr recorder, int glasses_idx);
+
+	// Set before the glasses handle is allocated
+	void set_polling_policy(PollingPolicy::Ptr policy) { _polling_policy = policy; }
+
+	// Set before the glasses handle is allocated
+	void set_metrics(const GlassesMetrics& metrics) { _metrics = metrics; }
+
+	// Zero frees display textures as soon as the display stops
+	void set_standby_grace_period(std::chrono::milliseconds period) { _standby_grace_period = period; }
+
+	const BringUpTimes& get_bring_up_times() const { return _bring_up_times; }
+
 	virtual void on_post_draw() {}
 
 protected:
+	// Main thread. Changes reach the renderer when the display
+	// starts or stops.
 	void set_swap_chain_size(int size);
+	int get_swap_chain_size() { return _pending_swap_chain.size(); }
 	void set_swap_chain_texture_pair(int swap_chain_idx, intptr_t left_eye_handle, intptr_t right_eye_handle);
 	void set_swap_chain_texture_array(int swap_chain_idx, intptr_t array_handle);
+	// Replaces the slot's resources, the old ones are kept until the
+	// renderer no longer uses them
+	void set_swap_chain_resources(int swap_chain_idx, SwapChainResources::Ptr resources);
+	// Renderer side, the resources of the slot being rendered
+	SwapChainResources* get_frame_resources() { return _swap_chain_frames[_current_frame_idx].resources.get(); }
 
 	virtual void on_start_display() {}
 	virtual void on_stop_display() {}
@@ -140,12 +290,26 @@ protected:
 	virtual void on_tracking_updated() {}
 	virtual void on_send_frame(int swap_chain_idx) {}
 
+	// Frame counter of the renderer and the frames it keeps in flight.
+	// GPU work queued while sending a frame in render frame F has
+	// finished by the time frame F + frames in flight is rendered.
+	virtual uint64_t get_render_frame() { return 0; }
+	virtual int get_frames_in_flight() { return 0; }
+
 	GlassesFlags::FlagType get_current_state();
 
 private:
+	// Called when the service stops listing the glasses. The handle is
+	// kept until the wand stream stops using it.
+	void mark_removed();
+	bool destroy_removed_handle();
+
+	PollState get_poll_state();
+
 	CotaskPtr monitor_connection();
-	CotaskPtr monitor_parameters();
+	void start_wand_stream();
 	CotaskPtr monitor_wands();
+	CotaskPtr monitor_haptics();
 	CotaskPtr query_ipd();
 	CotaskPtr query_friendly_name();
 
@@ -156,6 +320,19 @@ private:
 	void configure_wand_tracking();
 
 	void update_pose();
+	void publish_swap_chain();
+	void retire_resources(SwapChainResources::Ptr resources);
+	void release_retired_resources();
+	void advance_swap_chain();
+	T5_Result submit_frame(const T5_FrameInfo& frame_info, uint64_t timestamp, std::optional<Clock::time_point> pose_time);
+	void record_skipped_frame();
+	void check_frame_result(T5_Result result);
+	// Tracking state logic for a pose read by update_pose or
+	// T5Service::update_tracking
+	void apply_pose(T5_Result result, const T5_GlassesPose& pose);
+	// A failed spectator read leaves the glasses state alone, the
+	// glasses pose read with it reports the error
+	void apply_spectator_pose(T5_Result result, const T5_GlassesPose& pose);
 
 	void get_eye_position(Eye eye, T5_Vec3& pos);
 
@@ -163,6 +340,22 @@ private:
 	void end_reserved_state();
 
 private:
+	struct SampledPose {
+		T5_GlassesPose pose;
+		Clock::time_point time;
+	};
+
+	struct PublishedSwapChain {
+		std::vector<SwapChainFrame> frames;
+		uint64_t generation = 0;
+	};
+
+	struct RetiredResources {
+		SwapChainResources::Ptr resources;
+		// First published swap chain without them
+		uint64_t generation;
+	};
+
 	Scheduler::Ptr _scheduler;
 	T5Math::Ptr _math;
 
@@ -171,22 +364,79 @@ private:
 	std::string _friendly_name;
 	T5_Glasses _glasses_handle = nullptr;
 
+	// Main thread side of the pose and swap chain
+	T5_GlassesPose _tracked_pose;
+	bool _is_spectator_enabled = false;
+	bool _is_spectator_tracking = false;
+	T5_GlassesPose _spectator_pose;
+	std::vector<SwapChainFrame> _pending_swap_chain;
+	int _swap_chain_depth = 1;
+	std::chrono::microseconds _display_start_time{ 0 };
+	uint64_t _published_generation = 0;
+	std::vector<RetiredResources> _retired_resources;
+
+	Handoff<SampledPose> _pose_handoff;
+	Handoff<PublishedSwapChain> _swap_chain_handoff;
+	// Generation of the swap chain the renderer last took, after it
+	// dropped the one before
+	std::atomic<uint64_t> _taken_generation = 0;
+
+	// Renderer side
 	int _current_frame_idx = 0;
 	std::vector<SwapChainFrame> _swap_chain_frames;
-
-	float _ipd = 0.059f;
+	uint64_t _render_rate_tick = 0;
+	// Last frame sent since the swap chain was taken
+	std::optional<T5_FrameInfo> _last_frame;
+	uint64_t _last_frame_timestamp = 0;
+
+	std::atomic<uint64_t> _frames_sent = 0;
+	std::atomic<uint64_t> _early_reuses = 0;
+	std::atomic<uint64_t> _frames_resent = 0;
+	FrameStats _frame_stats;
+
+	std::atomic<RenderRate> _render_rate = RenderRate::FULL;
+	std::atomic<bool> _is_render_requested = false;
+	// Set by monitor_connection, cleared by the renderer when it
+	// makes the call
+	std::atomic<bool> _is_graphics_init_requested = false;
+
+	// Renderer side, with the main thread's changes handed over
+	RenderScaleController _render_scale;
+	Handoff<RenderScaleLimits> _render_scale_limits;
+	std::atomic<bool> _is_render_scale_reset = false;
+	std::atomic<float> _published_render_scale = 1.0f;
+
+	std::atomic<float> _ipd = 0.059f;
 
 	GlassesFlags _state;
 	GlassesFlags _previous_event_state;
 	GlassesFlags _previous_update_state;
 
-	bool _is_upside_down_texture = false;
+	std::atomic<bool> _is_upside_down_texture = false;
 
 	WandList _wand_list;
 	std::vector<uint8_t> _previous_wand_state;
+	HapticQueue _haptic_queue;
+	// Set while monitor_haptics is running
+	std::atomic<bool> _is_sending_haptics = false;
+
+	std::string _wand_recording_path;
+	WandRecording::Ptr _wand_replay;
+	WandReplayMode _wand_replay_mode = WandReplayMode::REAL_TIME;
+
+	SessionRecorder::Ptr _session_recorder;
+	int _session_glasses_idx = 0;
+	GlassesMetrics _metrics;
+
+	BringUpTimes _bring_up_times;
 
+	std::chrono::milliseconds _standby_grace_period = 10s;
+	Clock::time_point _standby_expiry;
+
+	PollingPolicy::Ptr _polling_policy = std::make_shared<PollingPolicy>();
+
+	// Retry interval for parameter queries
 	std::chrono::milliseconds _poll_rate_for_connecting = 100ms;
-	std::chrono::milliseconds _poll_rate_for_monitoring = 2s;
 	std::chrono::milliseconds _wait_time_for_wand_IO = 100s;
 };
 
@@ -202,6 +452,10 @@ inline bool Glasses::is_connected() {
 	return _state.is_current(GlassesState::CONNECTED);
 }
 
+inline bool Glasses::is_created() {
+	return _state.is_current(GlassesState::CREATED);
+}
+
 inline bool Glasses::is_available() {
 	return !(_state.is_current(GlassesState::SUSTAIN_CONNECTION) || _state.is_current(GlassesState::UNAVAILABLE));
 }
@@ -211,7 +465,7 @@ inline bool Glasses::is_tracking() {
 }
 
 inline float Glasses::get_ipd() {
-	return static_cast<float>(_ipd);
+	return _ipd.load();
 }
 
 inline float Glasses::get_fov() {
@@ -228,7 +482,7 @@ inline void Glasses::set_upside_down_texture(bool is_upside_down) {
 }
 
 inline T5_GameboardType Glasses::get_gameboard_type() {
-	return _swap_chain_frames[_current_frame_idx].glasses_pose.gameboardType;
+	return _tracked_pose.gameboardType;
 }
 
 inline GlassesFlags::FlagType Glasses::get_current_state() {
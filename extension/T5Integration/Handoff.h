@@ -0,0 +1,39 @@
+#pragma once
+#include <mutex>
+#include <utility>
+
+namespace T5Integration {
+
+// Passes whole values from one thread to another. The writer publishes
+// a value, the reader takes the latest one. Values published between
+// takes are replaced, not queued. A take moves the value out, so the
+// writer's side holds none of it afterwards. The lock is only held
+// for the copy or move.
+template <typename T>
+class Handoff {
+public:
+	void publish(const T& value) {
+		std::lock_guard lock(_access);
+		_value = value;
+		_is_new = true;
+	}
+
+	// Returns false, leaving out_value alone, if nothing was
+	// published since the last take
+	bool take(T& out_value) {
+		std::lock_guard lock(_access);
+		if (!_is_new)
+			return false;
+		out_value = std::move(_value);
+		_value = T{};
+		_is_new = false;
+		return true;
+	}
+
+private:
+	std::mutex _access;
+	T _value{};
+	bool _is_new = false;
+};
+
+} //namespace T5Integration
@@ -0,0 +1,102 @@
+#include <MappedFile.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace T5Integration {
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path) {
+	close();
+
+	auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+		CloseHandle(file);
+		return false;
+	}
+
+	auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping) {
+		CloseHandle(file);
+		return false;
+	}
+
+	auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!view) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	_file = file;
+	_mapping = mapping;
+	_data = static_cast<const uint8_t*>(view);
+	_size = static_cast<size_t>(file_size.QuadPart);
+	return true;
+}
+
+void MappedFile::close() {
+	if (_data)
+		UnmapViewOfFile(_data);
+	if (_mapping)
+		CloseHandle(_mapping);
+	if (_file)
+		CloseHandle(_file);
+	_data = nullptr;
+	_mapping = nullptr;
+	_file = nullptr;
+	_size = 0;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path) {
+	close();
+
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+		::close(fd);
+		return false;
+	}
+
+	auto view = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping stays valid after the descriptor is closed
+	::close(fd);
+	if (view == MAP_FAILED)
+		return false;
+
+	_data = static_cast<const uint8_t*>(view);
+	_size = static_cast<size_t>(file_stat.st_size);
+	return true;
+}
+
+void MappedFile::close() {
+	if (_data)
+		munmap(const_cast<uint8_t*>(_data), _size);
+	_data = nullptr;
+	_size = 0;
+}
+
+#endif
+
+} //namespace T5Integration
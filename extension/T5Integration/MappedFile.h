@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace T5Integration {
+
+// Read only memory mapping of a whole file
+class MappedFile {
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool open(const std::string& path);
+	void close();
+
+	bool is_open() const { return _data != nullptr; }
+	const uint8_t* data() const { return _data; }
+	size_t size() const { return _size; }
+
+private:
+	const uint8_t* _data = nullptr;
+	size_t _size = 0;
+#ifdef _WIN32
+	void* _file = nullptr;
+	void* _mapping = nullptr;
+#endif
+};
+
+} //namespace T5Integration
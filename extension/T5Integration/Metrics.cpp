@@ -0,0 +1,158 @@
+#include <Metrics.h>
+#include <algorithm>
+
+namespace T5Integration {
+
+Histogram::Histogram(std::vector<double> upper_bounds) :
+		_upper_bounds(std::move(upper_bounds)),
+		_counts(new std::atomic<uint64_t>[_upper_bounds.size() + 1]) {
+	std::sort(_upper_bounds.begin(), _upper_bounds.end());
+	for (size_t idx = 0; idx <= _upper_bounds.size(); ++idx)
+		_counts[idx] = 0;
+}
+
+void Histogram::record(double value) {
+	auto bucket = std::lower_bound(_upper_bounds.begin(), _upper_bounds.end(), value) - _upper_bounds.begin();
+	_counts[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+std::vector<uint64_t> Histogram::get_counts() const {
+	std::vector<uint64_t> counts(_upper_bounds.size() + 1);
+	for (size_t idx = 0; idx < counts.size(); ++idx)
+		counts[idx] = _counts[idx].load(std::memory_order_relaxed);
+	return counts;
+}
+
+MetricsRegistry::MetricsRegistry(std::chrono::milliseconds window) :
+		_window_length(window) {}
+
+Counter& MetricsRegistry::add_counter(const std::string& name) {
+	std::lock_guard lock(_access);
+	auto& metric = add_metric(name);
+	metric.counter = std::make_unique<Counter>();
+	metric.window.start_counts.assign(1, 0);
+	metric.window.last_counts.assign(1, 0);
+	add_monitor(name, Reading::VALUE);
+	add_monitor(name + " per second", Reading::RATE);
+	return *metric.counter;
+}
+
+Gauge& MetricsRegistry::add_gauge(const std::string& name) {
+	std::lock_guard lock(_access);
+	auto& metric = add_metric(name);
+	metric.gauge = std::make_unique<Gauge>();
+	add_monitor(name, Reading::VALUE);
+	return *metric.gauge;
+}
+
+Histogram& MetricsRegistry::add_histogram(const std::string& name, std::vector<double> upper_bounds) {
+	std::lock_guard lock(_access);
+	auto& metric = add_metric(name);
+	metric.histogram = std::make_unique<Histogram>(std::move(upper_bounds));
+	auto bucket_count = metric.histogram->get_upper_bounds().size() + 1;
+	metric.window.start_counts.assign(bucket_count, 0);
+	metric.window.last_counts.assign(bucket_count, 0);
+	add_monitor(name + " p50", Reading::P50);
+	add_monitor(name + " p95", Reading::P95);
+	add_monitor(name + " p99", Reading::P99);
+	return *metric.histogram;
+}
+
+void MetricsRegistry::add_probe(const std::string& name, std::function<double()> probe) {
+	std::lock_guard lock(_access);
+	auto& metric = add_metric(name);
+	metric.probe = std::move(probe);
+	add_monitor(name, Reading::VALUE);
+}
+
+int MetricsRegistry::get_monitor_count() {
+	std::lock_guard lock(_access);
+	return static_cast<int>(_monitors.size());
+}
+
+std::string MetricsRegistry::get_monitor_name(int monitor_idx) {
+	std::lock_guard lock(_access);
+	if (monitor_idx < 0 || monitor_idx >= static_cast<int>(_monitors.size()))
+		return {};
+	return _monitors[monitor_idx].name;
+}
+
+double MetricsRegistry::read_monitor(int monitor_idx) {
+	std::lock_guard lock(_access);
+	if (monitor_idx < 0 || monitor_idx >= static_cast<int>(_monitors.size()))
+		return 0.0;
+	auto& monitor = _monitors[monitor_idx];
+	auto& metric = *_metrics[monitor.metric_idx];
+
+	if (metric.probe)
+		return metric.probe();
+	if (metric.gauge)
+		return metric.gauge->get();
+	if (metric.counter) {
+		if (monitor.reading == Reading::VALUE)
+			return static_cast<double>(metric.counter->get());
+		update_window(metric, { metric.counter->get() });
+		auto length = metric.window.last_length.count();
+		return length > 0.0 ? metric.window.last_counts[0] / length : 0.0;
+	}
+
+	update_window(metric, metric.histogram->get_counts());
+	switch (monitor.reading) {
+		case Reading::P50:
+			return get_percentile(metric, 0.5);
+		case Reading::P95:
+			return get_percentile(metric, 0.95);
+		case Reading::P99:
+			return get_percentile(metric, 0.99);
+		default:
+			return 0.0;
+	}
+}
+
+MetricsRegistry::Metric& MetricsRegistry::add_metric(const std::string& name) {
+	auto& metric = _metrics.emplace_back(std::make_unique<Metric>());
+	metric->name = name;
+	metric->window.start = Clock::now();
+	return *metric;
+}
+
+void MetricsRegistry::add_monitor(const std::string& name, Reading reading) {
+	_monitors.push_back({ name, static_cast<int>(_metrics.size()) - 1, reading });
+}
+
+void MetricsRegistry::update_window(Metric& metric, std::vector<uint64_t> counts) {
+	// The monitors of a metric are read one after another, they all
+	// report the same whole window until the next one ends
+	auto& window = metric.window;
+	auto now = Clock::now();
+	if (now - window.start < _window_length)
+		return;
+	for (size_t idx = 0; idx < counts.size(); ++idx)
+		window.last_counts[idx] = counts[idx] - window.start_counts[idx];
+	window.last_length = now - window.start;
+	window.start = now;
+	window.start_counts = std::move(counts);
+}
+
+double MetricsRegistry::get_percentile(const Metric& metric, double percentile) {
+	auto& counts = metric.window.last_counts;
+	uint64_t total = 0;
+	for (auto count : counts)
+		total += count;
+	if (total == 0)
+		return 0.0;
+
+	// Upper bound of the bucket holding the nearest rank,
+	// the overflow bucket reports the last bound
+	auto& upper_bounds = metric.histogram->get_upper_bounds();
+	auto rank = std::max<uint64_t>(static_cast<uint64_t>(total * percentile + 0.999999), 1);
+	uint64_t seen = 0;
+	for (size_t idx = 0; idx < counts.size(); ++idx) {
+		seen += counts[idx];
+		if (seen >= rank)
+			return upper_bounds.empty() ? 0.0 : upper_bounds[std::min(idx, upper_bounds.size() - 1)];
+	}
+	return upper_bounds.empty() ? 0.0 : upper_bounds.back();
+}
+
+} //namespace T5Integration
@@ -0,0 +1,122 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace T5Integration {
+
+// Metrics are written with relaxed atomics and never lock. Rates and
+// percentiles are worked out by the registry when a monitor is read,
+// so nothing is computed for monitors no one reads.
+
+// A count that only goes up
+class Counter {
+public:
+	void add(uint64_t count = 1) { _value.fetch_add(count, std::memory_order_relaxed); }
+	uint64_t get() const { return _value.load(std::memory_order_relaxed); }
+
+private:
+	std::atomic<uint64_t> _value = 0;
+};
+
+// The latest value set by its owner
+class Gauge {
+public:
+	void set(double value) { _value.store(value, std::memory_order_relaxed); }
+	double get() const { return _value.load(std::memory_order_relaxed); }
+
+private:
+	std::atomic<double> _value = 0.0;
+};
+
+// Counts of samples in buckets with fixed upper bounds. Samples over
+// the last bound land in an overflow bucket.
+class Histogram {
+public:
+	explicit Histogram(std::vector<double> upper_bounds);
+	Histogram(const Histogram&) = delete;
+	Histogram& operator=(const Histogram&) = delete;
+
+	void record(double value);
+
+	const std::vector<double>& get_upper_bounds() const { return _upper_bounds; }
+	// Counts of each bucket, the overflow bucket last
+	std::vector<uint64_t> get_counts() const;
+
+private:
+	std::vector<double> _upper_bounds;
+	std::unique_ptr<std::atomic<uint64_t>[]> _counts;
+};
+
+class MetricsRegistry {
+public:
+	using Ptr = std::shared_ptr<MetricsRegistry>;
+	using Clock = std::chrono::steady_clock;
+
+	// Rates and percentiles cover the last whole window before the read
+	explicit MetricsRegistry(std::chrono::milliseconds window = std::chrono::milliseconds(1000));
+
+	// Adds the monitors "<name>" and "<name> per second"
+	Counter& add_counter(const std::string& name);
+	// Adds the monitor "<name>"
+	Gauge& add_gauge(const std::string& name);
+	// Adds the monitors "<name> p50", "<name> p95" and "<name> p99"
+	Histogram& add_histogram(const std::string& name, std::vector<double> upper_bounds);
+	// Adds the monitor "<name>", read by calling probe
+	void add_probe(const std::string& name, std::function<double()> probe);
+
+	int get_monitor_count();
+	std::string get_monitor_name(int monitor_idx);
+	double read_monitor(int monitor_idx);
+
+private:
+	enum class Reading {
+		VALUE,
+		RATE,
+		P50,
+		P95,
+		P99
+	};
+
+	// Samples of a counter or histogram at the start of the
+	// current window and over the last whole one
+	struct Window {
+		Clock::time_point start;
+		std::vector<uint64_t> start_counts;
+		std::vector<uint64_t> last_counts;
+		std::chrono::duration<double> last_length{ 0.0 };
+	};
+
+	struct Metric {
+		std::string name;
+		std::unique_ptr<Counter> counter;
+		std::unique_ptr<Gauge> gauge;
+		std::unique_ptr<Histogram> histogram;
+		std::function<double()> probe;
+		Window window;
+	};
+
+	struct Monitor {
+		std::string name;
+		int metric_idx;
+		Reading reading;
+	};
+
+	Metric& add_metric(const std::string& name);
+	void add_monitor(const std::string& name, Reading reading);
+	void update_window(Metric& metric, std::vector<uint64_t> counts);
+	double get_percentile(const Metric& metric, double percentile);
+
+	std::chrono::milliseconds _window_length;
+	std::mutex _access;
+	// Metrics are only added, references to them stay valid
+	std::vector<std::unique_ptr<Metric>> _metrics;
+	std::vector<Monitor> _monitors;
+};
+
+} //namespace T5Integration
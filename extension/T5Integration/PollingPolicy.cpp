@@ -0,0 +1,62 @@
+#include <PollingPolicy.h>
+#include <algorithm>
+
+using namespace std::chrono_literals;
+
+namespace T5Integration {
+
+const char* poll_state_name(PollState state) {
+	switch (state) {
+		case PollState::CONNECTING:
+			return "connecting";
+		case PollState::CONNECTED:
+			return "connected";
+		case PollState::IDLE:
+			return "idle";
+		case PollState::UNAVAILABLE:
+			return "unavailable";
+		default:
+			return "unknown";
+	}
+}
+
+PollingPolicy::PollingPolicy() {
+	set_rule(PollState::CONNECTING, { 10ms, 100ms, 2.0f });
+	set_rule(PollState::CONNECTED, { 250ms, 2s, 2.0f });
+	set_rule(PollState::IDLE, { 2s, 30s, 2.0f });
+	set_rule(PollState::UNAVAILABLE, { 2s, 60s, 2.0f });
+}
+
+void PollingPolicy::set_rule(PollState state, const PollingRule& rule) {
+	auto& stored = _rules[static_cast<size_t>(state)];
+	stored.fastest_ms = static_cast<int32_t>(rule.fastest.count());
+	stored.slowest_ms = static_cast<int32_t>(std::max(rule.fastest, rule.slowest).count());
+	stored.growth = std::max(rule.growth, 1.0f);
+}
+
+PollingRule PollingPolicy::get_rule(PollState state) const {
+	auto& stored = _rules[static_cast<size_t>(state)];
+	return { std::chrono::milliseconds(stored.fastest_ms), std::chrono::milliseconds(stored.slowest_ms), stored.growth };
+}
+
+void PollingPolicy::use_fixed_rates(std::chrono::milliseconds connecting, std::chrono::milliseconds monitoring) {
+	set_rule(PollState::CONNECTING, { connecting, connecting, 1.0f });
+	set_rule(PollState::CONNECTED, { monitoring, monitoring, 1.0f });
+	set_rule(PollState::IDLE, { monitoring, monitoring, 1.0f });
+	set_rule(PollState::UNAVAILABLE, { monitoring, monitoring, 1.0f });
+}
+
+std::chrono::milliseconds PollSchedule::next(PollState state) {
+	auto rule = _policy.get_rule(state);
+	if (_is_reset || state != _state) {
+		_state = state;
+		_is_reset = false;
+		_interval = rule.fastest;
+	} else {
+		_interval = std::chrono::milliseconds(static_cast<int64_t>(_interval.count() * rule.growth));
+	}
+	_interval = std::clamp(_interval, rule.fastest, rule.slowest);
+	return _interval;
+}
+
+} //namespace T5Integration
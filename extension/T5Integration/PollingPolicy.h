@@ -0,0 +1,75 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace T5Integration {
+
+// What the glasses are doing while a monitor polls them
+enum class PollState : uint8_t {
+	// Reserving or waiting for the glasses to be ready
+	CONNECTING,
+	CONNECTED,
+	// Listed but not reserved by this application
+	IDLE,
+	// Reserved by another application
+	UNAVAILABLE,
+	Count
+};
+
+const char* poll_state_name(PollState state);
+
+// Polls start at the fastest interval and grow by the growth
+// factor after each poll that finds nothing new, up to the slowest
+struct PollingRule {
+	std::chrono::milliseconds fastest;
+	std::chrono::milliseconds slowest;
+	float growth;
+};
+
+// Polling rules per state. Rules can be changed while monitors are
+// running, they take effect from each monitor's next poll.
+class PollingPolicy {
+public:
+	using Ptr = std::shared_ptr<PollingPolicy>;
+
+	PollingPolicy();
+
+	void set_rule(PollState state, const PollingRule& rule);
+	PollingRule get_rule(PollState state) const;
+
+	// Fixed intervals with no back off
+	void use_fixed_rates(std::chrono::milliseconds connecting, std::chrono::milliseconds monitoring);
+
+private:
+	struct AtomicRule {
+		std::atomic<int32_t> fastest_ms = 0;
+		std::atomic<int32_t> slowest_ms = 0;
+		std::atomic<float> growth = 1.0f;
+	};
+
+	std::array<AtomicRule, static_cast<size_t>(PollState::Count)> _rules;
+};
+
+// Poll intervals of one monitor
+class PollSchedule {
+public:
+	PollSchedule(const PollingPolicy& policy) :
+			_policy(policy) {}
+
+	// Interval to wait before the next poll. Restarts at the fastest
+	// interval whenever the state differs from the previous call.
+	std::chrono::milliseconds next(PollState state);
+	// Something changed, poll again quickly
+	void reset() { _is_reset = true; }
+
+private:
+	const PollingPolicy& _policy;
+	PollState _state = PollState::Count;
+	bool _is_reset = true;
+	std::chrono::milliseconds _interval{ 0 };
+};
+
+} //namespace T5Integration
@@ -0,0 +1,94 @@
+#include <RenderScale.h>
+#include <algorithm>
+
+namespace T5Integration {
+
+namespace {
+
+// Weight of the newest frame in the moving averages
+constexpr double g_average_weight = 0.1;
+// Step down once the GPU uses more than this share of the budget
+constexpr double g_high_water = 0.95;
+// Step up only if the larger scale is predicted to stay below this
+constexpr double g_low_water = 0.8;
+constexpr int g_frames_to_step_down = 5;
+constexpr int g_frames_to_step_up = 30;
+// Frame times are measured a few frames late, the ones rendered
+// before a change shouldn't cause another
+constexpr int g_settle_frames = 10;
+
+} // namespace
+
+void RenderScaleController::set_limits(const RenderScaleLimits& limits) {
+	_limits = limits;
+	_limits.min_scale = std::max(_limits.min_scale, 0.1f);
+	_limits.max_scale = std::max(_limits.max_scale, _limits.min_scale);
+	_limits.step = std::max(_limits.step, 0.01f);
+	_limits.frame_budget = std::max(_limits.frame_budget, std::chrono::microseconds(1));
+	set_scale(std::clamp(_scale, _limits.min_scale, _limits.max_scale));
+}
+
+bool RenderScaleController::add_frame_time(std::chrono::microseconds cpu_time, std::chrono::microseconds gpu_time) {
+	double cpu_ms = cpu_time.count() / 1000.0;
+	double gpu_ms = gpu_time.count() / 1000.0;
+	if (_frames_measured++ == 0) {
+		_cpu_ms = cpu_ms;
+		_gpu_ms = gpu_ms;
+	} else {
+		_cpu_ms += (cpu_ms - _cpu_ms) * g_average_weight;
+		_gpu_ms += (gpu_ms - _gpu_ms) * g_average_weight;
+	}
+
+	if (_settle_frames > 0) {
+		--_settle_frames;
+		return false;
+	}
+
+	double budget_ms = _limits.frame_budget.count() / 1000.0;
+	bool is_cpu_bound = _cpu_ms > budget_ms;
+	if (_gpu_ms > budget_ms * g_high_water && !is_cpu_bound) {
+		_frames_under = 0;
+		if (++_frames_over >= g_frames_to_step_down)
+			return set_scale(_scale - _limits.step);
+		return false;
+	}
+	_frames_over = 0;
+
+	float larger = std::min(_scale + _limits.step, _limits.max_scale);
+	double ratio = larger / _scale;
+	if (larger > _scale && _gpu_ms * ratio * ratio < budget_ms * g_low_water) {
+		if (++_frames_under >= g_frames_to_step_up)
+			return set_scale(larger);
+	} else {
+		_frames_under = 0;
+	}
+	return false;
+}
+
+void RenderScaleController::reset() {
+	_scale = _limits.max_scale;
+	_cpu_ms = 0.0;
+	_gpu_ms = 0.0;
+	_frames_measured = 0;
+	_frames_over = 0;
+	_frames_under = 0;
+	_settle_frames = 0;
+}
+
+bool RenderScaleController::set_scale(float scale) {
+	scale = std::clamp(scale, _limits.min_scale, _limits.max_scale);
+	if (scale == _scale)
+		return false;
+
+	// Until new measurements arrive assume the GPU time
+	// follows the pixel count
+	double ratio = scale / _scale;
+	_gpu_ms *= ratio * ratio;
+	_scale = scale;
+	_frames_over = 0;
+	_frames_under = 0;
+	_settle_frames = g_settle_frames;
+	return true;
+}
+
+} //namespace T5Integration
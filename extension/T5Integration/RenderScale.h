@@ -0,0 +1,50 @@
+#pragma once
+#include <chrono>
+
+namespace T5Integration {
+
+struct RenderScaleLimits {
+	float min_scale = 0.5f;
+	float max_scale = 1.0f;
+	// The scale changes by one step at a time
+	float step = 0.125f;
+	// Time one glasses may spend rendering a frame
+	std::chrono::microseconds frame_budget{ 16667 };
+};
+
+// Picks the render scale of one glasses from its measured frame
+// times. The GPU time is assumed to follow the pixel count, so the
+// scale steps down while the GPU is over budget and steps back up
+// once the larger size is predicted to fit. A frame that is over
+// budget on the CPU alone holds the scale, rendering fewer pixels
+// won't help it.
+class RenderScaleController {
+public:
+	void set_limits(const RenderScaleLimits& limits);
+	const RenderScaleLimits& get_limits() const { return _limits; }
+
+	// Returns true if the scale changed
+	bool add_frame_time(std::chrono::microseconds cpu_time, std::chrono::microseconds gpu_time);
+	float get_scale() const { return _scale; }
+
+	// Back to the largest scale with no history
+	void reset();
+
+private:
+	bool set_scale(float scale);
+
+	RenderScaleLimits _limits;
+	float _scale = 1.0f;
+
+	// Moving averages in milliseconds
+	double _cpu_ms = 0.0;
+	double _gpu_ms = 0.0;
+	int _frames_measured = 0;
+
+	int _frames_over = 0;
+	int _frames_under = 0;
+	// Frames left before the scale may change again
+	int _settle_frames = 0;
+};
+
+} //namespace T5Integration
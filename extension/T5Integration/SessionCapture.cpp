@@ -0,0 +1,190 @@
+#include <SessionCapture.h>
+
+namespace T5Integration {
+
+void capture_frame_info(const T5_FrameInfo& info, CapturedFrame& out_frame) {
+	out_frame.width = info.texWidth_PIX;
+	out_frame.height = info.texHeight_PIX;
+	out_frame.is_srgb = info.isSrgb ? 1 : 0;
+	out_frame.is_upside_down = info.isUpsideDown ? 1 : 0;
+	out_frame.vci[0] = info.vci.startX_VCI;
+	out_frame.vci[1] = info.vci.startY_VCI;
+	out_frame.vci[2] = info.vci.width_VCI;
+	out_frame.vci[3] = info.vci.height_VCI;
+	out_frame.left_rotation = info.rotToLVC_GBD;
+	out_frame.left_position = info.posLVC_GBD;
+	out_frame.right_rotation = info.rotToRVC_GBD;
+	out_frame.right_position = info.posRVC_GBD;
+}
+
+namespace {
+
+bool operator==(const T5_Quat& a, const T5_Quat& b) {
+	return a.w == b.w && a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+bool operator==(const T5_Vec3& a, const T5_Vec3& b) {
+	return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+} //namespace
+
+bool is_same_frame_output(const CapturedFrame& a, const CapturedFrame& b) {
+	return a.glasses_idx == b.glasses_idx &&
+			a.pose_timestamp_ns == b.pose_timestamp_ns &&
+			a.width == b.width &&
+			a.height == b.height &&
+			a.is_srgb == b.is_srgb &&
+			a.is_upside_down == b.is_upside_down &&
+			std::memcmp(a.vci, b.vci, sizeof(a.vci)) == 0 &&
+			a.left_rotation == b.left_rotation &&
+			a.left_position == b.left_position &&
+			a.right_rotation == b.right_rotation &&
+			a.right_position == b.right_position;
+}
+
+SessionRecorder::~SessionRecorder() {
+	stop();
+}
+
+bool SessionRecorder::start(const std::string& path) {
+	stop();
+
+	std::lock_guard lock(_access);
+	_file = std::fopen(path.c_str(), "wb");
+	if (!_file)
+		return false;
+
+	SessionCaptureHeader header = {};
+	header.magic = g_session_capture_magic;
+	header.version = g_session_capture_version;
+	std::fwrite(&header, sizeof(header), 1, _file);
+
+	_start_time = Clock::now();
+	_is_recording = true;
+	return true;
+}
+
+void SessionRecorder::stop() {
+	std::lock_guard lock(_access);
+	_is_recording = false;
+	if (_file) {
+		std::fclose(_file);
+		_file = nullptr;
+	}
+}
+
+void SessionRecorder::record_glasses(int glasses_idx, std::string_view id) {
+	CapturedGlasses glasses = {};
+	glasses.glasses_idx = glasses_idx;
+	write_chunk(SessionChunk::GLASSES, &glasses, sizeof(glasses), id);
+}
+
+void SessionRecorder::record_connection(int glasses_idx, T5_ConnectionState state) {
+	CapturedConnection connection = {};
+	connection.glasses_idx = glasses_idx;
+	connection.state = state;
+	write_chunk(SessionChunk::CONNECTION, &connection, sizeof(connection));
+}
+
+void SessionRecorder::record_pose(int glasses_idx, T5_Result result, const T5_GlassesPose& pose) {
+	CapturedPose captured = {};
+	captured.glasses_idx = glasses_idx;
+	captured.result = result;
+	if (result == T5_SUCCESS) {
+		captured.timestamp_ns = pose.timestampNanos;
+		captured.position = pose.posGLS_GBD;
+		captured.rotation = pose.rotToGLS_GBD;
+		captured.gameboard_type = pose.gameboardType;
+	}
+	write_chunk(SessionChunk::POSE, &captured, sizeof(captured));
+}
+
+void SessionRecorder::record_parameter(int glasses_idx, T5_ParamGlasses param, double value) {
+	CapturedParameter parameter = {};
+	parameter.glasses_idx = glasses_idx;
+	parameter.param = param;
+	parameter.value = value;
+	write_chunk(SessionChunk::PARAMETER, &parameter, sizeof(parameter));
+}
+
+void SessionRecorder::record_parameter(int glasses_idx, T5_ParamGlasses param, std::string_view value) {
+	CapturedParameter parameter = {};
+	parameter.glasses_idx = glasses_idx;
+	parameter.param = param;
+	write_chunk(SessionChunk::PARAMETER, &parameter, sizeof(parameter), value);
+}
+
+void SessionRecorder::record_frame(int glasses_idx, T5_Result result, Clock::duration submit_time, uint64_t pose_timestamp, const T5_FrameInfo& info) {
+	CapturedFrame frame = {};
+	frame.glasses_idx = glasses_idx;
+	frame.result = result;
+	frame.submit_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(submit_time).count();
+	frame.pose_timestamp_ns = pose_timestamp;
+	capture_frame_info(info, frame);
+	write_chunk(SessionChunk::FRAME, &frame, sizeof(frame));
+}
+
+void SessionRecorder::record_wand_event(int glasses_idx, const T5_WandStreamEvent& event) {
+	CapturedWandEvent captured = {};
+	captured.glasses_idx = glasses_idx;
+	captured.timestamp_ns = event.timestampNanos;
+	encode_wand_event(event, captured.record);
+	write_chunk(SessionChunk::WAND, &captured, sizeof(captured));
+}
+
+void SessionRecorder::write_chunk(uint32_t tag, const void* payload, size_t payload_size, std::string_view extra) {
+	if (!_is_recording)
+		return;
+
+	SessionChunkHeader header;
+	header.tag = tag;
+	header.size = static_cast<uint32_t>(payload_size + extra.size());
+
+	std::lock_guard lock(_access);
+	if (!_file)
+		return;
+	// Taken under the lock so chunk times never go backwards
+	header.time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - _start_time).count();
+	std::fwrite(&header, sizeof(header), 1, _file);
+	std::fwrite(payload, payload_size, 1, _file);
+	if (!extra.empty())
+		std::fwrite(extra.data(), extra.size(), 1, _file);
+}
+
+SessionCapture::Ptr SessionCapture::open(const std::string& path) {
+	auto capture = std::make_shared<SessionCapture>();
+	if (!capture->_file.open(path))
+		return nullptr;
+
+	if (capture->_file.size() < sizeof(SessionCaptureHeader))
+		return nullptr;
+
+	SessionCaptureHeader header;
+	std::memcpy(&header, capture->_file.data(), sizeof(header));
+	if (header.magic != g_session_capture_magic || header.version != g_session_capture_version)
+		return nullptr;
+
+	return capture;
+}
+
+bool SessionCapture::Reader::next(Chunk& out_chunk) {
+	auto size = _capture._file.size();
+	if (_offset + sizeof(SessionChunkHeader) > size)
+		return false;
+
+	SessionChunkHeader header;
+	std::memcpy(&header, _capture._file.data() + _offset, sizeof(header));
+	// A partly written last chunk is ignored
+	if (_offset + sizeof(header) + header.size > size)
+		return false;
+
+	out_chunk.tag = header.tag;
+	out_chunk.time_ns = header.time_ns;
+	out_chunk.payload = _capture._file.data() + _offset + sizeof(header);
+	out_chunk.size = header.size;
+	_offset += sizeof(header) + header.size;
+	return true;
+}
+
+} //namespace T5Integration
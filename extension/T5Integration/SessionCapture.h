@@ -0,0 +1,189 @@
+#pragma once
+#include <MappedFile.h>
+#include <TiltFiveNative.h>
+#include <WandRecording.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace T5Integration {
+
+// A session capture is a 16 byte header followed by chunks. Each chunk
+// has a tag, the payload size and the capture time in nanoseconds since
+// the capture started. Payloads are the Captured* structs below, GLSS
+// and PARM followed by a UTF-8 string.
+
+const uint32_t g_session_capture_magic = 0x43533554; // "T5SC"
+const uint16_t g_session_capture_version = 1;
+
+constexpr uint32_t make_chunk_tag(const char (&tag)[5]) {
+	return static_cast<uint32_t>(tag[0]) |
+			static_cast<uint32_t>(tag[1]) << 8 |
+			static_cast<uint32_t>(tag[2]) << 16 |
+			static_cast<uint32_t>(tag[3]) << 24;
+}
+
+namespace SessionChunk {
+const uint32_t GLASSES = make_chunk_tag("GLSS");
+const uint32_t CONNECTION = make_chunk_tag("CONN");
+const uint32_t POSE = make_chunk_tag("POSE");
+const uint32_t PARAMETER = make_chunk_tag("PARM");
+const uint32_t FRAME = make_chunk_tag("FRME");
+const uint32_t WAND = make_chunk_tag("WAND");
+} //namespace SessionChunk
+
+struct SessionCaptureHeader {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t reserved[5];
+};
+
+struct SessionChunkHeader {
+	uint32_t tag;
+	uint32_t size;
+	uint64_t time_ns;
+};
+
+// Followed by the glasses id
+struct CapturedGlasses {
+	uint32_t glasses_idx;
+};
+
+struct CapturedConnection {
+	uint32_t glasses_idx;
+	uint32_t state;
+};
+
+struct CapturedPose {
+	uint32_t glasses_idx;
+	T5_Result result;
+	uint64_t timestamp_ns;
+	T5_Vec3 position;
+	T5_Quat rotation;
+	uint32_t gameboard_type;
+};
+
+// String parameters are followed by the value
+struct CapturedParameter {
+	uint32_t glasses_idx;
+	uint32_t param;
+	double value;
+};
+
+struct CapturedFrame {
+	uint32_t glasses_idx;
+	T5_Result result;
+	uint64_t submit_ns;
+	// Pose the frame was rendered with
+	uint64_t pose_timestamp_ns;
+	uint16_t width;
+	uint16_t height;
+	uint8_t is_srgb;
+	uint8_t is_upside_down;
+	uint8_t reserved[2];
+	float vci[4];
+	T5_Quat left_rotation;
+	T5_Vec3 left_position;
+	T5_Quat right_rotation;
+	T5_Vec3 right_position;
+};
+
+struct CapturedWandEvent {
+	uint32_t glasses_idx;
+	uint32_t reserved;
+	uint64_t timestamp_ns;
+	WandRecord record;
+};
+
+void capture_frame_info(const T5_FrameInfo& info, CapturedFrame& out_frame);
+// Same frame output, ignoring timing and the texture handles
+bool is_same_frame_output(const CapturedFrame& a, const CapturedFrame& b);
+
+// Appends chunks to a capture file. Safe to call from any thread, the
+// record functions return straight away when no capture is running.
+class SessionRecorder {
+public:
+	using Ptr = std::shared_ptr<SessionRecorder>;
+	using Clock = std::chrono::steady_clock;
+
+	SessionRecorder() = default;
+	~SessionRecorder();
+
+	bool start(const std::string& path);
+	void stop();
+	bool is_recording() const { return _is_recording; }
+
+	void record_glasses(int glasses_idx, std::string_view id);
+	void record_connection(int glasses_idx, T5_ConnectionState state);
+	void record_pose(int glasses_idx, T5_Result result, const T5_GlassesPose& pose);
+	void record_parameter(int glasses_idx, T5_ParamGlasses param, double value);
+	void record_parameter(int glasses_idx, T5_ParamGlasses param, std::string_view value);
+	void record_frame(int glasses_idx, T5_Result result, Clock::duration submit_time, uint64_t pose_timestamp, const T5_FrameInfo& info);
+	void record_wand_event(int glasses_idx, const T5_WandStreamEvent& event);
+
+private:
+	void write_chunk(uint32_t tag, const void* payload, size_t payload_size, std::string_view extra = {});
+
+	std::mutex _access;
+	std::atomic_bool _is_recording = false;
+	std::FILE* _file = nullptr;
+	Clock::time_point _start_time;
+};
+
+// Memory mapped capture read back chunk by chunk
+class SessionCapture {
+public:
+	using Ptr = std::shared_ptr<const SessionCapture>;
+
+	struct Chunk {
+		uint32_t tag;
+		uint64_t time_ns;
+		const uint8_t* payload;
+		size_t size;
+
+		// Copies out the fixed part of the payload
+		template <typename T>
+		bool read(T& out_value) const;
+		// Trailing string of GLSS and PARM chunks
+		std::string_view trailing_string(size_t fixed_size) const;
+	};
+
+	class Reader {
+	public:
+		Reader(const SessionCapture& capture) :
+				_capture(capture) {}
+
+		bool next(Chunk& out_chunk);
+		void rewind() { _offset = sizeof(SessionCaptureHeader); }
+
+	private:
+		const SessionCapture& _capture;
+		size_t _offset = sizeof(SessionCaptureHeader);
+	};
+
+	static Ptr open(const std::string& path);
+
+private:
+	MappedFile _file;
+};
+
+template <typename T>
+bool SessionCapture::Chunk::read(T& out_value) const {
+	if (size < sizeof(T))
+		return false;
+	std::memcpy(&out_value, payload, sizeof(T));
+	return true;
+}
+
+inline std::string_view SessionCapture::Chunk::trailing_string(size_t fixed_size) const {
+	if (size <= fixed_size)
+		return {};
+	return std::string_view(reinterpret_cast<const char*>(payload + fixed_size), size - fixed_size);
+}
+
+} //namespace T5Integration
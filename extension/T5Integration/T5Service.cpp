@@ -2,15 +2,35 @@
 #include <ObjectRegistry.h>
 #include <T5Service.h>
 #include <algorithm>
+#include <array>
+#include <cstring>
 
 namespace T5Integration {
 
-std::mutex g_t5_exclusivity_group_1;
+CallBroker g_t5_exclusivity_group_1;
 std::mutex g_t5_exclusivity_group_2;
 
 T5Service::T5Service() {
 	_graphics_api = T5_GraphicsApi::kT5_GraphicsApi_None;
 	_scheduler = ObjectRegistry::scheduler();
+	_session_recorder = std::make_shared<SessionRecorder>();
+	_polling_policy = std::make_shared<PollingPolicy>();
+
+	_frame_timer = std::make_shared<FrameTimer>();
+	_metrics = std::make_shared<MetricsRegistry>();
+	_metrics->add_probe("Scheduler queue depth", [scheduler = Scheduler::Ptr::weak_type(_scheduler)]() {
+		auto locked = scheduler.lock();
+		return locked ? static_cast<double>(locked->get_queue_depth()) : 0.0;
+	});
+	_lock_wait = &_metrics->add_histogram(
+			"NDK lock wait (ms)",
+			{ 0.0, 0.01, 0.05, 0.1, 0.25, 0.5, 1.0, 2.0, 5.0, 10.0, 20.0, 50.0 });
+	g_t5_exclusivity_group_1.set_wait_histogram(_lock_wait);
+	_glasses_metrics.registry = _metrics;
+	_glasses_metrics.frames_submitted = &_metrics->add_counter("Frames submitted");
+	_glasses_metrics.wand_events = &_metrics->add_counter("Wand events");
+	_glasses_connected = &_metrics->add_counter("Glasses connected");
+	_glasses_disconnected = &_metrics->add_counter("Glasses disconnected");
 
 	_state.clear_all();
 	_previous_event_state.clear_all();
@@ -18,6 +38,7 @@ T5Service::T5Service() {
 
 T5Service::~T5Service() {
 	stop_service();
+	g_t5_exclusivity_group_1.clear_wait_histogram(_lock_wait);
 }
 
 bool T5Service::start_service(const std::string_view application_id, std::string_view application_version, uint8_t sdk_type) {
@@ -34,7 +55,11 @@ bool T5Service::start_service(const std::string_view application_id, std::string
 		clientInfo.applicationVersion = application_version.data();
 		clientInfo.sdkType = sdk_type;
 
-		auto result = t5CreateContext(&_context, &clientInfo, nullptr);
+		T5_Result result;
+		{
+			auto lock = g_t5_exclusivity_group_1.acquire(CallSite::SERVICE);
+			result = t5CreateContext(&_context, &clientInfo, nullptr);
+		}
 
 		if (result != T5_SUCCESS) {
 			LOG_T5_ERROR(result);
@@ -55,25 +80,40 @@ void T5Service::stop_service() {
 		_scheduler->stop();
 		for (int i = 0; i < _glasses_list.size(); i++) {
 			_glasses_list[i]->stop_display();
+			_glasses_list[i]->release_standby();
 			_glasses_list[i]->disconnect();
 			_glasses_list[i]->destroy_handle();
 		}
 		_glasses_list.clear();
+		_glasses_slots.clear();
 
 		if (_context) {
-			std::lock_guard lock(g_t5_exclusivity_group_1);
+			auto lock = g_t5_exclusivity_group_1.acquire(CallSite::SERVICE);
 			t5DestroyContext(&_context);
 		}
 		_context = nullptr;
 	}
 }
 
+namespace {
+
+template <typename Slots>
+auto find_glasses_slot(Slots& slots, const std::string_view glasses_id) {
+	auto found = std::lower_bound(
+			slots.begin(),
+			slots.end(),
+			glasses_id,
+			[](auto& slot, std::string_view id) { return slot.id < id; });
+	return (found != slots.end() && found->id == glasses_id) ? found : slots.end();
+}
+
+} //namespace
+
 std::optional<int> T5Service::find_glasses_idx(const std::string_view glasses_id) {
-	for (int i = 0; i < _glasses_list.size(); ++i) {
-		if (_glasses_list[i]->get_id() == glasses_id)
-			return i;
-	}
-	return {};
+	auto found = find_glasses_slot(_glasses_slots, glasses_id);
+	if (found == _glasses_slots.end())
+		return {};
+	return found->glasses_idx;
 }
 
 CotaskPtr T5Service::startup_checks() {
@@ -107,6 +147,7 @@ CotaskPtr T5Service::startup_checks() {
 		_state.clear(T5ServiceState::STARTING);
 		_state.set(T5ServiceState::RUNNING);
 		_scheduler->add_task(query_glasses_list());
+		_scheduler->add_task(watch_parameters());
 	} else {
 		stop_service();
 	}
@@ -121,14 +162,13 @@ CotaskPtr T5Service::query_t5_service_version() {
 	for (int tries = 0; tries < 10; ++tries) {
 		size_t buffer_size = buffer.size();
 		{
-			std::lock_guard lock(g_t5_exclusivity_group_1);
+			auto lock = g_t5_exclusivity_group_1.acquire(CallSite::SERVICE);
 			result = t5GetSystemUtf8Param(_context, kT5_ParamSys_UTF8_Service_Version, buffer.data(), &buffer_size);
 		}
 		if (result == T5_ERROR_OVERFLOW) {
 			buffer.resize(buffer_size);
 			continue;
-		} else if (result == T5_TIMEOUT &&
-				result != T5_ERROR_NO_SERVICE &&
+		} else if (result != T5_ERROR_NO_SERVICE &&
 				result != T5_ERROR_IO_FAILURE) {
 			break;
 		}
@@ -155,6 +195,11 @@ CotaskPtr T5Service::query_t5_service_version() {
 CotaskPtr T5Service::query_glasses_list() {
 	std::vector<char> buffer;
 	buffer.resize(64);
+	// The last list every change was applied for. Buffers are
+	// reused so an unchanged list costs one call and a compare.
+	std::vector<char> applied_list;
+	std::vector<std::string_view> parsed_id_list;
+	std::vector<bool> is_listed;
 	T5_Result result;
 	bool first_resize = true;
 
@@ -162,7 +207,7 @@ CotaskPtr T5Service::query_glasses_list() {
 		size_t bufferSize = buffer.size();
 
 		{
-			std::lock_guard lock(g_t5_exclusivity_group_1);
+			auto lock = g_t5_exclusivity_group_1.acquire(CallSite::SERVICE);
 			result = t5ListGlasses(_context, buffer.data(), &bufferSize);
 		}
 		if (result == T5_ERROR_NO_SERVICE || result == T5_ERROR_IO_FAILURE) {
@@ -179,8 +224,14 @@ CotaskPtr T5Service::query_glasses_list() {
 		}
 		first_resize = true;
 
-		std::string_view str_view(buffer.data(), buffer.size());
-		std::vector<std::string_view> parsed_id_list;
+		auto list_size = std::min(bufferSize, buffer.size());
+		if (list_size == applied_list.size() && std::memcmp(buffer.data(), applied_list.data(), list_size) == 0) {
+			co_await task_sleep(_poll_rate_for_monitoring);
+			continue;
+		}
+
+		std::string_view str_view(buffer.data(), list_size);
+		parsed_id_list.clear();
 
 		while (!str_view.empty()) {
 			auto pos = str_view.find_first_of('\0');
@@ -192,27 +243,312 @@ CotaskPtr T5Service::query_glasses_list() {
 
 		co_await run_in_foreground;
 
-		for (auto& id : parsed_id_list) {
-			auto found = std::find_if(
-					_glasses_list.cbegin(),
-					_glasses_list.cend(),
-					[id](auto& gls) { return gls->get_id() == id; });
+		bool is_applied = true;
+		int known_count = _glasses_list.size();
+		is_listed.assign(known_count, false);
 
-			if (found == _glasses_list.cend()) {
-				auto new_glasses = create_glasses(id);
-				if (new_glasses->allocate_handle(_context))
-					_glasses_list.emplace_back(std::move(new_glasses));
+		for (auto id : parsed_id_list) {
+			auto found = find_glasses_slot(_glasses_slots, id);
+			if (found != _glasses_slots.end())
+				is_listed[found->glasses_idx] = true;
+			if (!add_listed_glasses(id))
+				is_applied = false;
+		}
+
+		for (int i = 0; i < known_count; ++i) {
+			auto& glasses = _glasses_list[i];
+			if (is_listed[i])
+				continue;
+			if (glasses->is_created()) {
+				glasses->mark_removed();
+				is_applied = false;
+			} else if (glasses->_glasses_handle && !glasses->destroy_removed_handle()) {
+				is_applied = false;
 			}
 		}
 
+		// Anything left undone is retried on the next poll
+		if (is_applied)
+			applied_list.assign(buffer.data(), buffer.data() + list_size);
+		else
+			applied_list.clear();
+
 		co_await task_sleep(_poll_rate_for_monitoring);
 	}
 }
 
+bool T5Service::add_listed_glasses(const std::string_view id) {
+	auto found = find_glasses_slot(_glasses_slots, id);
+	if (found == _glasses_slots.end()) {
+		int glasses_idx = _glasses_list.size();
+		auto new_glasses = create_glasses(id);
+		new_glasses->set_session_recorder(_session_recorder, glasses_idx);
+		new_glasses->set_polling_policy(_polling_policy);
+		new_glasses->set_metrics(_glasses_metrics);
+		new_glasses->set_standby_grace_period(_standby_grace_period);
+		if (!new_glasses->allocate_handle(_context))
+			return false;
+		_session_recorder->record_glasses(glasses_idx, id);
+		_glasses_list.emplace_back(std::move(new_glasses));
+
+		auto insert_at = std::lower_bound(
+				_glasses_slots.begin(),
+				_glasses_slots.end(),
+				id,
+				[](auto& slot, std::string_view slot_id) { return slot.id < slot_id; });
+		_glasses_slots.insert(insert_at, GlassesSlot{ std::string(id), glasses_idx });
+		return true;
+	}
+
+	// Glasses plugged back in get their old index
+	auto& glasses = _glasses_list[found->glasses_idx];
+	if (glasses->is_created())
+		return true;
+	if (glasses->_glasses_handle && !glasses->destroy_removed_handle())
+		return false;
+	if (!glasses->allocate_handle(_context))
+		return false;
+	_session_recorder->record_glasses(found->glasses_idx, id);
+	return true;
+}
+
 std::unique_ptr<Glasses> T5Service::create_glasses(const std::string_view id) {
 	return std::make_unique<Glasses>(id);
 }
 
+namespace {
+
+using WatchClock = std::chrono::steady_clock;
+
+// Each glasses keeps its own poll schedule in the watcher so idle
+// glasses aren't polled at the rate of connected ones
+struct WatchedGlasses {
+	WatchedGlasses(const PollingPolicy& policy) :
+			schedule(policy) {}
+
+	PollSchedule schedule;
+	PollState poll_state = PollState::Count;
+	WatchClock::time_point next_poll;
+
+	// Results of the current pass
+	Glasses* glasses = nullptr;
+	bool is_due = false;
+	T5_Result changes_result = T5_SUCCESS;
+	bool is_ipd_changed = false;
+	bool is_name_changed = false;
+	T5_Result ipd_result = T5_SUCCESS;
+	double ipd = 0.0;
+	T5_Result name_result = T5_SUCCESS;
+	std::vector<char> name;
+};
+
+// Change lists are read again on the next pass, so only errors
+// that won't clear up by themselves are logged
+bool is_lasting_error(T5_Result result) {
+	switch (result) {
+		case T5_SUCCESS:
+		case T5_ERROR_OVERFLOW:
+		case T5_ERROR_NO_SERVICE:
+		case T5_ERROR_IO_FAILURE:
+		case T5_ERROR_DEVICE_LOST:
+			return false;
+		default:
+			return true;
+	}
+}
+
+} //namespace
+
+CotaskPtr T5Service::watch_parameters() {
+	auto polling_policy = _polling_policy;
+	std::vector<WatchedGlasses> watched;
+	// System parameters are polled at the rate of the most active glasses
+	PollSchedule system_schedule(*polling_policy);
+	auto system_poll_state = PollState::Count;
+	WatchClock::time_point system_next_poll;
+	// The change list only holds changes made after the first call
+	bool is_first_pass = true;
+	std::array<T5_ParamSys, 8> changed_system_params;
+	std::array<T5_ParamGlasses, 16> changed_glasses_params;
+	std::vector<ParameterChange> changes;
+
+	for (;;) {
+		co_await run_in_foreground;
+		if (!_state.is_current(T5ServiceState::RUNNING))
+			co_return;
+
+		auto now = WatchClock::now();
+		auto next_wake = WatchClock::time_point::max();
+		bool is_any_due = false;
+		auto active_poll_state = PollState::IDLE;
+		while (watched.size() < _glasses_list.size())
+			watched.emplace_back(*polling_policy);
+		for (int i = 0; i < _glasses_list.size(); ++i) {
+			auto& entry = watched[i];
+			entry.glasses = _glasses_list[i].get();
+			entry.is_due = false;
+			if (!entry.glasses->is_created()) {
+				entry.poll_state = PollState::Count;
+				continue;
+			}
+			// Parameters don't need the fast polls a connection does
+			auto poll_state = entry.glasses->get_poll_state();
+			if (poll_state == PollState::CONNECTING)
+				poll_state = PollState::CONNECTED;
+			if (poll_state == PollState::CONNECTED)
+				active_poll_state = PollState::CONNECTED;
+			if (poll_state != entry.poll_state) {
+				entry.poll_state = poll_state;
+				entry.next_poll = now + entry.schedule.next(poll_state);
+			}
+			entry.is_due = now >= entry.next_poll;
+			is_any_due |= entry.is_due;
+			next_wake = std::min(next_wake, entry.next_poll);
+		}
+		if (active_poll_state != system_poll_state) {
+			system_poll_state = active_poll_state;
+			system_next_poll = is_first_pass ? now : now + system_schedule.next(system_poll_state);
+		}
+		bool is_system_due = now >= system_next_poll;
+		is_any_due |= is_system_due;
+		next_wake = std::min(next_wake, system_next_poll);
+		if (!is_any_due) {
+			// Wake in time to see glasses change state
+			auto recheck = polling_policy->get_rule(PollState::CONNECTED).fastest;
+			co_await task_sleep(std::min(std::chrono::ceil<std::chrono::milliseconds>(next_wake - now), recheck));
+			continue;
+		}
+		co_await run_now;
+
+		// One acquisition takes the due change lists and reads
+		// only what changed
+		T5_Result system_result = T5_SUCCESS;
+		bool is_attention_changed = false;
+		T5_Result attention_result = T5_SUCCESS;
+		int64_t attention_required = 0;
+		{
+			auto lock = g_t5_exclusivity_group_1.acquire(CallSite::PARAMETERS);
+
+			uint16_t count;
+			if (is_system_due) {
+				is_attention_changed = is_first_pass;
+				count = changed_system_params.size();
+				system_result = t5GetChangedSystemParams(_context, changed_system_params.data(), &count);
+				if (system_result == T5_ERROR_OVERFLOW)
+					is_attention_changed = true;
+				else if (system_result == T5_SUCCESS)
+					for (int i = 0; i < count; ++i)
+						is_attention_changed |= changed_system_params[i] == kT5_ParamSys_Integer_CPL_AttRequired;
+				if (is_attention_changed)
+					attention_result = t5GetSystemIntegerParam(_context, kT5_ParamSys_Integer_CPL_AttRequired, &attention_required);
+			}
+
+			for (auto& entry : watched) {
+				entry.is_ipd_changed = false;
+				entry.is_name_changed = false;
+				if (!entry.is_due)
+					continue;
+				// Handles are only replaced under this lock
+				auto handle = entry.glasses->_glasses_handle;
+				if (!handle) {
+					entry.changes_result = T5_ERROR_DEVICE_LOST;
+					continue;
+				}
+
+				count = changed_glasses_params.size();
+				entry.changes_result = t5GetChangedGlassesParams(handle, changed_glasses_params.data(), &count);
+				if (entry.changes_result == T5_ERROR_OVERFLOW) {
+					entry.is_ipd_changed = true;
+					entry.is_name_changed = true;
+				} else if (entry.changes_result == T5_SUCCESS) {
+					for (int j = 0; j < count; ++j) {
+						entry.is_ipd_changed |= changed_glasses_params[j] == kT5_ParamGlasses_Float_IPD;
+						entry.is_name_changed |= changed_glasses_params[j] == kT5_ParamGlasses_UTF8_FriendlyName;
+					}
+				}
+
+				if (entry.is_ipd_changed)
+					entry.ipd_result = t5GetGlassesFloatParam(handle, 0, kT5_ParamGlasses_Float_IPD, &entry.ipd);
+				if (entry.is_name_changed) {
+					entry.name.resize(64);
+					size_t buffer_size = entry.name.size();
+					entry.name_result = t5GetGlassesUtf8Param(handle, 0, kT5_ParamGlasses_UTF8_FriendlyName, entry.name.data(), &buffer_size);
+				}
+			}
+		}
+
+		// Changes tend to come in runs, an IPD adjustment say,
+		// so a change brings the next poll forward
+		bool is_changed = is_attention_changed;
+		bool is_failed = is_lasting_error(system_result);
+		if (is_system_due) {
+			if (is_attention_changed && !is_first_pass)
+				system_schedule.reset();
+			system_next_poll = now + system_schedule.next(system_poll_state);
+		}
+		is_first_pass = false;
+		for (auto& entry : watched) {
+			if (!entry.is_due)
+				continue;
+			is_failed |= is_lasting_error(entry.changes_result);
+			if (entry.is_ipd_changed || entry.is_name_changed) {
+				entry.schedule.reset();
+				is_changed = true;
+			}
+			entry.next_poll = now + entry.schedule.next(entry.poll_state);
+		}
+		if (!is_changed && !is_failed)
+			continue;
+
+		for (int i = 0; i < watched.size(); ++i) {
+			auto& entry = watched[i];
+			if (entry.is_ipd_changed && entry.ipd_result == T5_SUCCESS)
+				_session_recorder->record_parameter(i, kT5_ParamGlasses_Float_IPD, entry.ipd);
+			if (entry.is_name_changed && entry.name_result == T5_SUCCESS)
+				_session_recorder->record_parameter(i, kT5_ParamGlasses_UTF8_FriendlyName, entry.name.data());
+		}
+
+		co_await run_in_foreground;
+
+		if (is_lasting_error(system_result))
+			LOG_T5_ERROR(system_result);
+		if (is_lasting_error(attention_result))
+			LOG_T5_ERROR(attention_result);
+
+		changes.clear();
+		if (is_attention_changed && attention_result == T5_SUCCESS) {
+			if (attention_required != 0)
+				_state.set(T5ServiceState::ATTENTION_REQUIRED);
+			else
+				_state.clear(T5ServiceState::ATTENTION_REQUIRED);
+			changes.push_back({ -1, kT5_ParamSys_Integer_CPL_AttRequired, static_cast<double>(attention_required) });
+		}
+		for (int i = 0; i < watched.size(); ++i) {
+			auto& entry = watched[i];
+			if (!entry.is_due)
+				continue;
+			if (is_lasting_error(entry.changes_result))
+				LOG_T5_ERROR(entry.changes_result);
+			if (entry.is_ipd_changed && entry.ipd_result == T5_SUCCESS) {
+				entry.glasses->_ipd = static_cast<float>(entry.ipd);
+				changes.push_back({ i, kT5_ParamGlasses_Float_IPD, entry.ipd });
+			}
+			if (entry.is_name_changed) {
+				if (entry.name_result == T5_SUCCESS) {
+					entry.glasses->_friendly_name = entry.name.data();
+					changes.push_back({ i, kT5_ParamGlasses_UTF8_FriendlyName, 0.0 });
+				} else if (entry.name_result == T5_ERROR_OVERFLOW) {
+					// Long names are read with a buffer sized to fit
+					_scheduler->add_task(entry.glasses->query_friendly_name());
+				}
+			}
+		}
+		for (auto& change : changes)
+			for (auto& listener : _parameter_listeners)
+				listener(change);
+	}
+}
+
 bool T5Service::is_service_started() {
 	return _state.is_current(T5ServiceState::RUNNING);
 }
@@ -233,7 +569,10 @@ void T5Service::release_glasses(int glasses_num) {
 }
 
 void T5Service::update_connection() {
-	_scheduler->schedule_tasks();
+	{
+		FrameTimer::Scope timed(*_frame_timer, FrameTimer::SCHEDULER);
+		_scheduler->schedule_tasks();
+	}
 	_scheduler->log_exceptions([](auto msg) { log_message("Scheduler exception: ", msg); });
 
 	for (int i = 0; i < _glasses_list.size(); ++i) {
@@ -247,12 +586,32 @@ void T5Service::update_tracking() {
 	if (!is_service_started())
 		return;
 
-	_scheduler->schedule_tasks();
+	{
+		FrameTimer::Scope timed(*_frame_timer, FrameTimer::SCHEDULER);
+		_scheduler->schedule_tasks();
+	}
 	_scheduler->log_exceptions([](auto msg) { log_message("Scheduler exception: ", msg); });
 
+	// Every pose is read under one acquisition, the tracking
+	// state logic and callbacks run after it is released
+	_pose_reads.clear();
 	for (auto& glasses : _glasses_list) {
 		if (glasses->is_connected())
-			glasses->update_tracking();
+			_pose_reads.push_back({ glasses.get(), T5_SUCCESS, {}, glasses->is_spectator_enabled(), T5_SUCCESS, {} });
+	}
+	if (!_pose_reads.empty()) {
+		auto lock = g_t5_exclusivity_group_1.acquire(CallSite::GLASSES_POSE);
+		for (auto& read : _pose_reads) {
+			read.result = t5GetGlassesPose(read.glasses->_glasses_handle, kT5_GlassesPoseUsage_GlassesPresentation, &read.pose);
+			if (read.is_spectator)
+				read.spectator_result = t5GetGlassesPose(read.glasses->_glasses_handle, kT5_GlassesPoseUsage_SpectatorPresentation, &read.spectator_pose);
+		}
+	}
+	for (auto& read : _pose_reads) {
+		read.glasses->apply_pose(read.result, read.pose);
+		if (read.is_spectator)
+			read.glasses->apply_spectator_pose(read.spectator_result, read.spectator_pose);
+		read.glasses->on_tracking_updated();
 	}
 
 	tracking_updated();
@@ -265,6 +624,9 @@ void T5Service::get_service_events(std::vector<T5ServiceEvent>& out_events) {
 	if (_state.became_set(_previous_event_state, T5ServiceState::T5_INCOMPATIBLE_VERSION)) {
 		out_events.push_back(T5ServiceEvent(T5ServiceEvent::E_T5_INCOMPATIBLE_VERSION));
 	}
+	if (_state.became_set(_previous_event_state, T5ServiceState::ATTENTION_REQUIRED)) {
+		out_events.push_back(T5ServiceEvent(T5ServiceEvent::E_T5_ATTENTION_REQUIRED));
+	}
 	if (_state.became_set(_previous_event_state, T5ServiceState::RUNNING)) {
 		out_events.push_back(T5ServiceEvent(T5ServiceEvent::E_RUNNING));
 	}
@@ -274,14 +636,64 @@ void T5Service::get_service_events(std::vector<T5ServiceEvent>& out_events) {
 	_previous_event_state.sync_from(_state);
 }
 
+void T5Service::set_standby_grace_period(std::chrono::milliseconds period) {
+	_standby_grace_period = period;
+	for (auto& glasses : _glasses_list)
+		glasses->set_standby_grace_period(period);
+	if (period <= 0ms)
+		release_standby();
+}
+
+void T5Service::release_standby() {
+	for (auto& glasses : _glasses_list)
+		glasses->release_standby();
+}
+
+void T5Service::add_parameter_listener(ParameterListener listener) {
+	_parameter_listeners.push_back(std::move(listener));
+}
+
 void T5Service::get_glasses_events(std::vector<GlassesEvent>& out_events) {
+	auto first_event = out_events.size();
 	for (int i = 0; i < _glasses_list.size(); ++i) {
 		_glasses_list[i]->get_events(i, out_events);
 	}
+	for (auto idx = first_event; idx < out_events.size(); ++idx) {
+		if (out_events[idx].event == GlassesEvent::E_CONNECTED)
+			_glasses_connected->add();
+		else if (out_events[idx].event == GlassesEvent::E_DISCONNECTED)
+			_glasses_disconnected->add();
+	}
+}
+
+bool T5Service::start_capture(const std::string& path) {
+	if (!_session_recorder->start(path)) {
+		LOG_ERROR(("Could not open session capture " + path).c_str());
+		return false;
+	}
+	// Glasses found before the capture started, with the state
+	// the integration last saw
+	for (int i = 0; i < _glasses_list.size(); ++i) {
+		auto& glasses = _glasses_list[i];
+		_session_recorder->record_glasses(i, glasses->get_id());
+		_session_recorder->record_parameter(i, kT5_ParamGlasses_Float_IPD, glasses->get_ipd());
+		_session_recorder->record_parameter(i, kT5_ParamGlasses_UTF8_FriendlyName, glasses->get_name());
+		if (glasses->is_connected())
+			_session_recorder->record_connection(i, kT5_ConnectionState_ExclusiveConnection);
+	}
+	return true;
+}
+
+void T5Service::stop_capture() {
+	_session_recorder->stop();
 }
 
 void T5Service::get_gameboard_size(T5_GameboardType gameboard_type, T5_GameboardSize& gameboard_size) {
-	auto result = t5GetGameboardSize(_context, gameboard_type, &gameboard_size);
+	T5_Result result;
+	{
+		auto lock = g_t5_exclusivity_group_1.acquire(CallSite::GAMEBOARD);
+		result = t5GetGameboardSize(_context, gameboard_type, &gameboard_size);
+	}
 	if (result != T5_SUCCESS)
 		LOG_T5_ERROR(result);
 }
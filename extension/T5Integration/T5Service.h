@@ -1,7 +1,11 @@
 #pragma once
+#include <CallBroker.h>
+#include <FrameTimer.h>
 #include <Glasses.h>
+#include <Metrics.h>
 #include <StateFlags.h>
 #include <TaskSystem.h>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -10,10 +14,11 @@ namespace T5Integration {
 
 using TaskSystem::CotaskPtr;
 using TaskSystem::run_in_foreground;
+using TaskSystem::run_now;
 using TaskSystem::Scheduler;
 using TaskSystem::task_sleep;
 
-extern std::mutex g_t5_exclusivity_group_1;
+extern CallBroker g_t5_exclusivity_group_1;
 //extern std::mutex g_t5_exclusivity_group_2;
 
 // Required minimum t5 service version
@@ -28,6 +33,7 @@ namespace T5ServiceState {
 
 	const uint16_t T5_UNAVAILABLE			= 0x0008; 
 	const uint16_t T5_INCOMPATIBLE_VERSION	= 0x0010; 
+	const uint16_t ATTENTION_REQUIRED		= 0x0020;
 	const uint16_t ERROR					= 0x1000; 
 };
 // clang-format on
@@ -42,7 +48,8 @@ struct T5ServiceEvent {
 		E_STOPPED					= 1,
 		E_RUNNING					= 2,
 		E_T5_UNAVAILABLE			= 3,
-		E_T5_INCOMPATIBLE_VERSION	= 4
+		E_T5_INCOMPATIBLE_VERSION	= 4,
+		E_T5_ATTENTION_REQUIRED		= 5
 	};
 	// clang-format on
 
@@ -52,6 +59,18 @@ struct T5ServiceEvent {
 	EType event;
 };
 
+// A parameter read after the service reported it changed
+struct ParameterChange {
+	// -1 for system parameters
+	int glasses_idx;
+	// A T5_ParamSys or T5_ParamGlasses
+	int param;
+	// Numeric value, string parameters are read from the glasses
+	double value;
+};
+
+using ParameterListener = std::function<void(const ParameterChange&)>;
+
 class T5Service {
 public:
 	using Ptr = std::shared_ptr<T5Service>;
@@ -85,10 +104,43 @@ public:
 
 	void get_gameboard_size(T5_GameboardType gameboard_type, T5_GameboardSize& gameboard_size);
 
+	// Captures poses, connection state, parameters, frames and wand
+	// events of all glasses to a file that T5Mock can replay
+	bool start_capture(const std::string& path);
+	void stop_capture();
+	bool is_capturing() const { return _session_recorder->is_recording(); }
+
+	// Poll intervals of the glasses monitors, shared by all glasses
+	PollingPolicy::Ptr get_polling_policy() { return _polling_policy; }
+
+	// Scheduler, NDK lock, tracking, wand and connection metrics
+	// of the service and all its glasses
+	MetricsRegistry::Ptr get_metrics() { return _metrics; }
+
+	// CPU time of each stage of a frame. The service times the
+	// scheduler, the caller of update_connection and update_tracking
+	// times and ends the other stages and ends the scheduler frame.
+	FrameTimer::Ptr get_frame_timer() { return _frame_timer; }
+
+	// Display textures of glasses whose display stopped, on a dropped
+	// reservation say, are kept this long for a reconnect to reuse
+	void set_standby_grace_period(std::chrono::milliseconds period);
+	// Frees the textures of all glasses on standby, when memory is low
+	virtual void release_standby();
+
+	// Listeners are called on the main thread after the changed
+	// values have been applied
+	void add_parameter_listener(ParameterListener listener);
+	// The Tilt Five control panel needs the user, for a firmware
+	// update say
+	bool is_attention_required() const { return _state.is_current(T5ServiceState::ATTENTION_REQUIRED); }
+
 protected:
 	CotaskPtr startup_checks();
 	CotaskPtr query_t5_service_version();
 	CotaskPtr query_glasses_list();
+	CotaskPtr watch_parameters();
+	bool add_listed_glasses(const std::string_view id);
 
 	virtual std::unique_ptr<Glasses> create_glasses(const std::string_view id);
 
@@ -108,6 +160,24 @@ protected:
 	std::string _t5_service_version;
 	std::vector<Glasses::Ptr> _glasses_list;
 
+	// Every glasses id seen, sorted by id. Unplugged glasses keep
+	// their index and get it back when they return.
+	struct GlassesSlot {
+		std::string id;
+		int glasses_idx;
+	};
+	std::vector<GlassesSlot> _glasses_slots;
+
+	struct PoseRead {
+		Glasses* glasses;
+		T5_Result result;
+		T5_GlassesPose pose;
+		bool is_spectator;
+		T5_Result spectator_result;
+		T5_GlassesPose spectator_pose;
+	};
+	std::vector<PoseRead> _pose_reads;
+
 	T5ServiceFlags _state;
 	T5ServiceFlags _previous_event_state;
 
@@ -116,6 +186,17 @@ protected:
 
 	T5_Result _last_error;
 
+	SessionRecorder::Ptr _session_recorder;
+	PollingPolicy::Ptr _polling_policy;
+	MetricsRegistry::Ptr _metrics;
+	FrameTimer::Ptr _frame_timer;
+	GlassesMetrics _glasses_metrics;
+	Histogram* _lock_wait;
+	Counter* _glasses_connected;
+	Counter* _glasses_disconnected;
+	std::vector<ParameterListener> _parameter_listeners;
+	std::chrono::milliseconds _standby_grace_period = 10s;
+
 	Scheduler::Ptr _scheduler;
 	T5_GraphicsApi _graphics_api;
 	T5_GraphicsContextGL _opengl_graphics_context;
@@ -263,6 +263,25 @@ void Scheduler::do_foreground_tasks() {
 	}
 	// all done tasks die here
 }
+size_t Scheduler::get_queue_depth() {
+	size_t depth = 0;
+	{
+		std::lock_guard lk(_background_run_mutex);
+		depth += _background_run_list.size();
+	}
+	{
+		std::lock_guard lk(_foreground_mutex);
+		depth += _foreground_list.size();
+	}
+	auto time_now = Clock::now();
+	std::lock_guard lk(_background_wait_mutex);
+	for (auto& task : _background_wait_list) {
+		if (task->get_scheduled_time() <= time_now)
+			++depth;
+	}
+	return depth;
+}
+
 std::list<std::exception_ptr> Scheduler::get_exceptions() {
 	std::list<std::exception_ptr> return_list;
 	std::lock_guard lk(_exception_mutex);
@@ -8,6 +8,7 @@
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <utility>
 
 namespace TaskSystem {
 
@@ -46,6 +47,10 @@ inline TaskStatus task_sleep(int duration) {
 	return { Clock::now() + Duration{ duration }, TaskStatus::BACKGROUND, nullptr };
 }
 
+inline TaskStatus task_sleep_until(TaskTime time) {
+	return { time, TaskStatus::BACKGROUND, nullptr };
+}
+
 inline TaskStatus capture_exception() {
 	return { TaskTime{}, TaskStatus::EXCEPTION_THROWN, std::current_exception() };
 }
@@ -294,6 +299,9 @@ public:
 	std::list<std::exception_ptr> get_exceptions();
 	void log_exceptions(ExceptionLogger func);
 
+	// Tasks due to run that haven't started yet
+	size_t get_queue_depth();
+
 private:
 	void do_background_tasks();
 	void queue_background_tasks();
@@ -1,10 +1,13 @@
+#include <CallBroker.h>
 #include <Logging.h>
 #include <Wand.h>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 namespace T5Integration {
 
-extern std::mutex g_t5_exclusivity_group_1;
+extern CallBroker g_t5_exclusivity_group_1;
 
 void Wand::update_from_stream_event(T5_WandStreamEvent& event) {
 	switch (event.type) {
@@ -16,6 +19,7 @@ void Wand::update_from_stream_event(T5_WandStreamEvent& event) {
 			_analog = WandAnalog{};
 			_pose = WandPose{};
 			_battery = 0;
+			_pose_timestamp = 0;
 		} break;
 		case kT5_WandStreamEventType_Disconnect: {
 			_state = WandState::SYNCED;
@@ -43,12 +47,15 @@ void Wand::update_from_stream_event(T5_WandStreamEvent& event) {
 
 			if (event.report.poseValid) {
 				_state |= WandState::POSE_VALID;
+				update_velocity(event.report, event.report.timestampNanos ? event.report.timestampNanos : event.timestampNanos);
 				_pose.rotToWND_GBD = event.report.rotToWND_GBD;
 				_pose.posAim_GBD = event.report.posAim_GBD;
 				_pose.posFingertips_GBD = event.report.posFingertips_GBD;
 				_pose.posGrip_GBD = event.report.posGrip_GBD;
-			} else
+			} else {
 				_state &= ~WandState::POSE_VALID;
+				reset_velocity();
+			}
 			if (event.report.batteryValid) {
 				_state |= WandState::BATTERY_VALID;
 				_battery = event.report.battery;
@@ -59,6 +66,64 @@ void Wand::update_from_stream_event(T5_WandStreamEvent& event) {
 	}
 }
 
+void Wand::update_velocity(const T5_WandReport& report, uint64_t timestamp) {
+	auto previous_timestamp = _pose_timestamp;
+	_pose_timestamp = timestamp;
+
+	if (previous_timestamp == 0 || timestamp <= previous_timestamp)
+		return;
+	auto delta_ns = timestamp - previous_timestamp;
+	if (delta_ns > g_wand_velocity_max_gap_ns) {
+		_pose.linearVelocity_GBD = T5_Vec3{};
+		_pose.angularVelocity_GBD = T5_Vec3{};
+		return;
+	}
+	float inv_dt = 1.0e9f / static_cast<float>(delta_ns);
+
+	T5_Vec3 linear;
+	linear.x = (report.posAim_GBD.x - _pose.posAim_GBD.x) * inv_dt;
+	linear.y = (report.posAim_GBD.y - _pose.posAim_GBD.y) * inv_dt;
+	linear.z = (report.posAim_GBD.z - _pose.posAim_GBD.z) * inv_dt;
+
+	// rotToWND_GBD takes gameboard points into the wand frame so the
+	// wand orientation is its inverse. The rotation between reports
+	// in the gameboard frame is then inv(q_now) * q_prev
+	auto& q_now = report.rotToWND_GBD;
+	auto& q_prev = _pose.rotToWND_GBD;
+	float dw = q_now.w * q_prev.w + q_now.x * q_prev.x + q_now.y * q_prev.y + q_now.z * q_prev.z;
+	float dx = q_now.w * q_prev.x - q_now.x * q_prev.w - q_now.y * q_prev.z + q_now.z * q_prev.y;
+	float dy = q_now.w * q_prev.y + q_now.x * q_prev.z - q_now.y * q_prev.w - q_now.z * q_prev.x;
+	float dz = q_now.w * q_prev.z - q_now.x * q_prev.y + q_now.y * q_prev.x - q_now.z * q_prev.w;
+	if (dw < 0) {
+		dw = -dw;
+		dx = -dx;
+		dy = -dy;
+		dz = -dz;
+	}
+	float sin_half = std::sqrt(dx * dx + dy * dy + dz * dz);
+	// Small angle approximation avoids dividing by ~0
+	float scale = sin_half > 1.0e-6f ? 2.0f * std::atan2(sin_half, dw) / sin_half : 2.0f;
+
+	T5_Vec3 angular;
+	angular.x = dx * scale * inv_dt;
+	angular.y = dy * scale * inv_dt;
+	angular.z = dz * scale * inv_dt;
+
+	auto blend = [](T5_Vec3& smoothed, const T5_Vec3& sample) {
+		smoothed.x += g_wand_velocity_smoothing * (sample.x - smoothed.x);
+		smoothed.y += g_wand_velocity_smoothing * (sample.y - smoothed.y);
+		smoothed.z += g_wand_velocity_smoothing * (sample.z - smoothed.z);
+	};
+	blend(_pose.linearVelocity_GBD, linear);
+	blend(_pose.angularVelocity_GBD, angular);
+}
+
+void Wand::reset_velocity() {
+	_pose_timestamp = 0;
+	_pose.linearVelocity_GBD = T5_Vec3{};
+	_pose.angularVelocity_GBD = T5_Vec3{};
+}
+
 void Wand::update_from_wand(const Wand& other_wand) {
 	_state = other_wand._state;
 	if (_state & WandState::BUTTONS_VALID)
@@ -71,6 +136,84 @@ void Wand::update_from_wand(const Wand& other_wand) {
 		_battery = other_wand._battery;
 }
 
+void HapticQueue::push(T5_WandHandle wand_handle, float amplitude, uint16_t duration) {
+	auto now = Clock::now();
+	amplitude = std::clamp(amplitude, 0.0f, 1.0f);
+	auto end = now + std::chrono::milliseconds(duration);
+
+	std::lock_guard lock(_access);
+	auto it = std::find_if(_wands.begin(), _wands.end(),
+			[wand_handle](auto& entry) {
+				return entry.handle == wand_handle;
+			});
+	if (it == _wands.end()) {
+		_wands.push_back(WandHaptics{ wand_handle, false, 0, now, 0, now, now });
+		it = _wands.end() - 1;
+	}
+
+	auto& wand = *it;
+	if (wand.is_pending) {
+		wand.pending_amplitude = std::max(wand.pending_amplitude, amplitude);
+		wand.pending_end = std::max(wand.pending_end, end);
+	} else if (amplitude > wand.playing_amplitude) {
+		wand.is_pending = true;
+		wand.pending_amplitude = amplitude;
+		wand.pending_end = std::max(wand.playing_end, end);
+	} else if (end > wand.playing_end) {
+		// Only extends the current pulse, no need to send before it runs out
+		wand.is_pending = true;
+		wand.pending_amplitude = amplitude;
+		wand.pending_end = end;
+		wand.next_send = std::max(wand.next_send, wand.playing_end - _min_send_interval);
+	}
+	// Otherwise the pulse already playing covers this request
+}
+
+void HapticQueue::take_ready(std::vector<HapticPulse>& out_pulses) {
+	out_pulses.clear();
+	auto now = Clock::now();
+
+	std::lock_guard lock(_access);
+	for (auto& wand : _wands) {
+		if (!wand.is_pending || now < wand.next_send)
+			continue;
+
+		auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(wand.pending_end - now).count();
+		if (remaining <= 0) {
+			wand.is_pending = false;
+			continue;
+		}
+		auto duration = static_cast<uint16_t>(std::min<long long>(remaining, g_haptic_max_duration_ms));
+		out_pulses.push_back(HapticPulse{ wand.handle, wand.pending_amplitude, duration });
+
+		wand.playing_amplitude = wand.pending_amplitude;
+		wand.playing_end = now + std::chrono::milliseconds(duration);
+		wand.next_send = now + _min_send_interval;
+
+		if (wand.playing_end < wand.pending_end) {
+			// Longer than one impulse, continue it just before this one runs out
+			wand.next_send = std::max(wand.next_send, wand.playing_end - _min_send_interval);
+		} else {
+			wand.is_pending = false;
+		}
+	}
+}
+
+std::optional<HapticQueue::Clock::time_point> HapticQueue::get_next_send() {
+	std::optional<Clock::time_point> next_send;
+	std::lock_guard lock(_access);
+	for (auto& wand : _wands) {
+		if (wand.is_pending && (!next_send || wand.next_send < *next_send))
+			next_send = wand.next_send;
+	}
+	return next_send;
+}
+
+void HapticQueue::clear() {
+	std::lock_guard lock(_access);
+	_wands.clear();
+}
+
 bool WandService::start(T5_Glasses handle) {
 	_glasses_handle = handle;
 	_last_wand_error = T5_SUCCESS;
@@ -98,9 +241,8 @@ bool WandService::configure_wand_tracking(bool enable) {
 
 	for (int tries = 0; tries < 10; ++tries) {
 		T5_WandStreamConfig config{ enable };
-		T5_Result result;
 		{
-			std::lock_guard lock(g_t5_exclusivity_group_1);
+			auto lock = g_t5_exclusivity_group_1.acquire(CallSite::WAND_STREAM);
 			result = t5ConfigureWandStreamForGlasses(_glasses_handle, &config);
 		}
 		if (result != T5_ERROR_NO_SERVICE && result != T5_ERROR_IO_FAILURE) {
@@ -122,9 +264,31 @@ T5_Result WandService::get_last_error() {
 	return tmp;
 }
 
+bool WandService::record_to(const std::string& path) {
+	return _recorder.open(path);
+}
+
+void WandService::replay_from(WandRecording::Ptr recording, WandReplayMode mode) {
+	_replay = recording;
+	_replay_mode = mode;
+	_is_replay_finished = false;
+}
+
+void WandService::capture_to(SessionRecorder::Ptr recorder, int glasses_idx) {
+	_session_recorder = recorder;
+	_session_glasses_idx = glasses_idx;
+}
+
 void WandService::monitor_wands(std::stop_token s_token) {
-	if (!configure_wand_tracking(true))
+	if (_replay) {
+		replay_wands(s_token);
+		return;
+	}
+
+	if (!configure_wand_tracking(true)) {
+		_running = false;
 		return;
+	}
 
 	while (!s_token.stop_requested()) {
 		T5_WandStreamEvent event;
@@ -135,22 +299,60 @@ void WandService::monitor_wands(std::stop_token s_token) {
 		else if (result != T5_SUCCESS) {
 			_last_wand_error = result;
 			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			continue;
 		}
 
-		if (event.type != kT5_WandStreamEventType_Desync) {
-			std::lock_guard lock(_list_access);
-			auto wand_ptr = find_wand(_wand_list, event.wandId);
-			auto wand = wand_ptr ? wand_ptr : &_wand_list.emplace_back();
-			wand->update_from_stream_event(event);
-		} else {
-			std::lock_guard lock(_list_access);
-			for (auto& wand : _wand_list) {
-				wand._state = 0;
+		_recorder.record(event);
+		if (_session_recorder)
+			_session_recorder->record_wand_event(_session_glasses_idx, event);
+		apply_event(event);
+	}
+
+	_recorder.close();
+	configure_wand_tracking(false);
+	_running = false;
+}
+
+void WandService::replay_wands(std::stop_token s_token) {
+	using Clock = std::chrono::steady_clock;
+
+	WandRecording::Reader reader(*_replay);
+	T5_WandStreamEvent event;
+	uint64_t previous_timestamp = 0;
+	auto due_time = Clock::now();
+
+	while (!s_token.stop_requested() && reader.next(event)) {
+		if (_replay_mode == WandReplayMode::REAL_TIME) {
+			if (previous_timestamp != 0 && event.timestampNanos > previous_timestamp) {
+				due_time += std::min<Clock::duration>(std::chrono::nanoseconds(event.timestampNanos - previous_timestamp), g_wand_replay_max_gap);
 			}
+			previous_timestamp = event.timestampNanos;
+
+			while (!s_token.stop_requested() && Clock::now() < due_time)
+				std::this_thread::sleep_for(std::min<Clock::duration>(due_time - Clock::now(), _poll_rate_for_retry));
 		}
+		apply_event(event);
 	}
+	_is_replay_finished = true;
 
-	configure_wand_tracking(false);
+	// Hold the last state until stopped like a live stream would
+	while (!s_token.stop_requested())
+		std::this_thread::sleep_for(_poll_rate_for_retry);
 	_running = false;
 }
+
+void WandService::apply_event(T5_WandStreamEvent& event) {
+	if (_event_counter)
+		_event_counter->add();
+	std::lock_guard lock(_list_access);
+	if (event.type != kT5_WandStreamEventType_Desync) {
+		auto wand_ptr = find_wand(_wand_list, event.wandId);
+		auto wand = wand_ptr ? wand_ptr : &_wand_list.emplace_back();
+		wand->update_from_stream_event(event);
+	} else {
+		for (auto& wand : _wand_list) {
+			wand._state = 0;
+		}
+	}
+}
 } //namespace T5Integration
@@ -1,7 +1,13 @@
 #pragma once
+#include <Metrics.h>
+#include <SessionCapture.h>
 #include <TiltFiveNative.h>
+#include <WandRecording.h>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <mutex>
+#include <optional>
 #include <thread>
 #include <vector>
 
@@ -18,6 +24,17 @@ const uint8_t POSE_VALID = 0x10;
 const uint8_t BATTERY_VALID = 0x20;
 }; //namespace WandState
 
+// Longest impulse t5SendImpulse accepts
+uint16_t const g_haptic_max_duration_ms = 320;
+
+// Weight given to the newest finite difference when smoothing wand velocities
+float const g_wand_velocity_smoothing = 0.5f;
+// Reports further apart than this restart the velocity estimate
+uint64_t const g_wand_velocity_max_gap_ns = 100'000'000;
+
+// Longest pause between events when replaying a recording in real time
+std::chrono::milliseconds const g_wand_replay_max_gap = 1s;
+
 struct WandButtons {
 	bool t5 : 1;
 	bool one : 1;
@@ -39,6 +56,11 @@ struct WandPose {
 	T5_Vec3 posAim_GBD;
 	T5_Vec3 posFingertips_GBD;
 	T5_Vec3 posGrip_GBD;
+	// Estimated from successive reports, gameboard frame.
+	// Linear velocity of the aim point in m/s,
+	// angular velocity as axis * rad/s
+	T5_Vec3 linearVelocity_GBD;
+	T5_Vec3 angularVelocity_GBD;
 };
 
 struct Wand {
@@ -48,19 +70,72 @@ struct Wand {
 	WandAnalog _analog;
 	WandPose _pose;
 	uint8_t _battery;
+	uint64_t _pose_timestamp;
 
 	void update_from_stream_event(T5_WandStreamEvent& event);
 	void update_from_wand(const Wand& other_wand);
+
+private:
+	void update_velocity(const T5_WandReport& report, uint64_t timestamp);
+	void reset_velocity();
 };
 
 using WandList = std::vector<Wand>;
 
+struct HapticPulse {
+	T5_WandHandle wand_handle;
+	float amplitude;
+	uint16_t duration;
+};
+
+// Collects haptic requests from any thread and hands them out
+// at a rate the wands accept. Requests that overlap a pending
+// or playing pulse are merged into it (max amplitude, latest end).
+class HapticQueue {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	void push(T5_WandHandle wand_handle, float amplitude, uint16_t duration);
+	void take_ready(std::vector<HapticPulse>& out_pulses);
+	// When the next pending pulse can be sent, none if nothing is pending
+	std::optional<Clock::time_point> get_next_send();
+	void clear();
+
+private:
+	struct WandHaptics {
+		T5_WandHandle handle;
+		bool is_pending;
+		float pending_amplitude;
+		Clock::time_point pending_end;
+		float playing_amplitude;
+		Clock::time_point playing_end;
+		Clock::time_point next_send;
+	};
+
+	std::mutex _access;
+	std::vector<WandHaptics> _wands;
+
+	std::chrono::milliseconds _min_send_interval = 20ms;
+};
+
+enum class WandReplayMode {
+	REAL_TIME,
+	AS_FAST_AS_POSSIBLE
+};
+
 class WandService {
 public:
 	bool start(T5_Glasses handle);
 	void stop();
 	bool is_running();
 
+	// These must be called before start
+	bool record_to(const std::string& path);
+	void replay_from(WandRecording::Ptr recording, WandReplayMode mode);
+	void capture_to(SessionRecorder::Ptr recorder, int glasses_idx);
+	void count_events_in(Counter* counter) { _event_counter = counter; }
+	bool is_replay_finished() { return _is_replay_finished; }
+
 	void get_wand_data(WandList& list);
 
 	T5_Result get_last_error();
@@ -68,10 +143,20 @@ public:
 private:
 	bool configure_wand_tracking(bool enable);
 	void monitor_wands(std::stop_token s_token);
+	void replay_wands(std::stop_token s_token);
+	void apply_event(T5_WandStreamEvent& event);
 
 	T5_Glasses _glasses_handle;
 	WandList _wand_list;
 
+	WandRecorder _recorder;
+	WandRecording::Ptr _replay;
+	WandReplayMode _replay_mode = WandReplayMode::REAL_TIME;
+	std::atomic_bool _is_replay_finished = false;
+	SessionRecorder::Ptr _session_recorder;
+	int _session_glasses_idx = 0;
+	Counter* _event_counter = nullptr;
+
 	std::jthread _thread;
 	std::mutex _list_access;
 	std::atomic_bool _running;
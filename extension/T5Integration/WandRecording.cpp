@@ -0,0 +1,235 @@
+#include <WandRecording.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace T5Integration {
+
+namespace {
+
+int16_t to_snorm16(float value) {
+	return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+float from_snorm16(int16_t value) {
+	return std::max(static_cast<float>(value) / 32767.0f, -1.0f);
+}
+
+uint16_t to_unorm16(float value) {
+	return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+}
+
+float from_unorm16(uint16_t value) {
+	return static_cast<float>(value) / 65535.0f;
+}
+
+void to_floats(const T5_Vec3& vec, float out[3]) {
+	out[0] = vec.x;
+	out[1] = vec.y;
+	out[2] = vec.z;
+}
+
+T5_Vec3 from_floats(const float in[3]) {
+	return T5_Vec3{ in[0], in[1], in[2] };
+}
+
+void encode_report(const T5_WandReport& report, WandRecord& record) {
+	record.flags = (report.analogValid ? 0x01 : 0) |
+			(report.batteryValid ? 0x02 : 0) |
+			(report.buttonsValid ? 0x04 : 0) |
+			(report.poseValid ? 0x08 : 0) |
+			((static_cast<uint8_t>(report.hand) & 0x03) << 4);
+
+	auto& buttons = report.buttons;
+	record.buttons = (buttons.t5 ? 0x01 : 0) |
+			(buttons.one ? 0x02 : 0) |
+			(buttons.two ? 0x04 : 0) |
+			(buttons.three ? 0x08 : 0) |
+			(buttons.a ? 0x10 : 0) |
+			(buttons.b ? 0x20 : 0) |
+			(buttons.x ? 0x40 : 0) |
+			(buttons.y ? 0x80 : 0);
+
+	record.battery = report.battery;
+	record.stick[0] = to_snorm16(report.stick.x);
+	record.stick[1] = to_snorm16(report.stick.y);
+	record.trigger = to_unorm16(report.trigger);
+
+	auto& quat = report.rotToWND_GBD;
+	float length = std::sqrt(quat.w * quat.w + quat.x * quat.x + quat.y * quat.y + quat.z * quat.z);
+	float scale = length > 0.0f ? 1.0f / length : 0.0f;
+	record.rotation[0] = to_snorm16(quat.w * scale);
+	record.rotation[1] = to_snorm16(quat.x * scale);
+	record.rotation[2] = to_snorm16(quat.y * scale);
+	record.rotation[3] = to_snorm16(quat.z * scale);
+
+	to_floats(report.posAim_GBD, record.pos_aim);
+	to_floats(report.posFingertips_GBD, record.pos_fingertips);
+	to_floats(report.posGrip_GBD, record.pos_grip);
+}
+
+void decode_report(const WandRecord& record, T5_WandReport& report) {
+	report.analogValid = record.flags & 0x01;
+	report.batteryValid = record.flags & 0x02;
+	report.buttonsValid = record.flags & 0x04;
+	report.poseValid = record.flags & 0x08;
+	report.hand = static_cast<T5_Hand>((record.flags >> 4) & 0x03);
+
+	auto& buttons = report.buttons;
+	buttons.t5 = record.buttons & 0x01;
+	buttons.one = record.buttons & 0x02;
+	buttons.two = record.buttons & 0x04;
+	buttons.three = record.buttons & 0x08;
+	buttons.a = record.buttons & 0x10;
+	buttons.b = record.buttons & 0x20;
+	buttons.x = record.buttons & 0x40;
+	buttons.y = record.buttons & 0x80;
+
+	report.battery = record.battery;
+	report.stick = T5_Vec2{ from_snorm16(record.stick[0]), from_snorm16(record.stick[1]) };
+	report.trigger = from_unorm16(record.trigger);
+
+	T5_Quat quat{ from_snorm16(record.rotation[0]), from_snorm16(record.rotation[1]), from_snorm16(record.rotation[2]), from_snorm16(record.rotation[3]) };
+	float length = std::sqrt(quat.w * quat.w + quat.x * quat.x + quat.y * quat.y + quat.z * quat.z);
+	if (length > 0.0f) {
+		quat.w /= length;
+		quat.x /= length;
+		quat.y /= length;
+		quat.z /= length;
+	}
+	report.rotToWND_GBD = quat;
+
+	report.posAim_GBD = from_floats(record.pos_aim);
+	report.posFingertips_GBD = from_floats(record.pos_fingertips);
+	report.posGrip_GBD = from_floats(record.pos_grip);
+}
+
+} //namespace
+
+void encode_wand_event(const T5_WandStreamEvent& event, WandRecord& out_record) {
+	out_record = {};
+	out_record.type = static_cast<uint8_t>(event.type);
+	out_record.wand_id = event.wandId;
+	if (event.type == kT5_WandStreamEventType_Report) {
+		auto offset = static_cast<int64_t>(event.report.timestampNanos - event.timestampNanos);
+		out_record.report_offset_ns = static_cast<int32_t>(std::clamp<int64_t>(offset, INT32_MIN, INT32_MAX));
+		encode_report(event.report, out_record);
+	}
+}
+
+void decode_wand_event(const WandRecord& record, uint64_t timestamp, T5_WandStreamEvent& out_event) {
+	out_event = {};
+	out_event.wandId = record.wand_id;
+	out_event.type = static_cast<T5_WandStreamEventType>(record.type);
+	out_event.timestampNanos = timestamp;
+	if (out_event.type == kT5_WandStreamEventType_Report) {
+		out_event.report.timestampNanos = timestamp + record.report_offset_ns;
+		decode_report(record, out_event.report);
+	}
+}
+
+WandRecorder::~WandRecorder() {
+	close();
+}
+
+bool WandRecorder::open(const std::string& path) {
+	close();
+
+	_file = std::fopen(path.c_str(), "ab");
+	if (!_file)
+		return false;
+
+	// Appending to an existing recording continues it
+	std::fseek(_file, 0, SEEK_END);
+	if (std::ftell(_file) == 0) {
+		WandRecordingHeader header = {};
+		header.magic = g_wand_recording_magic;
+		header.version = g_wand_recording_version;
+		header.record_size = sizeof(WandRecord);
+		std::fwrite(&header, sizeof(header), 1, _file);
+	}
+	_has_timestamp = false;
+	return true;
+}
+
+void WandRecorder::close() {
+	if (_file) {
+		std::fclose(_file);
+		_file = nullptr;
+	}
+}
+
+void WandRecorder::record(const T5_WandStreamEvent& event) {
+	if (!_file)
+		return;
+
+	auto delta = event.timestampNanos - _last_timestamp;
+	if (!_has_timestamp || event.timestampNanos < _last_timestamp || delta > UINT32_MAX) {
+		WandRecord timestamp_record = {};
+		timestamp_record.type = WandRecord::TIMESTAMP;
+		timestamp_record.delta_ns = static_cast<uint32_t>(event.timestampNanos);
+		timestamp_record.report_offset_ns = static_cast<int32_t>(event.timestampNanos >> 32);
+		write(timestamp_record);
+
+		_has_timestamp = true;
+		delta = 0;
+	}
+	_last_timestamp = event.timestampNanos;
+
+	WandRecord record;
+	encode_wand_event(event, record);
+	record.delta_ns = static_cast<uint32_t>(delta);
+	write(record);
+}
+
+void WandRecorder::write(const WandRecord& record) {
+	std::fwrite(&record, sizeof(record), 1, _file);
+}
+
+WandRecording::Ptr WandRecording::open(const std::string& path) {
+	auto recording = std::make_shared<WandRecording>();
+	if (!recording->_file.open(path))
+		return nullptr;
+
+	auto size = recording->_file.size();
+	if (size < sizeof(WandRecordingHeader))
+		return nullptr;
+
+	WandRecordingHeader header;
+	std::memcpy(&header, recording->_file.data(), sizeof(header));
+	if (header.magic != g_wand_recording_magic ||
+			header.version != g_wand_recording_version ||
+			header.record_size != sizeof(WandRecord))
+		return nullptr;
+
+	// A partly written last record is ignored
+	recording->_record_count = (size - sizeof(WandRecordingHeader)) / sizeof(WandRecord);
+	return recording;
+}
+
+const WandRecord* WandRecording::get_records() const {
+	return reinterpret_cast<const WandRecord*>(_file.data() + sizeof(WandRecordingHeader));
+}
+
+bool WandRecording::Reader::next(T5_WandStreamEvent& out_event) {
+	auto records = _recording.get_records();
+	while (_next_record < _recording._record_count) {
+		auto& record = records[_next_record++];
+
+		if (record.type == WandRecord::TIMESTAMP) {
+			_timestamp = (static_cast<uint64_t>(static_cast<uint32_t>(record.report_offset_ns)) << 32) | record.delta_ns;
+			continue;
+		}
+		_timestamp += record.delta_ns;
+		decode_wand_event(record, _timestamp, out_event);
+		return true;
+	}
+	return false;
+}
+
+void WandRecording::Reader::rewind() {
+	_next_record = 0;
+	_timestamp = 0;
+}
+
+} //namespace T5Integration
@@ -0,0 +1,110 @@
+#pragma once
+#include <MappedFile.h>
+#include <TiltFiveNative.h>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+namespace T5Integration {
+
+// Wand stream recordings are a 32 byte header followed by 64 byte records,
+// one per T5_WandStreamEvent. Event timestamps are stored as the delta from
+// the previous event, with a timestamp record written first and whenever a
+// delta doesn't fit in 32 bits. Quaternions, stick and trigger are stored
+// as 16 bit normalized integers, positions as floats.
+
+const uint32_t g_wand_recording_magic = 0x52573554; // "T5WR"
+const uint16_t g_wand_recording_version = 1;
+
+struct WandRecordingHeader {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t record_size;
+	uint8_t reserved[24];
+};
+
+struct WandRecord {
+	enum Type : uint8_t {
+		TIMESTAMP = 0
+		// Other values are T5_WandStreamEventType
+	};
+
+	// TIMESTAMP records hold the absolute time split across
+	// delta_ns (low bits) and report_offset_ns (high bits)
+	uint32_t delta_ns;
+	int32_t report_offset_ns;
+	uint8_t type;
+	uint8_t wand_id;
+	// analog, battery, buttons and pose valid bits then hand in bits 4-5
+	uint8_t flags;
+	uint8_t buttons;
+	uint8_t battery;
+	uint8_t reserved;
+	int16_t stick[2];
+	uint16_t trigger;
+	int16_t rotation[4];
+	float pos_aim[3];
+	float pos_fingertips[3];
+	float pos_grip[3];
+};
+
+static_assert(sizeof(WandRecordingHeader) == 32);
+static_assert(sizeof(WandRecord) == 64);
+
+// Encode everything but the event timestamp, which the caller stores
+void encode_wand_event(const T5_WandStreamEvent& event, WandRecord& out_record);
+void decode_wand_event(const WandRecord& record, uint64_t timestamp, T5_WandStreamEvent& out_event);
+
+// Appends events to a recording. Not thread safe, owned by the
+// thread reading the wand stream.
+class WandRecorder {
+public:
+	WandRecorder() = default;
+	~WandRecorder();
+
+	bool open(const std::string& path);
+	void close();
+	bool is_open() const { return _file != nullptr; }
+
+	void record(const T5_WandStreamEvent& event);
+
+private:
+	void write(const WandRecord& record);
+
+	std::FILE* _file = nullptr;
+	uint64_t _last_timestamp = 0;
+	bool _has_timestamp = false;
+};
+
+// Memory mapped recording. Decoding is sequential because of the
+// delta encoded timestamps.
+class WandRecording {
+public:
+	using Ptr = std::shared_ptr<const WandRecording>;
+
+	class Reader {
+	public:
+		Reader(const WandRecording& recording) :
+				_recording(recording) {}
+
+		bool next(T5_WandStreamEvent& out_event);
+		void rewind();
+
+	private:
+		const WandRecording& _recording;
+		size_t _next_record = 0;
+		uint64_t _timestamp = 0;
+	};
+
+	static Ptr open(const std::string& path);
+
+	size_t get_record_count() const { return _record_count; }
+
+private:
+	const WandRecord* get_records() const;
+
+	MappedFile _file;
+	size_t _record_count = 0;
+};
+
+} //namespace T5Integration
@@ -0,0 +1,206 @@
+#include <Headless.h>
+#include <cassert>
+
+namespace T5Headless {
+
+void HeadlessMath::rotate_vector(float quat_x, float quat_y, float quat_z, float quat_w, float& vec_x, float& vec_y, float& vec_z, bool inverse) {
+	if (inverse) {
+		quat_x = -quat_x;
+		quat_y = -quat_y;
+		quat_z = -quat_z;
+	}
+	// v' = v + 2w(q x v) + 2q x (q x v)
+	float tx = 2.0f * (quat_y * vec_z - quat_z * vec_y);
+	float ty = 2.0f * (quat_z * vec_x - quat_x * vec_z);
+	float tz = 2.0f * (quat_x * vec_y - quat_y * vec_x);
+
+	vec_x += quat_w * tx + (quat_y * tz - quat_z * ty);
+	vec_y += quat_w * ty + (quat_z * tx - quat_x * tz);
+	vec_z += quat_w * tz + (quat_x * ty - quat_y * tx);
+}
+
+HeadlessGlasses::SwapChainTextures::SwapChainTextures(HeadlessGlasses& glasses) :
+		glasses(glasses) {
+	++glasses._live_slot_textures;
+}
+
+HeadlessGlasses::SwapChainTextures::~SwapChainTextures() {
+	--glasses._live_slot_textures;
+	if (std::this_thread::get_id() != glasses._main_thread)
+		++glasses._off_thread_frees;
+}
+
+void HeadlessGlasses::on_start_display() {
+	++_texture_allocations;
+	_has_textures = true;
+	// Any non null handles will do for the mock
+	for (int i = 0; i < get_swap_chain_size(); ++i) {
+		set_swap_chain_texture_pair(i, (_texture_allocations << 8) + i * 2 + 1, (_texture_allocations << 8) + i * 2 + 2);
+		set_swap_chain_resources(i, std::make_shared<SwapChainTextures>(*this));
+	}
+}
+
+void HeadlessGlasses::on_stop_display() {
+	_has_textures = false;
+	for (int i = 0; i < get_swap_chain_size(); ++i) {
+		set_swap_chain_texture_pair(i, 0, 0);
+		set_swap_chain_resources(i, nullptr);
+	}
+}
+
+HeadlessService::HeadlessService() {
+	T5_GraphicsContextGL graphics_context;
+	graphics_context.textureMode = kT5_GraphicsApi_GL_TextureMode_Pair;
+	graphics_context.leftEyeArrayIndex = 0;
+	graphics_context.rightEyeArrayIndex = 1;
+	set_graphics_context(graphics_context);
+}
+
+HeadlessService::~HeadlessService() {
+	stop_render_thread();
+}
+
+void HeadlessService::run_frame(std::vector<GlassesEvent>& out_events) {
+	{
+		FrameTimer::Scope timed(*_frame_timer, FrameTimer::PROCESS);
+		update_connection();
+		update_tracking();
+
+		auto first_event = out_events.size();
+		get_glasses_events(out_events);
+		for (auto idx = first_event; idx < out_events.size(); ++idx) {
+			auto& glasses = _glasses_list[out_events[idx].glasses_num];
+			switch (out_events[idx].event) {
+				case GlassesEvent::E_ADDED:
+					reserve_glasses(out_events[idx].glasses_num, "T5 Mock Session");
+					break;
+				case GlassesEvent::E_CONNECTED:
+					glasses->start_display();
+					break;
+				case GlassesEvent::E_DISCONNECTED:
+					glasses->stop_display();
+					break;
+				default:
+					break;
+			}
+		}
+	}
+	_frame_timer->end_frame(FrameTimer::PROCESS);
+	_frame_timer->end_frame(FrameTimer::SCHEDULER);
+
+	// Glasses added later are rendered from the next frame
+	std::vector<Glasses::Ptr> glasses_list(_glasses_list.begin(), _glasses_list.end());
+	if (!_is_threaded_render) {
+		render(glasses_list);
+		return;
+	}
+	wait_for_render();
+	std::lock_guard lock(_render_access);
+	_render_list = std::move(glasses_list);
+	_is_render_queued = true;
+	_render_changed.notify_all();
+}
+
+void HeadlessService::set_threaded_render(bool is_threaded) {
+	if (is_threaded == _is_threaded_render)
+		return;
+	if (is_threaded) {
+		_is_render_stopping = false;
+		_render_thread = std::thread(&HeadlessService::render_loop, this);
+	} else {
+		stop_render_thread();
+	}
+	_is_threaded_render = is_threaded;
+}
+
+void HeadlessService::wait_for_render() {
+	std::unique_lock lock(_render_access);
+	_render_changed.wait(lock, [this]() { return !_is_render_queued; });
+}
+
+void HeadlessService::render_loop() {
+	std::unique_lock lock(_render_access);
+	while (true) {
+		_render_changed.wait(lock, [this]() { return _is_render_queued || _is_render_stopping; });
+		if (!_is_render_queued)
+			break;
+		auto glasses_list = std::move(_render_list);
+		lock.unlock();
+		render(glasses_list);
+		glasses_list.clear();
+		lock.lock();
+		_is_render_queued = false;
+		_render_changed.notify_all();
+	}
+}
+
+void HeadlessService::stop_render_thread() {
+	if (!_render_thread.joinable())
+		return;
+	{
+		std::lock_guard lock(_render_access);
+		_is_render_stopping = true;
+		_render_changed.notify_all();
+	}
+	_render_thread.join();
+}
+
+void HeadlessService::render(const std::vector<Glasses::Ptr>& glasses_list) {
+	for (auto& glasses : glasses_list) {
+		glasses->initialize_pending_graphics();
+		if (glasses->should_render_frame()) {
+			{
+				FrameTimer::Scope timed(*_frame_timer, FrameTimer::PRE_DRAW);
+				glasses->begin_frame();
+			}
+			FrameTimer::Scope timed(*_frame_timer, FrameTimer::END_FRAME);
+			glasses->send_frame();
+		} else {
+			FrameTimer::Scope timed(*_frame_timer, FrameTimer::END_FRAME);
+			glasses->resend_frame();
+		}
+	}
+	_frame_timer->end_frame(FrameTimer::PRE_DRAW);
+	_frame_timer->end_frame(FrameTimer::END_FRAME);
+}
+
+std::unique_ptr<Glasses> HeadlessService::create_glasses(const std::string_view id) {
+	return std::make_unique<HeadlessGlasses>(id);
+}
+
+bool HeadlessService::should_glasses_be_reserved(int glasses_idx) {
+	return !_reserve_filter || _reserve_filter(glasses_idx);
+}
+
+bool HeadlessService::is_glasses_connected(int glasses_idx) {
+	return glasses_idx < _glasses_list.size() && _glasses_list[glasses_idx]->is_connected();
+}
+
+HeadlessService::Ptr HeadlessObjectRegistry::service() {
+	assert(_instance);
+	return std::static_pointer_cast<HeadlessService>(ObjectRegistry::service());
+}
+
+T5Integration::T5Service::Ptr HeadlessObjectRegistry::get_service() {
+	HeadlessService::Ptr service;
+	if (_service.expired()) {
+		service = std::make_shared<HeadlessService>();
+		_service = service;
+	} else {
+		service = _service.lock();
+	}
+	return service;
+}
+
+T5Integration::T5Math::Ptr HeadlessObjectRegistry::get_math() {
+	HeadlessMath::Ptr math;
+	if (_math.expired()) {
+		math = std::make_shared<HeadlessMath>();
+		_math = math;
+	} else {
+		math = _math.lock();
+	}
+	return math;
+}
+
+} //namespace T5Headless
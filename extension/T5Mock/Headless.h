@@ -0,0 +1,131 @@
+#pragma once
+#include <ObjectRegistry.h>
+#include <T5Service.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Godot free implementations of the T5Integration services so the
+// integration core can be driven against the mock NDK
+namespace T5Headless {
+
+using T5Integration::FrameTimer;
+using T5Integration::Glasses;
+using T5Integration::GlassesEvent;
+
+class HeadlessMath : public T5Integration::T5Math {
+public:
+	using Ptr = std::shared_ptr<HeadlessMath>;
+	void rotate_vector(float quat_x, float quat_y, float quat_z, float quat_w, float& vec_x, float& vec_y, float& vec_z, bool inverse = false) override;
+};
+
+// Counts display texture allocations in place of the Godot glasses'
+// swap chain textures. Each frame sent is one render frame, with the
+// GPU keeping a set number of them in flight.
+class HeadlessGlasses : public Glasses {
+	// Stands in for one slot's textures, counting when they are freed
+	struct SwapChainTextures : public SwapChainResources {
+		SwapChainTextures(HeadlessGlasses& glasses);
+		~SwapChainTextures() override;
+
+		HeadlessGlasses& glasses;
+	};
+
+public:
+	HeadlessGlasses(std::string_view id) :
+			Glasses(id), _main_thread(std::this_thread::get_id()) {}
+
+	bool has_textures() const { return _has_textures; }
+	int get_texture_allocations() const { return _texture_allocations; }
+	// Slot textures not freed yet, including those the renderer may
+	// still be using after a display restart
+	int get_live_slot_textures() const { return _live_slot_textures; }
+	// Slot textures freed by a thread other than the main thread
+	int get_off_thread_frees() const { return _off_thread_frees; }
+
+	void set_frames_in_flight(int frames) { _frames_in_flight = frames; }
+
+protected:
+	void on_start_display() override;
+	void on_stop_display() override;
+	void on_send_frame(int swap_chain_idx) override { ++_render_frame; }
+
+	uint64_t get_render_frame() override { return _render_frame; }
+	int get_frames_in_flight() override { return _frames_in_flight; }
+
+private:
+	bool _has_textures = false;
+	int _texture_allocations = 0;
+	std::thread::id _main_thread;
+	std::atomic<int> _live_slot_textures = 0;
+	std::atomic<int> _off_thread_frees = 0;
+	uint64_t _render_frame = 0;
+	std::atomic<int> _frames_in_flight = 0;
+};
+
+class HeadlessService : public T5Integration::T5Service {
+public:
+	using Ptr = std::shared_ptr<HeadlessService>;
+
+	HeadlessService();
+	~HeadlessService();
+
+	Glasses::Ptr get_glasses(int glasses_idx) { return _glasses_list[glasses_idx]; }
+	HeadlessGlasses* get_headless_glasses(int glasses_idx) { return static_cast<HeadlessGlasses*>(_glasses_list[glasses_idx].get()); }
+
+	// One frame of what the XR interface does: schedule, update connection
+	// and tracking, reserve added glasses, start and stop the display as
+	// glasses connect and drop and send a frame from each connected pair,
+	// or resend the last one when the render rate skips the frame.
+	// Events are appended to out_events.
+	void run_frame(std::vector<GlassesEvent>& out_events);
+
+	// Sends frames from a render thread that overlaps the next frame's
+	// main thread work, as Godot's multi-threaded renderer does. The
+	// thread lives until threaded rendering is turned off, the NDK only
+	// takes frames from the thread that provided the graphics context.
+	void set_threaded_render(bool is_threaded);
+	// Returns once the frames of the last run_frame are sent
+	void wait_for_render();
+
+	bool is_glasses_connected(int glasses_idx);
+
+	// Added glasses are reserved unless the filter returns false
+	void set_reserve_filter(std::function<bool(int glasses_idx)> filter) { _reserve_filter = filter; }
+
+protected:
+	std::unique_ptr<Glasses> create_glasses(const std::string_view id) override;
+	bool should_glasses_be_reserved(int glasses_idx) override;
+
+private:
+	void render(const std::vector<Glasses::Ptr>& glasses_list);
+	void render_loop();
+	void stop_render_thread();
+
+	std::function<bool(int glasses_idx)> _reserve_filter;
+	bool _is_threaded_render = false;
+	std::thread _render_thread;
+	std::mutex _render_access;
+	std::condition_variable _render_changed;
+	std::vector<Glasses::Ptr> _render_list;
+	bool _is_render_queued = false;
+	bool _is_render_stopping = false;
+};
+
+class HeadlessObjectRegistry : public T5Integration::ObjectRegistry {
+public:
+	HeadlessObjectRegistry() = default;
+
+	static HeadlessService::Ptr service();
+
+	T5Integration::T5Service::Ptr get_service() override;
+	T5Integration::T5Math::Ptr get_math() override;
+
+protected:
+	HeadlessService::Ptr::weak_type _service;
+	HeadlessMath::Ptr::weak_type _math;
+};
+
+} //namespace T5Headless
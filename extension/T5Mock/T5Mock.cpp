@@ -0,0 +1,1247 @@
+#include <SessionCapture.h>
+#include <T5Mock.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+using T5Integration::CapturedConnection;
+using T5Integration::CapturedFrame;
+using T5Integration::CapturedGlasses;
+using T5Integration::CapturedParameter;
+using T5Integration::CapturedPose;
+using T5Integration::CapturedWandEvent;
+using T5Integration::SessionCapture;
+namespace SessionChunk = T5Integration::SessionChunk;
+
+using std::lock_guard;
+using std::mutex;
+using std::string;
+using std::vector;
+using namespace std::chrono;
+
+using Clock = steady_clock;
+
+struct T5_ContextImpl {
+	uint64_t generation;
+};
+
+struct T5_GlassesImpl {
+	uint64_t generation;
+	size_t idx;
+};
+
+namespace T5Mock {
+
+namespace {
+
+constexpr size_t g_call_count = static_cast<size_t>(Call::Count);
+
+// Captured data for one glasses, times in nanoseconds of replay time
+struct GlassesReplay {
+	struct TimedPose {
+		uint64_t at_ns;
+		CapturedPose pose;
+	};
+	struct TimedParameter {
+		uint64_t at_ns;
+		T5_ParamGlasses param;
+		double value;
+		string text;
+	};
+	struct TimedWandEvent {
+		uint64_t at_ns;
+		T5_WandStreamEvent event;
+	};
+
+	vector<TimedPose> poses;
+	vector<TimedParameter> parameters;
+	vector<TimedWandEvent> wand_events;
+	// Keyed by the timestamp of the pose the frame was rendered from
+	std::unordered_map<uint64_t, CapturedFrame> frames;
+
+	size_t next_pose = 0;
+	size_t next_parameter = 0;
+	size_t next_wand_event = 0;
+	uint64_t last_pose_timestamp = 0;
+
+	uint64_t frame_matches = 0;
+	uint64_t frame_mismatches = 0;
+	uint64_t frames_unmatched = 0;
+};
+
+struct MockGlasses {
+	GlassesConfig config;
+	T5_ConnectionState state = kT5_ConnectionState_NotExclusivelyConnected;
+	// Set by a scripted Disconnected step, cleared by any later step
+	bool is_held_disconnected = false;
+	bool is_unplugged = false;
+	int ensure_ready_calls = 0;
+	bool is_graphics_init = false;
+	// Frames can only be sent from the thread that provided the
+	// graphics context
+	std::thread::id graphics_thread;
+	size_t next_script_step = 0;
+
+	bool is_wand_stream_enabled = false;
+	int wands_to_announce = 0;
+	int next_report_wand = 0;
+	Clock::time_point next_report_time;
+	uint64_t report_sequence = 0;
+	uint64_t pose_sequence = 0;
+
+	vector<T5_ParamGlasses> changed_params;
+
+	std::shared_ptr<GlassesReplay> replay;
+
+	uint64_t frames_sent = 0;
+	uint64_t wand_events_read = 0;
+	uint64_t impulses_sent = 0;
+	T5_FrameInfo last_frame = {};
+};
+
+struct MockState {
+	mutex access;
+	Config config;
+	bool is_configured = false;
+	uint64_t generation = 1;
+	Clock::time_point start_time = Clock::now();
+	double replay_speed = 1.0;
+	vector<MockGlasses> glasses;
+	bool is_attention_required = false;
+	vector<T5_ParamSys> changed_system_params;
+	std::array<vector<T5_Result>, g_call_count> injected_errors;
+};
+
+MockState g_mock;
+
+std::array<std::atomic<int64_t>, g_call_count> g_latency_us;
+std::array<std::atomic<uint64_t>, g_call_count> g_call_counts;
+std::atomic<int> g_group_1_active = 0;
+std::atomic<uint64_t> g_exclusivity_violations = 0;
+
+// Counts the call, applies injected latency and checks
+// exclusivity group 1 for overlapping calls
+class CallScope {
+public:
+	CallScope(Call call, int group) :
+			_group(group) {
+		auto call_idx = static_cast<size_t>(call);
+		++g_call_counts[call_idx];
+
+		if (_group == 1 && g_group_1_active.fetch_add(1) != 0)
+			++g_exclusivity_violations;
+
+		auto latency = g_latency_us[call_idx].load();
+		if (latency > 0)
+			std::this_thread::sleep_for(microseconds(latency));
+
+		lock_guard lock(g_mock.access);
+		auto& errors = g_mock.injected_errors[call_idx];
+		if (!errors.empty()) {
+			_injected_error = errors.front();
+			errors.erase(errors.begin());
+		}
+	}
+
+	~CallScope() {
+		if (_group == 1)
+			--g_group_1_active;
+	}
+
+	T5_Result injected_error() const { return _injected_error; }
+
+private:
+	int _group;
+	T5_Result _injected_error = T5_SUCCESS;
+};
+
+#define MOCK_CALL(call, group)                \
+	CallScope scope(Call::call, group);       \
+	if (scope.injected_error() != T5_SUCCESS) \
+		return scope.injected_error();
+
+double seconds_since_start() {
+	return duration<double>(Clock::now() - g_mock.start_time).count();
+}
+
+uint64_t replay_time_ns() {
+	return static_cast<uint64_t>(duration<double, std::nano>(Clock::now() - g_mock.start_time).count() * g_mock.replay_speed);
+}
+
+// Sample index and timestamp for a stream running at rate_hz.
+// A rate of 0 advances the stream on every call.
+uint64_t next_sample_timestamp(double rate_hz, uint64_t& sequence) {
+	if (rate_hz <= 0.0) {
+		++sequence;
+		return duration_cast<nanoseconds>(Clock::now().time_since_epoch()).count();
+	}
+	auto sample = static_cast<uint64_t>(seconds_since_start() * rate_hz);
+	sequence = sample;
+	return static_cast<uint64_t>(static_cast<double>(sample) * 1e9 / rate_hz);
+}
+
+// The IPD the frame was rendered with
+float eye_separation(const CapturedFrame& frame) {
+	auto dx = frame.left_position.x - frame.right_position.x;
+	auto dy = frame.left_position.y - frame.right_position.y;
+	auto dz = frame.left_position.z - frame.right_position.z;
+	return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+T5_Quat yaw_quat(double angle) {
+	return T5_Quat{ static_cast<float>(std::cos(angle / 2)), 0, 0, static_cast<float>(std::sin(angle / 2)) };
+}
+
+void apply_script(MockGlasses& glasses) {
+	auto now = duration_cast<milliseconds>(Clock::now() - g_mock.start_time);
+	auto& script = glasses.config.connection_script;
+	while (glasses.next_script_step < script.size() && script[glasses.next_script_step].at <= now) {
+		auto state = script[glasses.next_script_step++].state;
+		glasses.state = state;
+		glasses.is_held_disconnected = state == kT5_ConnectionState_Disconnected;
+		if (state == kT5_ConnectionState_NotExclusivelyConnected) {
+			glasses.is_graphics_init = false;
+			glasses.is_wand_stream_enabled = false;
+		}
+	}
+}
+
+void apply_replay(MockGlasses& glasses) {
+	auto& replay = *glasses.replay;
+	auto now = replay_time_ns();
+
+	while (replay.next_pose < replay.poses.size() && replay.poses[replay.next_pose].at_ns <= now)
+		++replay.next_pose;
+
+	while (replay.next_parameter < replay.parameters.size() && replay.parameters[replay.next_parameter].at_ns <= now) {
+		auto& parameter = replay.parameters[replay.next_parameter++];
+		if (parameter.param == kT5_ParamGlasses_Float_IPD) {
+			if (parameter.value == glasses.config.ipd)
+				continue;
+			glasses.config.ipd = parameter.value;
+		} else {
+			if (parameter.text == glasses.config.friendly_name)
+				continue;
+			glasses.config.friendly_name = parameter.text;
+		}
+		glasses.changed_params.push_back(parameter.param);
+	}
+}
+
+MockGlasses* lookup(T5_Glasses handle) {
+	if (!handle || handle->generation != g_mock.generation || handle->idx >= g_mock.glasses.size())
+		return nullptr;
+	auto& glasses = g_mock.glasses[handle->idx];
+	apply_script(glasses);
+	if (glasses.replay)
+		apply_replay(glasses);
+	return &glasses;
+}
+
+T5_Result copy_string(const string& value, char* buffer, size_t* bufferSize) {
+	if (!bufferSize)
+		return T5_ERROR_INVALID_ARGS;
+	if (!buffer || *bufferSize < value.size() + 1) {
+		*bufferSize = value.size() + 1;
+		return T5_ERROR_OVERFLOW;
+	}
+	std::memcpy(buffer, value.c_str(), value.size() + 1);
+	*bufferSize = value.size() + 1;
+	return T5_SUCCESS;
+}
+
+template <typename T>
+T5_Result take_changed(vector<T>& changed, T* buffer, uint16_t* count) {
+	if (!count)
+		return T5_ERROR_INVALID_ARGS;
+	if (*count < changed.size()) {
+		*count = static_cast<uint16_t>(changed.size());
+		return T5_ERROR_OVERFLOW;
+	}
+	std::copy(changed.begin(), changed.end(), buffer);
+	*count = static_cast<uint16_t>(changed.size());
+	changed.clear();
+	return T5_SUCCESS;
+}
+
+void fill_wand_report(size_t glasses_idx, int wand_idx, double t, T5_WandReport& report) {
+	report.analogValid = true;
+	report.batteryValid = true;
+	report.buttonsValid = true;
+	report.poseValid = true;
+
+	report.trigger = static_cast<float>(0.5 + 0.5 * std::sin(t));
+	report.stick = T5_Vec2{ static_cast<float>(0.5 * std::cos(t)), static_cast<float>(0.5 * std::sin(t)) };
+	report.battery = 100;
+
+	bool is_pressed = static_cast<uint64_t>(t) % 2 == 1;
+	report.buttons = {};
+	report.buttons.a = is_pressed;
+	report.buttons.one = !is_pressed;
+
+	float x = 0.2f * static_cast<float>(glasses_idx) + (wand_idx == 0 ? 0.1f : -0.1f);
+	float z = 0.2f + 0.05f * static_cast<float>(std::sin(t));
+	report.rotToWND_GBD = yaw_quat(0.25 * t);
+	report.posAim_GBD = T5_Vec3{ x, 0.1f, z };
+	report.posFingertips_GBD = T5_Vec3{ x, 0.05f, z };
+	report.posGrip_GBD = T5_Vec3{ x, 0.0f, z - 0.05f };
+	report.hand = wand_idx == 0 ? kT5_Hand_Right : kT5_Hand_Left;
+}
+
+string read_env(const char* name, const char* default_value) {
+	auto value = std::getenv(name);
+	return value ? value : default_value;
+}
+
+} //namespace
+
+const char* call_name(Call call) {
+	static const char* names[] = {
+		"t5CreateContext",
+		"t5DestroyContext",
+		"t5ListGlasses",
+		"t5CreateGlasses",
+		"t5DestroyGlasses",
+		"t5GetSystemIntegerParam",
+		"t5GetSystemFloatParam",
+		"t5GetSystemUtf8Param",
+		"t5GetChangedSystemParams",
+		"t5GetGameboardSize",
+		"t5ReserveGlasses",
+		"t5SetGlassesDisplayName",
+		"t5EnsureGlassesReady",
+		"t5ReleaseGlasses",
+		"t5GetGlassesConnectionState",
+		"t5GetGlassesIdentifier",
+		"t5GetGlassesPose",
+		"t5InitGlassesGraphicsContext",
+		"t5ConfigureCameraStreamForGlasses",
+		"t5GetFilledCamImageBuffer",
+		"t5SubmitEmptyCamImageBuffer",
+		"t5CancelCamImageBuffer",
+		"t5SendFrameToGlasses",
+		"t5ValidateFrameInfo",
+		"t5GetGlassesIntegerParam",
+		"t5GetGlassesFloatParam",
+		"t5GetGlassesUtf8Param",
+		"t5GetChangedGlassesParams",
+		"t5GetProjection",
+		"t5ListWandsForGlasses",
+		"t5SendImpulse",
+		"t5ConfigureWandStreamForGlasses",
+		"t5ReadWandStreamForGlasses",
+	};
+	static_assert(std::size(names) == g_call_count);
+	auto idx = static_cast<size_t>(call);
+	return idx < g_call_count ? names[idx] : "unknown";
+}
+
+Config make_config(int glasses_count, int wands_per_glasses) {
+	Config config;
+	for (int i = 0; i < glasses_count; ++i) {
+		GlassesConfig glasses;
+		char id[16];
+		std::snprintf(id, sizeof(id), "MOCK%04d", i + 1);
+		glasses.id = id;
+		glasses.friendly_name = string("Mock Glasses ") + std::to_string(i + 1);
+		glasses.wand_count = wands_per_glasses;
+		config.glasses.push_back(std::move(glasses));
+	}
+	return config;
+}
+
+Config config_from_environment() {
+	auto config = make_config(
+			std::atoi(read_env("T5MOCK_GLASSES", "1").c_str()),
+			std::atoi(read_env("T5MOCK_WANDS", "1").c_str()));
+	config.pose_rate_hz = std::atof(read_env("T5MOCK_POSE_HZ", "200").c_str());
+	config.wand_rate_hz = std::atof(read_env("T5MOCK_WAND_HZ", "200").c_str());
+	return config;
+}
+
+void reset(const Config& config) {
+	lock_guard lock(g_mock.access);
+	g_mock.config = config;
+	g_mock.is_configured = true;
+	++g_mock.generation;
+	g_mock.start_time = Clock::now();
+	g_mock.replay_speed = 1.0;
+	g_mock.glasses.clear();
+	g_mock.is_attention_required = false;
+	g_mock.changed_system_params.clear();
+	for (auto& glasses_config : config.glasses) {
+		auto& glasses = g_mock.glasses.emplace_back();
+		glasses.config = glasses_config;
+	}
+	for (auto& errors : g_mock.injected_errors)
+		errors.clear();
+	for (auto& latency : g_latency_us)
+		latency = 0;
+	for (auto& count : g_call_counts)
+		count = 0;
+	g_exclusivity_violations = 0;
+}
+
+bool load_session(const string& path, double speed) {
+	auto capture = SessionCapture::open(path);
+	if (!capture || speed <= 0.0)
+		return false;
+
+	struct LoadingGlasses {
+		bool has_connected = false;
+		bool has_ipd = false;
+		bool has_friendly_name = false;
+	};
+
+	Config config;
+	vector<std::shared_ptr<GlassesReplay>> replays;
+	vector<LoadingGlasses> loading;
+	auto real_time = [speed](uint64_t time_ns) {
+		return milliseconds(static_cast<int64_t>(static_cast<double>(time_ns) / speed / 1e6));
+	};
+
+	SessionCapture::Reader reader(*capture);
+	SessionCapture::Chunk chunk;
+	while (reader.next(chunk)) {
+		if (chunk.tag == SessionChunk::GLASSES) {
+			CapturedGlasses captured;
+			if (!chunk.read(captured))
+				continue;
+			if (captured.glasses_idx >= config.glasses.size()) {
+				config.glasses.resize(captured.glasses_idx + 1);
+				loading.resize(captured.glasses_idx + 1);
+				while (replays.size() <= captured.glasses_idx)
+					replays.push_back(std::make_shared<GlassesReplay>());
+			}
+			// Glasses plugged back in are captured again
+			auto& glasses = config.glasses[captured.glasses_idx];
+			if (!glasses.id.empty())
+				continue;
+			glasses.id = chunk.trailing_string(sizeof(captured));
+			glasses.added_at = real_time(chunk.time_ns);
+			glasses.wand_count = 0;
+			// Only the captured connection state connects the glasses
+			glasses.ensure_ready_retries = INT_MAX;
+			continue;
+		}
+
+		// Every other chunk starts with the glasses index
+		uint32_t glasses_idx;
+		if (!chunk.read(glasses_idx) || glasses_idx >= replays.size())
+			continue;
+		auto& glasses = config.glasses[glasses_idx];
+		auto& replay = *replays[glasses_idx];
+
+		if (chunk.tag == SessionChunk::CONNECTION) {
+			CapturedConnection captured;
+			if (!chunk.read(captured))
+				continue;
+			auto state = static_cast<T5_ConnectionState>(captured.state);
+			// Reservation is replayed by t5ReserveGlasses and the state
+			// before the first connection is the initial one
+			if (state == kT5_ConnectionState_ExclusiveReservation ||
+					(state == kT5_ConnectionState_NotExclusivelyConnected && !loading[glasses_idx].has_connected))
+				continue;
+			loading[glasses_idx].has_connected |= state == kT5_ConnectionState_ExclusiveConnection;
+			glasses.connection_script.push_back({ real_time(chunk.time_ns), state });
+		} else if (chunk.tag == SessionChunk::POSE) {
+			auto& timed = replay.poses.emplace_back();
+			timed.at_ns = chunk.time_ns;
+			chunk.read(timed.pose);
+		} else if (chunk.tag == SessionChunk::PARAMETER) {
+			CapturedParameter captured;
+			if (!chunk.read(captured))
+				continue;
+			GlassesReplay::TimedParameter parameter{ chunk.time_ns, static_cast<T5_ParamGlasses>(captured.param), captured.value, string(chunk.trailing_string(sizeof(captured))) };
+			// The first values are the ones the glasses start with
+			if (parameter.param == kT5_ParamGlasses_Float_IPD && !loading[glasses_idx].has_ipd) {
+				glasses.ipd = parameter.value;
+				loading[glasses_idx].has_ipd = true;
+			} else if (parameter.param == kT5_ParamGlasses_UTF8_FriendlyName && !loading[glasses_idx].has_friendly_name) {
+				glasses.friendly_name = parameter.text;
+				loading[glasses_idx].has_friendly_name = true;
+			} else
+				replay.parameters.push_back(std::move(parameter));
+		} else if (chunk.tag == SessionChunk::FRAME) {
+			CapturedFrame captured;
+			if (chunk.read(captured))
+				replay.frames[captured.pose_timestamp_ns] = captured;
+		} else if (chunk.tag == SessionChunk::WAND) {
+			CapturedWandEvent captured;
+			if (!chunk.read(captured))
+				continue;
+			auto& timed = replay.wand_events.emplace_back();
+			timed.at_ns = chunk.time_ns;
+			T5Integration::decode_wand_event(captured.record, captured.timestamp_ns, timed.event);
+			glasses.wand_count = std::max<int>(glasses.wand_count, timed.event.wandId);
+		}
+	}
+
+	reset(config);
+
+	lock_guard lock(g_mock.access);
+	g_mock.replay_speed = speed;
+	for (size_t i = 0; i < replays.size(); ++i)
+		g_mock.glasses[i].replay = replays[i];
+	return true;
+}
+
+void set_latency(Call call, microseconds latency) {
+	g_latency_us[static_cast<size_t>(call)] = latency.count();
+}
+
+void inject_error(Call call, T5_Result result, int count) {
+	lock_guard lock(g_mock.access);
+	auto& errors = g_mock.injected_errors[static_cast<size_t>(call)];
+	errors.insert(errors.end(), count, result);
+}
+
+void set_ipd(int glasses_idx, double ipd) {
+	lock_guard lock(g_mock.access);
+	auto& glasses = g_mock.glasses.at(glasses_idx);
+	glasses.config.ipd = ipd;
+	glasses.changed_params.push_back(kT5_ParamGlasses_Float_IPD);
+}
+
+void set_friendly_name(int glasses_idx, const string& name) {
+	lock_guard lock(g_mock.access);
+	auto& glasses = g_mock.glasses.at(glasses_idx);
+	glasses.config.friendly_name = name;
+	glasses.changed_params.push_back(kT5_ParamGlasses_UTF8_FriendlyName);
+}
+
+void set_attention_required(bool is_required) {
+	lock_guard lock(g_mock.access);
+	g_mock.is_attention_required = is_required;
+	g_mock.changed_system_params.push_back(kT5_ParamSys_Integer_CPL_AttRequired);
+}
+
+void set_plugged_in(int glasses_idx, bool is_plugged_in) {
+	lock_guard lock(g_mock.access);
+	auto& glasses = g_mock.glasses.at(glasses_idx);
+	glasses.is_unplugged = !is_plugged_in;
+	if (glasses.is_unplugged) {
+		glasses.state = kT5_ConnectionState_NotExclusivelyConnected;
+		glasses.is_held_disconnected = false;
+		glasses.is_graphics_init = false;
+		glasses.is_wand_stream_enabled = false;
+		glasses.ensure_ready_calls = 0;
+	}
+}
+
+uint64_t get_call_count(Call call) {
+	return g_call_counts[static_cast<size_t>(call)];
+}
+
+uint64_t get_frames_sent(int glasses_idx) {
+	lock_guard lock(g_mock.access);
+	return g_mock.glasses.at(glasses_idx).frames_sent;
+}
+
+uint64_t get_wand_events_read(int glasses_idx) {
+	lock_guard lock(g_mock.access);
+	return g_mock.glasses.at(glasses_idx).wand_events_read;
+}
+
+uint64_t get_impulses_sent(int glasses_idx) {
+	lock_guard lock(g_mock.access);
+	return g_mock.glasses.at(glasses_idx).impulses_sent;
+}
+
+T5_FrameInfo get_last_frame(int glasses_idx) {
+	lock_guard lock(g_mock.access);
+	return g_mock.glasses.at(glasses_idx).last_frame;
+}
+
+uint64_t get_replay_frame_matches(int glasses_idx) {
+	lock_guard lock(g_mock.access);
+	auto& replay = g_mock.glasses.at(glasses_idx).replay;
+	return replay ? replay->frame_matches : 0;
+}
+
+uint64_t get_replay_frame_mismatches(int glasses_idx) {
+	lock_guard lock(g_mock.access);
+	auto& replay = g_mock.glasses.at(glasses_idx).replay;
+	return replay ? replay->frame_mismatches : 0;
+}
+
+uint64_t get_replay_frames_unmatched(int glasses_idx) {
+	lock_guard lock(g_mock.access);
+	auto& replay = g_mock.glasses.at(glasses_idx).replay;
+	return replay ? replay->frames_unmatched : 0;
+}
+
+uint64_t get_exclusivity_violations() {
+	return g_exclusivity_violations;
+}
+
+} //namespace T5Mock
+
+using namespace T5Mock;
+
+extern "C" {
+
+T5_Result t5CreateContext(T5_Context* context, const T5_ClientInfo* clientInfo, void* platformContext) {
+	bool is_configured;
+	{
+		lock_guard lock(g_mock.access);
+		is_configured = g_mock.is_configured;
+	}
+	if (!is_configured) {
+		auto session = std::getenv("T5MOCK_SESSION");
+		if (!session || !load_session(session, std::atof(read_env("T5MOCK_REPLAY_SPEED", "1").c_str())))
+			reset(config_from_environment());
+	}
+
+	MOCK_CALL(CreateContext, 1);
+	if (!context || !clientInfo || !clientInfo->applicationId)
+		return T5_ERROR_INVALID_ARGS;
+
+	lock_guard lock(g_mock.access);
+	*context = new T5_ContextImpl{ g_mock.generation };
+	return T5_SUCCESS;
+}
+
+void t5DestroyContext(T5_Context* context) {
+	CallScope scope(Call::DestroyContext, 1);
+	if (context && *context) {
+		delete *context;
+		*context = nullptr;
+	}
+}
+
+T5_Result t5ListGlasses(T5_Context context, char* buffer, size_t* bufferSize) {
+	MOCK_CALL(ListGlasses, 1);
+	if (!context)
+		return T5_ERROR_NO_CONTEXT;
+	if (!bufferSize)
+		return T5_ERROR_INVALID_ARGS;
+
+	lock_guard lock(g_mock.access);
+	auto now = Clock::now() - g_mock.start_time;
+	string list;
+	for (auto& glasses : g_mock.glasses) {
+		if (glasses.config.added_at > now || glasses.is_unplugged)
+			continue;
+		list.append(glasses.config.id);
+		list.push_back('\0');
+	}
+	list.push_back('\0');
+
+	if (!buffer || *bufferSize < list.size()) {
+		*bufferSize = list.size();
+		return T5_ERROR_OVERFLOW;
+	}
+	std::memcpy(buffer, list.data(), list.size());
+	*bufferSize = list.size();
+	return T5_SUCCESS;
+}
+
+T5_Result t5CreateGlasses(T5_Context context, const char* id, T5_Glasses* glasses) {
+	MOCK_CALL(CreateGlasses, 1);
+	if (!context)
+		return T5_ERROR_NO_CONTEXT;
+	if (!id || !glasses)
+		return T5_ERROR_INVALID_ARGS;
+
+	lock_guard lock(g_mock.access);
+	for (size_t idx = 0; idx < g_mock.glasses.size(); ++idx) {
+		if (g_mock.glasses[idx].config.id == id) {
+			if (g_mock.glasses[idx].is_unplugged)
+				return T5_ERROR_DEVICE_LOST;
+			*glasses = new T5_GlassesImpl{ g_mock.generation, idx };
+			return T5_SUCCESS;
+		}
+	}
+	return T5_ERROR_DEVICE_LOST;
+}
+
+void t5DestroyGlasses(T5_Glasses* glasses) {
+	CallScope scope(Call::DestroyGlasses, 1);
+	if (glasses && *glasses) {
+		delete *glasses;
+		*glasses = nullptr;
+	}
+}
+
+T5_Result t5GetSystemIntegerParam(T5_Context context, T5_ParamSys param, int64_t* value) {
+	MOCK_CALL(GetSystemIntegerParam, 1);
+	if (!context)
+		return T5_ERROR_NO_CONTEXT;
+	if (!value)
+		return T5_ERROR_INVALID_ARGS;
+	if (param != kT5_ParamSys_Integer_CPL_AttRequired)
+		return T5_ERROR_SETTING_WRONG_TYPE;
+
+	lock_guard lock(g_mock.access);
+	*value = g_mock.is_attention_required ? 1 : 0;
+	return T5_SUCCESS;
+}
+
+T5_Result t5GetSystemFloatParam(T5_Context context, T5_ParamSys param, double* value) {
+	MOCK_CALL(GetSystemFloatParam, 1);
+	if (!context)
+		return T5_ERROR_NO_CONTEXT;
+	return T5_ERROR_SETTING_WRONG_TYPE;
+}
+
+T5_Result t5GetSystemUtf8Param(T5_Context context, T5_ParamSys param, char* buffer, size_t* bufferSize) {
+	MOCK_CALL(GetSystemUtf8Param, 1);
+	if (!context)
+		return T5_ERROR_NO_CONTEXT;
+	if (param != kT5_ParamSys_UTF8_Service_Version)
+		return T5_ERROR_SETTING_WRONG_TYPE;
+
+	lock_guard lock(g_mock.access);
+	return copy_string(g_mock.config.service_version, buffer, bufferSize);
+}
+
+T5_Result t5GetChangedSystemParams(T5_Context context, T5_ParamSys* buffer, uint16_t* count) {
+	MOCK_CALL(GetChangedSystemParams, 1);
+	if (!context)
+		return T5_ERROR_NO_CONTEXT;
+
+	lock_guard lock(g_mock.access);
+	return take_changed(g_mock.changed_system_params, buffer, count);
+}
+
+T5_Result t5GetGameboardSize(T5_Context context, T5_GameboardType gameboardType, T5_GameboardSize* gameboardSize) {
+	MOCK_CALL(GetGameboardSize, 1);
+	if (!context)
+		return T5_ERROR_NO_CONTEXT;
+	if (!gameboardSize)
+		return T5_ERROR_INVALID_ARGS;
+
+	switch (gameboardType) {
+		case kT5_GameboardType_LE:
+			*gameboardSize = { 0.35f, 0.35f, 0.35f, 0.35f, 0.0f };
+			break;
+		case kT5_GameboardType_XE:
+			*gameboardSize = { 0.35f, 0.35f, 0.61f, 0.35f, 0.0f };
+			break;
+		case kT5_GameboardType_XE_Raised:
+			*gameboardSize = { 0.35f, 0.35f, 0.61f, 0.35f, 0.2f };
+			break;
+		default:
+			*gameboardSize = {};
+			break;
+	}
+	return T5_SUCCESS;
+}
+
+T5_Result t5ReserveGlasses(T5_Glasses glasses, const char* displayName) {
+	MOCK_CALL(ReserveGlasses, 1);
+	if (!displayName)
+		return T5_ERROR_INVALID_ARGS;
+
+	lock_guard lock(g_mock.access);
+	auto mock = lookup(glasses);
+	if (!mock)
+		return T5_ERROR_NO_CONTEXT;
+	if (mock->config.is_reserved_elsewhere)
+		return T5_ERROR_UNAVAILABLE;
+	if (mock->state != kT5_ConnectionState_NotExclusivelyConnected)
+		return T5_ERROR_ALREADY_CONNECTED;
+
+	mock->state = kT5_ConnectionState_ExclusiveReservation;
+	mock->ensure_ready_calls = 0;
+	return T5_SUCCESS;
+}
+
+T5_Result t5SetGlassesDisplayName(T5_Glasses glasses, const char* displayName) {
+	MOCK_CALL(SetGlassesDisplayName, 1);
+	if (!displayName)
+		return T5_ERROR_INVALID_ARGS;
+
+	lock_guard lock(g_mock.access);
+	return lookup(glasses) ? T5_SUCCESS : T5_ERROR_NO_CONTEXT;
+}
+
+T5_Result t5EnsureGlassesReady(T5_Glasses glasses) {
+	MOCK_CALL(EnsureGlassesReady, 1);
+
+	lock_guard lock(g_mock.access);
+	auto mock = lookup(glasses);
+	if (!mock)
+		return T5_ERROR_NO_CONTEXT;
+
+	switch (mock->state) {
+		case kT5_ConnectionState_ExclusiveConnection:
+			return T5_SUCCESS;
+		case kT5_ConnectionState_NotExclusivelyConnected:
+			return T5_ERROR_INVALID_STATE;
+		default:
+			break;
+	}
+	if (mock->is_held_disconnected || mock->ensure_ready_calls++ < mock->config.ensure_ready_retries)
+		return T5_ERROR_TRY_AGAIN;
+
+	mock->state = kT5_ConnectionState_ExclusiveConnection;
+	return T5_SUCCESS;
+}
+
+T5_Result t5ReleaseGlasses(T5_Glasses glasses) {
+	MOCK_CALL(ReleaseGlasses, 1);
+
+	lock_guard lock(g_mock.access);
+	auto mock = lookup(glasses);
+	if (!mock)
+		return T5_ERROR_NO_CONTEXT;
+
+	mock->state = kT5_ConnectionState_NotExclusivelyConnected;
+	mock->is_graphics_init = false;
+	mock->is_wand_stream_enabled = false;
+	return T5_SUCCESS;
+}
+
+T5_Result t5GetGlassesConnectionState(T5_Glasses glasses, T5_ConnectionState* connectionState) {
+	MOCK_CALL(GetGlassesConnectionState, 1);
+	if (!connectionState)
+		return T5_ERROR_INVALID_ARGS;
+
+	lock_guard lock(g_mock.access);
+	auto mock = lookup(glasses);
+	if (!mock)
+		return T5_ERROR_NO_CONTEXT;
+	*connectionState = mock->state;
+	return T5_SUCCESS;
+}
+
+T5_Result t5GetGlassesIdentifier(T5_Glasses glasses, char* buffer, size_t* bufferSize) {
+	MOCK_CALL(GetGlassesIdentifier, 1);
+
+	lock_guard lock(g_mock.access);
+	auto mock = lookup(glasses);
+	if (!mock)
+		return T5_ERROR_NO_CONTEXT;
+	return copy_string(mock->config.id, buffer, bufferSize);
+}
+
+T5_Result t5GetGlassesPose(T5_Glasses glasses, T5_GlassesPoseUsage usage, T5_GlassesPose* pose) {
+	MOCK_CALL(GetGlassesPose, 1);
+	if (!pose)
+		return T5_ERROR_INVALID_ARGS;
+
+	lock_guard lock(g_mock.access);
+	auto mock = lookup(glasses);
+	if (!mock)
+		return T5_ERROR_NO_CONTEXT;
+	if (mock->state != kT5_ConnectionState_ExclusiveConnection)
+		return T5_ERROR_NOT_CONNECTED;
+
+	if (mock->replay) {
+		auto& replay = *mock->replay;
+		if (replay.next_pose == 0)
+			return T5_ERROR_TRY_AGAIN;
+		auto& captured = replay.poses[replay.next_pose - 1].pose;
+		if (captured.result != T5_SUCCESS)
+			return captured.result;
+		pose->timestampNanos = captured.timestamp_ns;
+		pose->posGLS_GBD = captured.position;
+		pose->rotToGLS_GBD = captured.rotation;
+		pose->gameboardType = static_cast<T5_GameboardType>(captured.gameboard_type);
+		replay.last_pose_timestamp = captured.timestamp_ns;
+		return T5_SUCCESS;
+	}
+
+	pose->timestampNanos = next_sample_timestamp(g_mock.config.pose_rate_hz, mock->pose_sequence);
+	double t = static_cast<double>(pose->timestampNanos) * 1e-9;
+	float x = 0.2f * static_cast<float>(glasses->idx) + 0.05f * static_cast<float>(std::cos(0.5 * t));
+	pose->posGLS_GBD = T5_Vec3{ x, -0.5f + 0.05f * static_cast<float>(std::sin(0.5 * t)), 0.5f };
+	pose->rotToGLS_GBD = yaw_quat(0.1 * std::sin(t));
+	pose->gameboardType = mock->config.gameboard_type;
+	if (usage == kT5_GlassesPoseUsage_SpectatorPresentation)
+		pose->posGLS_GBD.z += 0.01f;
+	return T5_SUCCESS;
+}
+
+T5_Result t5InitGlassesGraphicsContext(T5_Glasses glasses, T5_GraphicsApi graphicsApi, void* graphicsContext) {
+	MOCK_CALL(InitGlassesGraphicsContext, 3);
+
+	lock_guard lock(g_mock.access);
+	auto mock = lookup(glasses);
+	if (!mock)
+		return T5_ERROR_NO_CONTEXT;
+	if (graphicsApi == kT5_GraphicsApi_None || (graphicsApi != kT5_GraphicsApi_GL && !graphicsContext))
+		return T5_ERROR_INVALID_ARGS;
+	if (mock->state != kT5_ConnectionState_ExclusiveConnection)
+		return T5_ERROR_NOT_CONNECTED;
+
+	mock->is_graphics_init = true;
+	mock->graphics_thread = std::this_thread::get_id();
+	return T5_SUCCESS;
+}
+
+T5_Result t5ConfigureCameraStreamForGlasses(T5_Glasses glasses, T5_CameraStreamConfig config) {
+	MOCK_CALL(ConfigureCameraStreamForGlasses, 1);
+
+	lock_guard lock(g_mock.access);
+	return lookup(glasses) ? T5_SUCCESS : T5_ERROR_NO_CONTEXT;
+}
+
+T5_Result t5GetFilledCamImageBuffer(T5_Glasses glasses, T5_CamImage* image) {
+	MOCK_CALL(GetFilledCamImageBuffer, 1);
+	return T5_ERROR_TRY_AGAIN;
+}
+
+T5_Result t5SubmitEmptyCamImageBuffer(T5_Glasses glasses, T5_CamImage* image) {
+	MOCK_CALL(SubmitEmptyCamImageBuffer, 1);
+	return T5_SUCCESS;
+}
+
+T5_Result t5CancelCamImageBuffer(T5_Glasses glasses, uint8_t* buffer) {
+	MOCK_CALL(CancelCamImageBuffer, 1);
+	return T5_SUCCESS;
+}
+
+T5_Result t5SendFrameToGlasses(T5_Glasses glasses, const T5_FrameInfo* info) {
+	MOCK_CALL(SendFrameToGlasses, 3);
+	if (!info)
+		return T5_ERROR_INVALID_ARGS;
+
+	lock_guard lock(g_mock.access);
+	auto mock = lookup(glasses);
+	if (!mock)
+		return T5_ERROR_NO_CONTEXT;
+	if (mock->state != kT5_ConnectionState_ExclusiveConnection)
+		return T5_ERROR_NOT_CONNECTED;
+	if (!mock->is_graphics_init || mock->graphics_thread != std::this_thread::get_id())
+		return T5_ERROR_INVALID_GFX_CONTEXT;
+
+	++mock->frames_sent;
+	mock->last_frame = *info;
+
+	if (mock->replay) {
+		auto& replay = *mock->replay;
+		auto found = replay.frames.find(replay.last_pose_timestamp);
+		CapturedFrame frame;
+		if (found != replay.frames.end()) {
+			frame = found->second;
+			T5Integration::capture_frame_info(*info, frame);
+		}
+		// Parameter changes are polled for, so the replay can pick one
+		// up a few frames before or after the capture did
+		if (found == replay.frames.end() || eye_separation(frame) != eye_separation(found->second)) {
+			++replay.frames_unmatched;
+		} else if (T5Integration::is_same_frame_output(frame, found->second)) {
+			++replay.frame_matches;
+		} else {
+			++replay.frame_mismatches;
+		}
+	}
+	return T5_SUCCESS;
+}
+
+T5_Result t5ValidateFrameInfo(T5_Glasses glasses, const T5_FrameInfo* info, char* detail, size_t* detailSize) {
+	MOCK_CALL(ValidateFrameInfo, 3);
+	if (!info || !detailSize)
+		return T5_ERROR_INVALID_ARGS;
+	if (info->texWidth_PIX == 0 || info->texHeight_PIX == 0)
+		return copy_string("Texture size is zero", detail, detailSize) == T5_SUCCESS ? T5_ERROR_INVALID_ARGS : T5_ERROR_OVERFLOW;
+	return copy_string("", detail, detailSize);
+}
+
+T5_Result t5GetGlassesIntegerParam(T5_Glasses glasses, T5_WandHandle wand, T5_ParamGlasses param, int64_t* value) {
+	MOCK_CALL(GetGlassesIntegerParam, 1);
+	return T5_ERROR_SETTING_WRONG_TYPE;
+}
+
+T5_Result t5GetGlassesFloatParam(T5_Glasses glasses, T5_WandHandle wand, T5_ParamGlasses param, double* value) {
+	MOCK_CALL(GetGlassesFloatParam, 1);
+	if (!value)
+		return T5_ERROR_INVALID_ARGS;
+	if (param != kT5_ParamGlasses_Float_IPD)
+		return T5_ERROR_SETTING_WRONG_TYPE;
+
+	lock_guard lock(g_mock.access);
+	auto mock = lookup(glasses);
+	if (!mock)
+		return T5_ERROR_NO_CONTEXT;
+	*value = mock->config.ipd;
+	return T5_SUCCESS;
+}
+
+T5_Result t5GetGlassesUtf8Param(T5_Glasses glasses, T5_WandHandle wand, T5_ParamGlasses param, char* buffer, size_t* bufferSize) {
+	MOCK_CALL(GetGlassesUtf8Param, 1);
+	if (param != kT5_ParamGlasses_UTF8_FriendlyName)
+		return T5_ERROR_SETTING_WRONG_TYPE;
+
+	lock_guard lock(g_mock.access);
+	auto mock = lookup(glasses);
+	if (!mock)
+		return T5_ERROR_NO_CONTEXT;
+	return copy_string(mock->config.friendly_name, buffer, bufferSize);
+}
+
+T5_Result t5GetChangedGlassesParams(T5_Glasses glasses, T5_ParamGlasses* buffer, uint16_t* count) {
+	MOCK_CALL(GetChangedGlassesParams, 1);
+
+	lock_guard lock(g_mock.access);
+	auto mock = lookup(glasses);
+	if (!mock)
+		return T5_ERROR_NO_CONTEXT;
+	return take_changed(mock->changed_params, buffer, count);
+}
+
+T5_Result t5GetProjection(T5_Glasses glasses,
+		T5_CartesianCoordinateHandedness handedness,
+		T5_DepthRange depthRange,
+		T5_MatrixOrder matrixOrder,
+		double nearPlane,
+		double farPlane,
+		double worldScale,
+		T5_ProjectionInfo* projectionInfo) {
+	MOCK_CALL(GetProjection, 1);
+	if (!projectionInfo || nearPlane <= 0 || farPlane <= nearPlane)
+		return T5_ERROR_INVALID_ARGS;
+
+	constexpr double fov = 48.0;
+	constexpr double aspect = 1216.0 / 768.0;
+	double f = 1.0 / std::tan(fov * 3.14159265358979323846 / 360.0);
+	double z_scale = depthRange == kT5_DepthRange_ZeroToOne ? farPlane / (nearPlane - farPlane) : (farPlane + nearPlane) / (nearPlane - farPlane);
+	double z_offset = depthRange == kT5_DepthRange_ZeroToOne ? farPlane * nearPlane / (nearPlane - farPlane) : 2 * farPlane * nearPlane / (nearPlane - farPlane);
+	double z_sign = handedness == kT5_CartesianCoordinateHandedness_Left ? -1.0 : 1.0;
+
+	auto& m = projectionInfo->matrix;
+	std::fill(std::begin(m), std::end(m), 0.0);
+	bool is_row_major = matrixOrder == kT5_MatrixOrder_RowMajor;
+	auto at = [&](int row, int col) -> double& { return is_row_major ? m[row * 4 + col] : m[col * 4 + row]; };
+	at(0, 0) = f / aspect;
+	at(1, 1) = f;
+	at(2, 2) = z_sign * z_scale;
+	at(2, 3) = z_offset * worldScale;
+	at(3, 2) = -z_sign;
+
+	projectionInfo->fieldOfView = fov;
+	projectionInfo->aspectRatio = aspect;
+	projectionInfo->framebufferWidth = 1216;
+	projectionInfo->framebufferHeight = 768;
+	return T5_SUCCESS;
+}
+
+T5_Result t5ListWandsForGlasses(T5_Glasses glasses, T5_WandHandle* buffer, uint8_t* count) {
+	MOCK_CALL(ListWandsForGlasses, 1);
+	if (!count)
+		return T5_ERROR_INVALID_ARGS;
+
+	lock_guard lock(g_mock.access);
+	auto mock = lookup(glasses);
+	if (!mock)
+		return T5_ERROR_NO_CONTEXT;
+
+	auto wand_count = static_cast<uint8_t>(mock->config.wand_count);
+	if (!buffer || *count < wand_count) {
+		*count = wand_count;
+		return T5_ERROR_OVERFLOW;
+	}
+	for (uint8_t i = 0; i < wand_count; ++i)
+		buffer[i] = i + 1;
+	*count = wand_count;
+	return T5_SUCCESS;
+}
+
+T5_Result t5SendImpulse(T5_Glasses glasses, T5_WandHandle wand, float amplitude, uint16_t duration) {
+	MOCK_CALL(SendImpulse, 1);
+	if (amplitude < 0.0f || amplitude > 1.0f || duration > 320)
+		return T5_ERROR_INVALID_ARGS;
+
+	lock_guard lock(g_mock.access);
+	auto mock = lookup(glasses);
+	if (!mock)
+		return T5_ERROR_NO_CONTEXT;
+	if (wand == 0 || wand > mock->config.wand_count)
+		return T5_ERROR_TARGET_NOT_FOUND;
+
+	++mock->impulses_sent;
+	return T5_SUCCESS;
+}
+
+T5_Result t5ConfigureWandStreamForGlasses(T5_Glasses glasses, const T5_WandStreamConfig* config) {
+	MOCK_CALL(ConfigureWandStreamForGlasses, 1);
+	if (!config)
+		return T5_ERROR_INVALID_ARGS;
+
+	lock_guard lock(g_mock.access);
+	auto mock = lookup(glasses);
+	if (!mock)
+		return T5_ERROR_NO_CONTEXT;
+
+	if (config->enabled && !mock->is_wand_stream_enabled) {
+		// A replay has the captured connect events
+		mock->wands_to_announce = mock->replay ? 0 : mock->config.wand_count;
+		mock->next_report_time = Clock::now();
+	}
+	mock->is_wand_stream_enabled = config->enabled;
+	return T5_SUCCESS;
+}
+
+T5_Result t5ReadWandStreamForGlasses(T5_Glasses glasses, T5_WandStreamEvent* event, uint32_t timeoutMs) {
+	MOCK_CALL(ReadWandStreamForGlasses, 2);
+	if (!event)
+		return T5_ERROR_INVALID_ARGS;
+
+	std::unique_lock lock(g_mock.access);
+	auto mock = lookup(glasses);
+	if (!mock)
+		return T5_ERROR_NO_CONTEXT;
+	if (mock->is_unplugged) {
+		// The stream goes quiet until the glasses handle is destroyed
+		lock.unlock();
+		std::this_thread::sleep_for(milliseconds(timeoutMs));
+		return T5_TIMEOUT;
+	}
+	if (!mock->is_wand_stream_enabled)
+		return T5_ERROR_UNAVAILABLE;
+
+	if (mock->replay) {
+		auto& events = mock->replay->wand_events;
+		auto next_event = mock->replay->next_wand_event;
+		auto due_ns = next_event < events.size() ? events[next_event].at_ns : UINT64_MAX;
+		auto now_ns = replay_time_ns();
+		if (due_ns > now_ns) {
+			auto timeout = milliseconds(timeoutMs);
+			auto wait = due_ns == UINT64_MAX ? timeout : duration_cast<Clock::duration>(duration<double, std::nano>((due_ns - now_ns) / g_mock.replay_speed));
+			lock.unlock();
+			std::this_thread::sleep_for(std::min<Clock::duration>(wait, timeout));
+			if (wait >= timeout)
+				return T5_TIMEOUT;
+			lock.lock();
+			mock = lookup(glasses);
+			if (!mock || !mock->is_wand_stream_enabled)
+				return T5_ERROR_UNAVAILABLE;
+		}
+		*event = mock->replay->wand_events[mock->replay->next_wand_event++].event;
+		++mock->wand_events_read;
+		return T5_SUCCESS;
+	}
+
+	if (mock->config.wand_count == 0) {
+		lock.unlock();
+		std::this_thread::sleep_for(milliseconds(timeoutMs));
+		return T5_TIMEOUT;
+	}
+
+	if (mock->wands_to_announce > 0) {
+		auto wand_idx = mock->config.wand_count - mock->wands_to_announce--;
+		*event = {};
+		event->wandId = static_cast<T5_WandHandle>(wand_idx + 1);
+		event->type = kT5_WandStreamEventType_Connect;
+		event->timestampNanos = duration_cast<nanoseconds>(Clock::now().time_since_epoch()).count();
+		++mock->wand_events_read;
+		return T5_SUCCESS;
+	}
+
+	double rate_hz = g_mock.config.wand_rate_hz;
+	if (rate_hz > 0.0) {
+		auto now = Clock::now();
+		auto report_time = mock->next_report_time;
+		// Don't try to catch up after a long stall
+		if (now - report_time > 100ms)
+			report_time = now;
+		if (report_time > now) {
+			auto timeout = milliseconds(timeoutMs);
+			auto wait = report_time - now;
+			lock.unlock();
+			std::this_thread::sleep_for(std::min<Clock::duration>(wait, timeout));
+			if (wait > timeout)
+				return T5_TIMEOUT;
+			lock.lock();
+			mock = lookup(glasses);
+			if (!mock || !mock->is_wand_stream_enabled)
+				return T5_ERROR_UNAVAILABLE;
+		}
+		auto period = duration_cast<Clock::duration>(duration<double>(1.0 / (rate_hz * mock->config.wand_count)));
+		mock->next_report_time = report_time + period;
+	}
+
+	auto wand_idx = mock->next_report_wand;
+	mock->next_report_wand = (wand_idx + 1) % mock->config.wand_count;
+
+	*event = {};
+	event->wandId = static_cast<T5_WandHandle>(wand_idx + 1);
+	event->type = kT5_WandStreamEventType_Report;
+	event->timestampNanos = duration_cast<nanoseconds>(Clock::now().time_since_epoch()).count();
+	event->report.timestampNanos = event->timestampNanos;
+	fill_wand_report(glasses->idx, wand_idx, seconds_since_start(), event->report);
+	++mock->report_sequence;
+	++mock->wand_events_read;
+	return T5_SUCCESS;
+}
+
+const char* t5GetResultMessage(T5_Result result) {
+	switch (result) {
+		case T5_SUCCESS:
+			return "Success";
+		case T5_TIMEOUT:
+			return "Timeout";
+		case T5_ERROR_NO_CONTEXT:
+			return "Invalid context";
+		case T5_ERROR_NO_LIBRARY:
+			return "Library not loaded";
+		case T5_ERROR_INTERNAL:
+			return "Internal error";
+		case T5_ERROR_NO_SERVICE:
+			return "Service not available";
+		case T5_ERROR_IO_FAILURE:
+			return "I/O failure";
+		case T5_ERROR_REQUEST_ID_UNKNOWN:
+			return "Request ID unknown";
+		case T5_ERROR_INVALID_ARGS:
+			return "Invalid arguments";
+		case T5_ERROR_DEVICE_LOST:
+			return "Device lost";
+		case T5_ERROR_TARGET_NOT_FOUND:
+			return "Target not found";
+		case T5_ERROR_INVALID_STATE:
+			return "Invalid state";
+		case T5_ERROR_SETTING_UNKNOWN:
+			return "Setting unknown";
+		case T5_ERROR_SETTING_WRONG_TYPE:
+			return "Setting wrong type";
+		case T5_ERROR_MISC_REMOTE:
+			return "Remote error";
+		case T5_ERROR_OVERFLOW:
+			return "Buffer overflow";
+		case T5_ERROR_GRAPHICS_API_UNAVAILABLE:
+			return "Graphics API unavailable";
+		case T5_ERROR_UNSUPPORTED:
+			return "Unsupported";
+		case T5_ERROR_DECODE_ERROR:
+			return "Decode error";
+		case T5_ERROR_INVALID_GFX_CONTEXT:
+			return "Invalid graphics context";
+		case T5_ERROR_GFX_CONTEXT_INIT_FAIL:
+			return "Graphics context init failed";
+		case T5_ERROR_TRY_AGAIN:
+			return "Try again";
+		case T5_ERROR_UNAVAILABLE:
+			return "Unavailable";
+		case T5_ERROR_ALREADY_CONNECTED:
+			return "Already connected";
+		case T5_ERROR_NOT_CONNECTED:
+			return "Not connected";
+		case T5_ERROR_STRING_OVERFLOW:
+			return "String overflow";
+		case T5_ERROR_SERVICE_INCOMPATIBLE:
+			return "Service incompatible";
+		case T5_PERMISSION_DENIED:
+			return "Permission denied";
+		case T5_ERROR_INVALID_BUFFER_SIZE:
+			return "Invalid buffer size";
+		case T5_ERROR_INVALID_GEOMETRY:
+			return "Invalid geometry";
+		default:
+			return "Unknown error";
+	}
+}
+
+} // extern "C"
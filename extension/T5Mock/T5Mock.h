@@ -0,0 +1,129 @@
+#pragma once
+#include <TiltFiveNative.h>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Stand-in for libTiltFiveNative. Implements the TiltFiveNative.h C API
+// against simulated glasses and wands so T5Integration can run without
+// the Tilt Five service. The functions in this namespace script and
+// inspect the simulation.
+namespace T5Mock {
+
+using namespace std::chrono_literals;
+
+enum class Call : uint8_t {
+	CreateContext,
+	DestroyContext,
+	ListGlasses,
+	CreateGlasses,
+	DestroyGlasses,
+	GetSystemIntegerParam,
+	GetSystemFloatParam,
+	GetSystemUtf8Param,
+	GetChangedSystemParams,
+	GetGameboardSize,
+	ReserveGlasses,
+	SetGlassesDisplayName,
+	EnsureGlassesReady,
+	ReleaseGlasses,
+	GetGlassesConnectionState,
+	GetGlassesIdentifier,
+	GetGlassesPose,
+	InitGlassesGraphicsContext,
+	ConfigureCameraStreamForGlasses,
+	GetFilledCamImageBuffer,
+	SubmitEmptyCamImageBuffer,
+	CancelCamImageBuffer,
+	SendFrameToGlasses,
+	ValidateFrameInfo,
+	GetGlassesIntegerParam,
+	GetGlassesFloatParam,
+	GetGlassesUtf8Param,
+	GetChangedGlassesParams,
+	GetProjection,
+	ListWandsForGlasses,
+	SendImpulse,
+	ConfigureWandStreamForGlasses,
+	ReadWandStreamForGlasses,
+	Count
+};
+
+const char* call_name(Call call);
+
+// Forces the glasses into a connection state at a time
+// measured from the last reset()
+struct ConnectionStep {
+	std::chrono::milliseconds at;
+	T5_ConnectionState state;
+};
+
+struct GlassesConfig {
+	std::string id;
+	std::string friendly_name;
+	double ipd = 59.0;
+	// Listed by t5ListGlasses from this time
+	std::chrono::milliseconds added_at = 0ms;
+	int wand_count = 1;
+	T5_GameboardType gameboard_type = kT5_GameboardType_LE;
+	// Number of t5EnsureGlassesReady calls answered with T5_ERROR_TRY_AGAIN
+	int ensure_ready_retries = 2;
+	// Another application holds the glasses
+	bool is_reserved_elsewhere = false;
+	std::vector<ConnectionStep> connection_script;
+};
+
+struct Config {
+	std::string service_version = "1.4.1";
+	std::vector<GlassesConfig> glasses;
+	// Rate new poses and wand reports become available,
+	// 0 produces a new sample on every call
+	double pose_rate_hz = 200.0;
+	double wand_rate_hz = 200.0;
+};
+
+// N glasses with ids "MOCK0001"... and M wands each
+Config make_config(int glasses_count, int wands_per_glasses);
+
+// Reads T5MOCK_GLASSES, T5MOCK_WANDS, T5MOCK_POSE_HZ and T5MOCK_WAND_HZ.
+// Used by t5CreateContext when reset() was never called, unless
+// T5MOCK_SESSION names a capture to replay at T5MOCK_REPLAY_SPEED.
+Config config_from_environment();
+
+void reset(const Config& config);
+
+// Replays a capture made with T5Service::start_capture in place of the
+// simulation. Glasses appear, connect and change parameters when they
+// did in the capture, and poses and wand events are the captured ones.
+// Frames sent are compared with the captured frame rendered from the
+// same pose. Time runs from this call at speed times real time.
+bool load_session(const std::string& path, double speed = 1.0);
+
+void set_latency(Call call, std::chrono::microseconds latency);
+void inject_error(Call call, T5_Result result, int count = 1);
+
+void set_ipd(int glasses_idx, double ipd);
+void set_friendly_name(int glasses_idx, const std::string& name);
+// Control panel needs the user, a firmware update say
+void set_attention_required(bool is_required);
+// Unplugged glasses drop out of t5ListGlasses and lose their reservation
+void set_plugged_in(int glasses_idx, bool is_plugged_in);
+
+uint64_t get_call_count(Call call);
+uint64_t get_frames_sent(int glasses_idx);
+uint64_t get_wand_events_read(int glasses_idx);
+uint64_t get_impulses_sent(int glasses_idx);
+T5_FrameInfo get_last_frame(int glasses_idx);
+
+// Frames sent during a replay that matched or differed from the
+// captured frame for the same pose. Unmatched frames had no captured
+// frame or were rendered with a different IPD.
+uint64_t get_replay_frame_matches(int glasses_idx);
+uint64_t get_replay_frame_mismatches(int glasses_idx);
+uint64_t get_replay_frames_unmatched(int glasses_idx);
+
+// Exclusivity group 1 calls that overlapped another group 1 call
+uint64_t get_exclusivity_violations();
+
+} //namespace T5Mock
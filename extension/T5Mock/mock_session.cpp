@@ -0,0 +1,998 @@
+#include <Headless.h>
+#include <T5Mock.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <thread>
+
+// Drives T5Integration through scripted sessions against the mock NDK.
+// Exits with a non zero status if any scenario fails.
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+using T5Headless::GlassesEvent;
+using T5Headless::HeadlessObjectRegistry;
+using T5Headless::HeadlessService;
+using T5Integration::CallSite;
+using T5Integration::FrameTimer;
+using T5Integration::g_t5_exclusivity_group_1;
+using T5Integration::Glasses;
+using T5Integration::RenderRate;
+using T5Integration::RenderScaleLimits;
+using T5Integration::RollingHistogram;
+using T5Integration::WandList;
+using T5Integration::WandRecording;
+using T5Integration::WandReplayMode;
+using T5Integration::WandService;
+
+using Clock = steady_clock;
+
+struct Options {
+	int glasses_count = 2;
+	int wands_per_glasses = 2;
+	int fps = 60;
+	std::string scenario;
+};
+
+class Session {
+public:
+	Session(const T5Mock::Config& config, int fps) :
+			_frame_period(fps > 0 ? duration_cast<Clock::duration>(duration<double>(1.0 / fps)) : Clock::duration::zero()) {
+		T5Mock::reset(config);
+		start();
+	}
+
+	// Replays a session capture in place of the simulation
+	Session(const std::string& capture_path, int fps) :
+			_frame_period(fps > 0 ? duration_cast<Clock::duration>(duration<double>(1.0 / fps)) : Clock::duration::zero()) {
+		_is_loaded = T5Mock::load_session(capture_path);
+		start();
+	}
+
+	~Session() {
+		_service->wait_for_render();
+		_service->stop_service();
+	}
+
+	bool run_until(std::function<bool()> predicate, milliseconds timeout) {
+		auto end_time = Clock::now() + timeout;
+		while (Clock::now() < end_time) {
+			run_frame();
+			if (predicate())
+				return true;
+		}
+		return false;
+	}
+
+	void run_for(milliseconds period) {
+		run_until([]() { return false; }, period);
+	}
+
+	bool saw_event(int glasses_idx, GlassesEvent::EType event, size_t from = 0) {
+		return std::any_of(_events.begin() + std::min(from, _events.size()), _events.end(), [=](auto& evt) {
+			return evt.glasses_num == glasses_idx && evt.event == event;
+		});
+	}
+
+	size_t event_count() { return _events.size(); }
+
+	HeadlessService::Ptr service() { return _service; }
+	bool is_loaded() { return _is_loaded; }
+
+	void report() {
+		if (_frame_count == 0)
+			return;
+		auto average = duration_cast<microseconds>(_frame_total / _frame_count).count();
+		auto longest = duration_cast<microseconds>(_frame_max).count();
+		std::printf("    %llu frames, average %lldus, max %lldus\n", (unsigned long long)_frame_count, (long long)average, (long long)longest);
+	}
+
+private:
+	void start() {
+		_service = HeadlessObjectRegistry::service();
+		_service->start_service("com.tiltfive.mock-session", "1.0");
+	}
+
+	void run_frame() {
+		auto start = Clock::now();
+		_service->run_frame(_events);
+		auto elapsed = Clock::now() - start;
+
+		++_frame_count;
+		_frame_total += elapsed;
+		_frame_max = std::max(_frame_max, elapsed);
+
+		if (_frame_period > Clock::duration::zero() && elapsed < _frame_period)
+			std::this_thread::sleep_for(_frame_period - elapsed);
+	}
+
+	HeadlessService::Ptr _service;
+	Clock::duration _frame_period;
+	bool _is_loaded = true;
+	std::vector<GlassesEvent> _events;
+
+	uint64_t _frame_count = 0;
+	Clock::duration _frame_total = Clock::duration::zero();
+	Clock::duration _frame_max = Clock::duration::zero();
+};
+
+bool all_connected(Session& session, int glasses_count) {
+	auto service = session.service();
+	for (int i = 0; i < glasses_count; ++i) {
+		if (!service->is_glasses_connected(i) || T5Mock::get_frames_sent(i) < 10)
+			return false;
+	}
+	return true;
+}
+
+bool scenario_connect(const Options& options) {
+	Session session(T5Mock::make_config(options.glasses_count, options.wands_per_glasses), options.fps);
+
+	if (!session.run_until([&]() { return all_connected(session, options.glasses_count); }, 10s)) {
+		std::printf("    glasses did not connect\n");
+		return false;
+	}
+	session.run_for(1s);
+
+	bool is_okay = true;
+	for (int i = 0; i < options.glasses_count; ++i) {
+		auto frames = T5Mock::get_frames_sent(i);
+		auto wand_events = T5Mock::get_wand_events_read(i);
+		auto frame = T5Mock::get_last_frame(i);
+		auto glasses = session.service()->get_glasses(i);
+
+		std::printf("    glasses %d: %llu frames sent, %llu wand events, %d wands\n",
+				i,
+				(unsigned long long)frames,
+				(unsigned long long)wand_events,
+				glasses->get_num_wands());
+
+		if (frame.texWidth_PIX == 0 || frame.texHeight_PIX == 0)
+			is_okay = false;
+		if (options.wands_per_glasses > 0 && (wand_events == 0 || glasses->get_num_wands() != options.wands_per_glasses))
+			is_okay = false;
+	}
+	session.report();
+	return is_okay;
+}
+
+bool scenario_reserved_elsewhere(const Options& options) {
+	auto config = T5Mock::make_config(1, options.wands_per_glasses);
+	config.glasses[0].is_reserved_elsewhere = true;
+	Session session(config, options.fps);
+
+	return session.run_until([&]() { return session.saw_event(0, GlassesEvent::E_UNAVAILABLE); }, 10s) &&
+			T5Mock::get_frames_sent(0) == 0;
+}
+
+bool scenario_scripted_reconnect(const Options& options) {
+	auto config = T5Mock::make_config(1, options.wands_per_glasses);
+	config.glasses[0].connection_script = {
+		{ 3000ms, kT5_ConnectionState_Disconnected },
+		{ 5500ms, kT5_ConnectionState_ExclusiveConnection },
+	};
+	Session session(config, options.fps);
+
+	if (!session.run_until([&]() { return session.saw_event(0, GlassesEvent::E_CONNECTED); }, 3s)) {
+		std::printf("    glasses did not connect before the scripted disconnect\n");
+		return false;
+	}
+	auto connect_events = session.event_count();
+	if (!session.run_until([&]() { return session.saw_event(0, GlassesEvent::E_DISCONNECTED, connect_events); }, 5s)) {
+		std::printf("    scripted disconnect was not reported\n");
+		return false;
+	}
+	auto disconnect_events = session.event_count();
+	auto frames_while_disconnected = T5Mock::get_frames_sent(0);
+	if (!session.run_until([&]() { return session.saw_event(0, GlassesEvent::E_CONNECTED, disconnect_events); }, 8s)) {
+		std::printf("    glasses did not reconnect\n");
+		return false;
+	}
+	session.run_for(200ms);
+	return T5Mock::get_frames_sent(0) > frames_while_disconnected;
+}
+
+bool scenario_tracking_dropout(const Options& options) {
+	Session session(T5Mock::make_config(1, options.wands_per_glasses), options.fps);
+
+	if (!session.run_until([&]() { return session.saw_event(0, GlassesEvent::E_TRACKING); }, 10s)) {
+		std::printf("    glasses never tracked\n");
+		return false;
+	}
+	auto tracking_events = session.event_count();
+	T5Mock::inject_error(T5Mock::Call::GetGlassesPose, T5_ERROR_TRY_AGAIN, 5);
+
+	if (!session.run_until([&]() { return session.saw_event(0, GlassesEvent::E_NOT_TRACKING, tracking_events); }, 2s)) {
+		std::printf("    tracking loss was not reported\n");
+		return false;
+	}
+	auto lost_events = session.event_count();
+	return session.run_until([&]() { return session.saw_event(0, GlassesEvent::E_TRACKING, lost_events); }, 2s);
+}
+
+bool scenario_hot_plug(const Options& options) {
+	Session session(T5Mock::make_config(2, options.wands_per_glasses), options.fps);
+
+	if (!session.run_until([&]() { return all_connected(session, 2); }, 10s)) {
+		std::printf("    glasses did not connect\n");
+		return false;
+	}
+	auto connected_events = session.event_count();
+	T5Mock::set_plugged_in(1, false);
+
+	if (!session.run_until([&]() { return session.saw_event(1, GlassesEvent::E_LOST, connected_events); }, 5s)) {
+		std::printf("    unplugged glasses were not reported lost\n");
+		return false;
+	}
+	auto lost_events = session.event_count();
+	auto frames_before = T5Mock::get_frames_sent(0);
+	session.run_for(500ms);
+	if (T5Mock::get_frames_sent(0) <= frames_before || session.saw_event(0, GlassesEvent::E_LOST)) {
+		std::printf("    glasses still plugged in were affected\n");
+		return false;
+	}
+
+	T5Mock::set_plugged_in(1, true);
+	if (!session.run_until([&]() { return session.saw_event(1, GlassesEvent::E_CONNECTED, lost_events); }, 10s)) {
+		std::printf("    glasses plugged back in did not reconnect\n");
+		return false;
+	}
+	auto service = session.service();
+	std::printf("    %d glasses listed, returning glasses at index %d\n",
+			service->get_glasses_count(),
+			service->find_glasses_idx("MOCK0002").value_or(-1));
+	return session.saw_event(1, GlassesEvent::E_ADDED, lost_events) &&
+			service->get_glasses_count() == 2 &&
+			service->find_glasses_idx("MOCK0002") == 1;
+}
+
+bool scenario_parameter_watch(const Options& options) {
+	Session session(T5Mock::make_config(2, options.wands_per_glasses), options.fps);
+	std::vector<T5Integration::ParameterChange> changes;
+	session.service()->add_parameter_listener([&](auto& change) { changes.push_back(change); });
+
+	if (!session.run_until([&]() { return all_connected(session, 2); }, 10s)) {
+		std::printf("    glasses did not connect\n");
+		return false;
+	}
+	// Nothing has changed so nothing should be read
+	session.run_for(1s);
+	auto ipd_reads = T5Mock::get_call_count(T5Mock::Call::GetGlassesFloatParam);
+	session.run_for(2s);
+	if (T5Mock::get_call_count(T5Mock::Call::GetGlassesFloatParam) != ipd_reads) {
+		std::printf("    unchanged parameters were read\n");
+		return false;
+	}
+
+	changes.clear();
+	auto glasses = session.service()->get_glasses(1);
+	T5Mock::set_ipd(1, 0.065);
+	T5Mock::set_friendly_name(1, "Renamed");
+	T5Mock::set_attention_required(true);
+	auto start = Clock::now();
+	if (!session.run_until([&]() { return std::abs(glasses->get_ipd() - 0.065f) < 1e-6f && glasses->get_name() == "Renamed"; }, 5s)) {
+		std::printf("    parameter changes were not picked up\n");
+		return false;
+	}
+	auto latency = duration_cast<milliseconds>(Clock::now() - start).count();
+	if (!session.run_until([&]() { return session.service()->is_attention_required(); }, 1s)) {
+		std::printf("    control panel attention was not picked up\n");
+		return false;
+	}
+
+	auto is_reported = [&](int glasses_idx, int param) {
+		return std::any_of(changes.begin(), changes.end(), [=](auto& change) {
+			return change.glasses_idx == glasses_idx && change.param == param;
+		});
+	};
+	std::printf("    changes applied after %lldms, %d reported, %llu glasses parameters read\n",
+			(long long)latency,
+			(int)changes.size(),
+			(unsigned long long)(T5Mock::get_call_count(T5Mock::Call::GetGlassesFloatParam) - ipd_reads));
+	return is_reported(1, kT5_ParamGlasses_Float_IPD) &&
+			is_reported(1, kT5_ParamGlasses_UTF8_FriendlyName) &&
+			is_reported(-1, kT5_ParamSys_Integer_CPL_AttRequired) &&
+			!is_reported(0, kT5_ParamGlasses_Float_IPD);
+}
+
+bool scenario_warm_standby(const Options& options) {
+	auto config = T5Mock::make_config(1, options.wands_per_glasses);
+	config.glasses[0].connection_script = {
+		{ 3000ms, kT5_ConnectionState_Disconnected },
+		{ 5500ms, kT5_ConnectionState_ExclusiveConnection },
+	};
+
+	// A reconnect inside the grace period reuses the textures, one
+	// after it allocates them again
+	for (auto grace_period : { 10000ms, 1000ms }) {
+		Session session(config, options.fps);
+		auto service = session.service();
+		service->set_standby_grace_period(grace_period);
+
+		if (!session.run_until([&]() { return session.saw_event(0, GlassesEvent::E_CONNECTED); }, 3s)) {
+			std::printf("    glasses did not connect before the scripted disconnect\n");
+			return false;
+		}
+		auto connect_events = session.event_count();
+		if (!session.run_until([&]() { return session.saw_event(0, GlassesEvent::E_DISCONNECTED, connect_events); }, 5s)) {
+			std::printf("    scripted disconnect was not reported\n");
+			return false;
+		}
+		auto disconnect_events = session.event_count();
+		session.run_for(1500ms);
+		auto glasses = service->get_headless_glasses(0);
+		bool was_kept = glasses->has_textures();
+
+		if (!session.run_until([&]() { return session.saw_event(0, GlassesEvent::E_CONNECTED, disconnect_events); }, 8s)) {
+			std::printf("    glasses did not reconnect\n");
+			return false;
+		}
+		auto allocations = glasses->get_texture_allocations();
+		std::printf("    %lldms grace period: textures %s while dropped, %d allocations\n",
+				(long long)grace_period.count(),
+				was_kept ? "kept" : "freed",
+				allocations);
+
+		bool is_reused = grace_period > 1500ms;
+		if (was_kept != is_reused || allocations != (is_reused ? 1 : 2) || !glasses->has_textures())
+			return false;
+	}
+	return true;
+}
+
+bool scenario_swap_chain_depth(const Options& options) {
+	Session session(T5Mock::make_config(1, options.wands_per_glasses), options.fps);
+	if (!session.run_until([&]() { return all_connected(session, 1); }, 10s)) {
+		std::printf("    glasses did not connect\n");
+		return false;
+	}
+
+	// The depth is never below the frames in flight, so no slot is
+	// rendered into while the copy from it could still be running
+	auto glasses = session.service()->get_headless_glasses(0);
+	bool is_okay = true;
+	for (int depth : { 1, 2, 3 }) {
+		glasses->stop_display();
+		glasses->set_swap_chain_depth(depth);
+		glasses->set_frames_in_flight(2);
+		glasses->start_display();
+		auto before = glasses->get_swap_chain_stats();
+		session.run_for(500ms);
+		auto after = glasses->get_swap_chain_stats();
+
+		std::printf("    depth %d: %d slots, %llu frames sent, %llu early reuses\n",
+				depth,
+				after.depth,
+				(unsigned long long)(after.frames_sent - before.frames_sent),
+				(unsigned long long)(after.early_reuses - before.early_reuses));
+		if (after.depth != std::max(depth, 2) || after.frames_sent == before.frames_sent || after.early_reuses != before.early_reuses)
+			is_okay = false;
+	}
+
+	// More frames in flight than slots is caught
+	glasses->set_frames_in_flight(4);
+	auto before = glasses->get_swap_chain_stats();
+	session.run_for(200ms);
+	if (glasses->get_swap_chain_stats().early_reuses == before.early_reuses) {
+		std::printf("    early reuse was not detected\n");
+		is_okay = false;
+	}
+	return is_okay;
+}
+
+// Feeds the render scale of one glasses with frame times that follow
+// the pixel count and are measured a few frames late, as the
+// renderer's are. Returns the scale after the frames and counts
+// the changes made during the last half.
+float simulate_render_scale(Glasses& glasses, double cpu_ms, double full_scale_gpu_ms, int frames, int& out_late_changes) {
+	constexpr size_t measure_delay = 3;
+	std::vector<float> rendered_scales(measure_delay, glasses.get_render_scale());
+	out_late_changes = 0;
+	for (int frame = 0; frame < frames; ++frame) {
+		rendered_scales.push_back(glasses.get_render_scale());
+		float measured_scale = rendered_scales[rendered_scales.size() - 1 - measure_delay];
+		auto cpu_time = microseconds(static_cast<int64_t>(cpu_ms * 1000.0));
+		auto gpu_time = microseconds(static_cast<int64_t>(full_scale_gpu_ms * measured_scale * measured_scale * 1000.0));
+		if (glasses.add_frame_time(cpu_time, gpu_time) && frame >= frames / 2)
+			++out_late_changes;
+	}
+	return glasses.get_render_scale();
+}
+
+bool scenario_render_scale(const Options& options) {
+	Session session(T5Mock::make_config(1, options.wands_per_glasses), options.fps);
+	if (!session.run_until([&]() { return session.service()->get_glasses_count() == 1; }, 10s))
+		return false;
+	auto glasses = session.service()->get_glasses(0);
+
+	// One of four glasses sharing 60fps
+	RenderScaleLimits limits;
+	limits.frame_budget = microseconds(4167);
+	glasses->set_render_scale_limits(limits);
+
+	struct Load {
+		const char* name;
+		double cpu_ms;
+		double gpu_ms;
+		float expected_scale;
+		// A display that starts again starts at full size
+		bool restart_display;
+	};
+	const Load loads[] = {
+		// 6ms at full size only fits at 0.75
+		{ "gpu bound", 1.0, 6.0, 0.75f, false },
+		{ "load eased", 1.0, 2.0, 1.0f, false },
+		{ "over budget", 1.0, 40.0, limits.min_scale, false },
+		// Fewer pixels won't help a frame the CPU holds up
+		{ "cpu bound", 6.0, 6.0, 1.0f, true },
+	};
+
+	bool is_okay = true;
+	for (auto& load : loads) {
+		if (load.restart_display) {
+			glasses->stop_display();
+			glasses->start_display();
+		}
+		int late_changes;
+		float scale = simulate_render_scale(*glasses, load.cpu_ms, load.gpu_ms, 600, late_changes);
+		std::printf("    %-11s scale %.3f, %d changes after settling\n", load.name, scale, late_changes);
+		if (scale != load.expected_scale || late_changes != 0)
+			is_okay = false;
+	}
+	return is_okay;
+}
+
+bool scenario_render_rate(const Options& options) {
+	Session session(T5Mock::make_config(1, options.wands_per_glasses), options.fps);
+	if (!session.run_until([&]() { return all_connected(session, 1); }, 10s)) {
+		std::printf("    glasses did not connect\n");
+		return false;
+	}
+
+	// Every engine frame submits a frame, rendered or resent
+	auto glasses = session.service()->get_glasses(0);
+	bool is_okay = true;
+	for (auto rate : { RenderRate::HALF, RenderRate::ON_CHANGE, RenderRate::FULL }) {
+		glasses->set_render_rate(rate);
+		auto before = glasses->get_swap_chain_stats();
+		auto submitted_before = T5Mock::get_frames_sent(0);
+		session.run_for(500ms);
+		auto after = glasses->get_swap_chain_stats();
+		auto rendered = after.frames_sent - before.frames_sent;
+		auto resent = after.frames_resent - before.frames_resent;
+		auto submitted = T5Mock::get_frames_sent(0) - submitted_before;
+
+		std::printf("    %-9s %llu rendered, %llu resent, %llu submitted\n",
+				rate == RenderRate::HALF ? "half" : rate == RenderRate::ON_CHANGE ? "on change" : "full",
+				(unsigned long long)rendered,
+				(unsigned long long)resent,
+				(unsigned long long)submitted);
+		if (rendered + resent != submitted)
+			is_okay = false;
+		if (rate == RenderRate::HALF && (rendered == 0 || std::max(rendered, resent) - std::min(rendered, resent) > 1))
+			is_okay = false;
+		// The first frame at the new rate may still render
+		if (rate == RenderRate::ON_CHANGE && (rendered > 1 || resent == 0))
+			is_okay = false;
+		if (rate == RenderRate::FULL && resent != 0)
+			is_okay = false;
+	}
+
+	// A resent frame keeps the pose it was rendered from while new
+	// poses arrive, a requested render sends the newer pose
+	glasses->set_render_rate(RenderRate::ON_CHANGE);
+	session.run_for(100ms);
+	auto rendered_frame = T5Mock::get_last_frame(0);
+	session.run_for(200ms);
+	auto resent_frame = T5Mock::get_last_frame(0);
+	if (std::memcmp(&rendered_frame.posLVC_GBD, &resent_frame.posLVC_GBD, sizeof(T5_Vec3)) != 0) {
+		std::printf("    resent frame pose changed\n");
+		is_okay = false;
+	}
+	auto rendered_before = glasses->get_swap_chain_stats().frames_sent;
+	glasses->request_render();
+	session.run_for(100ms);
+	if (glasses->get_swap_chain_stats().frames_sent != rendered_before + 1) {
+		std::printf("    requested render was not sent once\n");
+		is_okay = false;
+	}
+	return is_okay;
+}
+
+bool scenario_render_thread(const Options& options) {
+	Session session(T5Mock::make_config(2, options.wands_per_glasses), options.fps);
+	auto service = session.service();
+	service->set_threaded_render(true);
+	if (!session.run_until([&]() { return all_connected(session, 2); }, 10s)) {
+		std::printf("    glasses did not connect\n");
+		return false;
+	}
+
+	// Display restarts made on the main thread reach the render thread
+	// between its frames, while poses are handed over every frame
+	service->get_glasses(1)->set_render_rate(RenderRate::HALF);
+	auto restarted = service->get_headless_glasses(0);
+	bool is_okay = true;
+	for (int depth : { 2, 3, 3, 1 }) {
+		service->wait_for_render();
+		Glasses::SwapChainStats before[2];
+		uint64_t submitted_before[2];
+		for (int i = 0; i < 2; ++i) {
+			before[i] = service->get_glasses(i)->get_swap_chain_stats();
+			submitted_before[i] = T5Mock::get_frames_sent(i);
+		}
+
+		restarted->stop_display();
+		restarted->set_swap_chain_depth(depth);
+		restarted->start_display();
+		session.run_for(300ms);
+		service->wait_for_render();
+
+		std::printf("    depth %d:", depth);
+		for (int i = 0; i < 2; ++i) {
+			auto after = service->get_glasses(i)->get_swap_chain_stats();
+			auto rendered = after.frames_sent - before[i].frames_sent;
+			auto resent = after.frames_resent - before[i].frames_resent;
+			auto submitted = T5Mock::get_frames_sent(i) - submitted_before[i];
+			std::printf(" %llu+%llu/%llu", (unsigned long long)rendered, (unsigned long long)resent, (unsigned long long)submitted);
+			if (rendered == 0 || rendered + resent != submitted)
+				is_okay = false;
+		}
+		// Replaced textures are freed on the main thread once the
+		// render thread has moved to the new ones
+		auto live = restarted->get_live_slot_textures();
+		std::printf(" rendered+resent/submitted, %d texture allocations, %d slots live\n", restarted->get_texture_allocations(), live);
+		if (live != restarted->get_swap_chain_stats().depth)
+			is_okay = false;
+	}
+	if (restarted->get_off_thread_frees() != 0) {
+		std::printf("    %d slot textures were freed off the main thread\n", restarted->get_off_thread_frees());
+		is_okay = false;
+	}
+	session.report();
+	return is_okay;
+}
+
+void print_histogram(const char* name, const RollingHistogram::Summary& summary) {
+	std::printf("    %-16s %3d samples, p50 %6lldus, p95 %6lldus, p99 %6lldus, max %6lldus\n",
+			name,
+			summary.count,
+			(long long)summary.p50.count(),
+			(long long)summary.p95.count(),
+			(long long)summary.p99.count(),
+			(long long)summary.max.count());
+}
+
+bool scenario_frame_stats(const Options& options) {
+	Session session(T5Mock::make_config(1, options.wands_per_glasses), options.fps);
+	if (!session.run_until([&]() { return all_connected(session, 1); }, 10s)) {
+		std::printf("    glasses did not connect\n");
+		return false;
+	}
+
+	auto glasses = session.service()->get_glasses(0);
+	T5Mock::set_latency(T5Mock::Call::SendFrameToGlasses, 500us);
+	session.run_for(1s);
+	T5Mock::set_latency(T5Mock::Call::SendFrameToGlasses, 0us);
+
+	auto report = glasses->get_frame_stats();
+	print_histogram("submit interval", report.submit_interval);
+	print_histogram("pose age", report.pose_age);
+	print_histogram("submit duration", report.submit_duration);
+
+	bool is_okay = true;
+	if (options.fps > 0) {
+		// Submits follow the session's frame rate
+		auto period = duration_cast<microseconds>(duration<double>(1.0 / options.fps));
+		if (report.submit_interval.p50 < period * 8 / 10 || report.submit_interval.p50 > period * 12 / 10) {
+			std::printf("    submit interval doesn't follow the %d fps frame rate\n", options.fps);
+			is_okay = false;
+		}
+	}
+	if (report.submit_duration.p50 < 450us) {
+		std::printf("    submit duration misses the send latency\n");
+		is_okay = false;
+	}
+	if (report.pose_age.count == 0) {
+		std::printf("    no pose ages were recorded\n");
+		is_okay = false;
+	}
+
+	// Frames skipped while tracking is lost and failed submits are
+	// counted. The graphics context is initialized again after the
+	// failed submits and frames carry on.
+	T5Mock::inject_error(T5Mock::Call::GetGlassesPose, T5_ERROR_TRY_AGAIN, 5);
+	T5Mock::inject_error(T5Mock::Call::SendFrameToGlasses, T5_ERROR_INVALID_GFX_CONTEXT, 2);
+	auto submitted_before = report.frames_submitted;
+	session.run_until([&]() { return glasses->get_frame_stats().frames_submitted > submitted_before + 30; }, 2s);
+
+	report = glasses->get_frame_stats();
+	std::printf("    skipped %llu not connected, %llu not tracking\n",
+			(unsigned long long)report.skipped_not_connected,
+			(unsigned long long)report.skipped_not_tracking);
+	if (report.skipped_not_tracking == 0) {
+		std::printf("    frames skipped while not tracking weren't counted\n");
+		is_okay = false;
+	}
+	if (report.errors.size() != 1 || report.errors[T5_ERROR_INVALID_GFX_CONTEXT] != 2) {
+		std::printf("    submit error wasn't counted by its result code\n");
+		is_okay = false;
+	}
+	if (report.frames_submitted <= submitted_before + 30) {
+		std::printf("    frames stopped after the failed submits\n");
+		is_okay = false;
+	}
+	return is_okay;
+}
+
+bool scenario_metrics(const Options& options) {
+	Session session(T5Mock::make_config(2, options.wands_per_glasses), options.fps);
+	if (!session.run_until([&]() { return all_connected(session, 2); }, 10s)) {
+		std::printf("    glasses did not connect\n");
+		return false;
+	}
+
+	// Rates and percentiles cover the last whole window, the first
+	// read starts the window the second one reports
+	auto metrics = session.service()->get_metrics();
+	std::map<std::string, double> readings;
+	for (int read = 0; read < 2; ++read) {
+		session.run_for(1100ms);
+		for (int idx = 0; idx < metrics->get_monitor_count(); ++idx)
+			readings[metrics->get_monitor_name(idx)] = metrics->read_monitor(idx);
+	}
+	for (auto& [name, value] : readings)
+		std::printf("    %-32s %10.3f\n", name.c_str(), value);
+
+	bool is_okay = true;
+	auto expect = [&](const char* name, bool is_expected) {
+		if (readings.find(name) == readings.end() || !is_expected) {
+			std::printf("    unexpected %s\n", name);
+			is_okay = false;
+		}
+	};
+	expect("Glasses connected", readings["Glasses connected"] == 2);
+	expect("Glasses disconnected", readings["Glasses disconnected"] == 0);
+	expect("Frames submitted", readings["Frames submitted"] > 0);
+	if (options.fps > 0) {
+		double expected_rate = 2.0 * options.fps;
+		expect("Frames submitted per second", std::abs(readings["Frames submitted per second"] - expected_rate) < expected_rate * 0.2);
+	}
+	expect("Wand events per second", readings["Wand events per second"] > 0);
+	expect("Scheduler queue depth", readings["Scheduler queue depth"] >= 0);
+	expect("NDK lock wait (ms) p99", readings["NDK lock wait (ms) p99"] >= 0);
+	return is_okay;
+}
+
+bool scenario_frame_timer(const Options& options) {
+	Session session(T5Mock::make_config(2, options.wands_per_glasses), options.fps);
+	if (!session.run_until([&]() { return all_connected(session, 2); }, 10s)) {
+		std::printf("    glasses did not connect\n");
+		return false;
+	}
+
+	auto frame_timer = session.service()->get_frame_timer();
+	frame_timer->clear();
+	uint64_t frames = 0;
+	session.run_until([&]() { return ++frames == 100; }, 10s);
+
+	const std::pair<FrameTimer::Stage, const char*> stages[] = {
+		{ FrameTimer::PROCESS, "process" },
+		{ FrameTimer::PRE_DRAW, "pre draw" },
+		{ FrameTimer::END_FRAME, "end frame" },
+		{ FrameTimer::SCHEDULER, "scheduler" },
+	};
+	bool is_okay = true;
+	for (auto& [stage, name] : stages) {
+		auto report = frame_timer->get_report(stage);
+		std::printf("    %-10s %3llu frames, mean %7.2fus, p99 %5lldus\n",
+				name,
+				(unsigned long long)report.frames,
+				report.frames ? report.total.count() / 1000.0 / report.frames : 0.0,
+				(long long)report.summary.p99.count());
+		if (report.frames != frames || static_cast<uint64_t>(report.summary.count) != frames) {
+			std::printf("    %s was timed for the wrong frames\n", name);
+			is_okay = false;
+		}
+	}
+
+	// The scheduler runs inside the process stage
+	auto process = frame_timer->get_report(FrameTimer::PROCESS);
+	auto scheduler = frame_timer->get_report(FrameTimer::SCHEDULER);
+	if (process.total.count() == 0 || scheduler.total > process.total) {
+		std::printf("    scheduler time isn't part of process time\n");
+		is_okay = false;
+	}
+	if (frame_timer->get_report(FrameTimer::END_FRAME).total.count() == 0) {
+		std::printf("    sending frames wasn't timed\n");
+		is_okay = false;
+	}
+
+	frame_timer->clear();
+	if (frame_timer->get_report(FrameTimer::PROCESS).frames != 0) {
+		std::printf("    clear kept frames\n");
+		is_okay = false;
+	}
+	return is_okay;
+}
+
+bool scenario_spectator(const Options& options) {
+	Session session(T5Mock::make_config(2, options.wands_per_glasses), options.fps);
+	if (!session.run_until([&]() { return all_connected(session, 2); }, 10s)) {
+		std::printf("    glasses did not connect\n");
+		return false;
+	}
+
+	// The spectator pose is read under the same acquisition
+	// as the glasses poses, one acquisition per frame
+	auto spectated = session.service()->get_glasses(0);
+	spectated->set_spectator_enabled(true);
+	auto acquisitions_before = g_t5_exclusivity_group_1.get_stats(CallSite::GLASSES_POSE).acquisitions;
+	auto pose_reads_before = T5Mock::get_call_count(T5Mock::Call::GetGlassesPose);
+	session.run_for(500ms);
+	auto acquisitions = g_t5_exclusivity_group_1.get_stats(CallSite::GLASSES_POSE).acquisitions - acquisitions_before;
+	auto pose_reads = T5Mock::get_call_count(T5Mock::Call::GetGlassesPose) - pose_reads_before;
+	std::printf("    %llu pose reads in %llu acquisitions\n", (unsigned long long)pose_reads, (unsigned long long)acquisitions);
+
+	bool is_okay = true;
+	if (acquisitions == 0 || pose_reads != acquisitions * 3) {
+		std::printf("    spectator pose wasn't read with the glasses poses\n");
+		is_okay = false;
+	}
+	if (!spectated->is_spectator_tracking() || session.service()->get_glasses(1)->is_spectator_tracking()) {
+		std::printf("    spectator tracking is wrong\n");
+		is_okay = false;
+	}
+
+	// The mock offsets the spectator pose from the glasses pose
+	T5_Vec3 position, spectator_position;
+	T5_Quat orientation, spectator_orientation;
+	spectated->get_pose(position, orientation);
+	spectated->get_spectator_pose(spectator_position, spectator_orientation);
+	std::printf("    spectator offset %.4f\n", spectator_position.z - position.z);
+	if (std::abs(spectator_position.z - position.z - 0.01f) > 0.001f) {
+		std::printf("    spectator pose isn't the spectator one\n");
+		is_okay = false;
+	}
+
+	spectated->set_spectator_enabled(false);
+	pose_reads_before = T5Mock::get_call_count(T5Mock::Call::GetGlassesPose);
+	acquisitions_before = g_t5_exclusivity_group_1.get_stats(CallSite::GLASSES_POSE).acquisitions;
+	session.run_for(200ms);
+	acquisitions = g_t5_exclusivity_group_1.get_stats(CallSite::GLASSES_POSE).acquisitions - acquisitions_before;
+	pose_reads = T5Mock::get_call_count(T5Mock::Call::GetGlassesPose) - pose_reads_before;
+	if (pose_reads != acquisitions * 2 || spectated->is_spectator_tracking()) {
+		std::printf("    spectator pose was still read after it was disabled\n");
+		is_okay = false;
+	}
+	return is_okay;
+}
+
+bool scenario_haptics(const Options& options) {
+	Session session(T5Mock::make_config(1, std::max(options.wands_per_glasses, 1)), options.fps);
+	if (!session.run_until([&]() { return all_connected(session, 1) && session.service()->get_glasses(0)->get_num_wands() > 0; }, 10s)) {
+		std::printf("    glasses and wands did not connect\n");
+		return false;
+	}
+	auto glasses = session.service()->get_glasses(0);
+
+	// A pulse longer than one impulse is continued until it ends, and
+	// nothing is sent once the queue is empty
+	auto sends = [&]() { return g_t5_exclusivity_group_1.get_stats(CallSite::HAPTICS).acquisitions; };
+	bool is_okay = true;
+	for (int pulse = 0; pulse < 2; ++pulse) {
+		auto sends_before = sends();
+		glasses->trigger_haptic_pulse(0, 0.5f, 700);
+		session.run_for(800ms);
+		auto pulse_sends = sends() - sends_before;
+		session.run_for(300ms);
+		auto idle_sends = sends() - sends_before - pulse_sends;
+		std::printf("    pulse %d: %llu sends, %llu after it ended\n", pulse, (unsigned long long)pulse_sends, (unsigned long long)idle_sends);
+		if (pulse_sends < 3 || idle_sends != 0)
+			is_okay = false;
+	}
+	if (T5Mock::get_impulses_sent(0) == 0)
+		is_okay = false;
+	return is_okay;
+}
+
+bool scenario_wand_record_replay(const Options& options) {
+	auto path = (std::filesystem::temp_directory_path() / "t5mock_session.t5wr").string();
+	std::filesystem::remove(path);
+
+	uint64_t events_read;
+	{
+		Session session(T5Mock::make_config(1, 2), options.fps);
+		if (!session.run_until([&]() { return session.service()->get_glasses_count() == 1; }, 10s))
+			return false;
+		session.service()->get_glasses(0)->set_wand_recording_path(path);
+
+		if (!session.run_until([&]() { return T5Mock::get_wand_events_read(0) >= 500; }, 10s)) {
+			std::printf("    wand stream did not start\n");
+			return false;
+		}
+		session.service()->stop_service();
+		events_read = T5Mock::get_wand_events_read(0);
+	}
+
+	auto recording = WandRecording::open(path);
+	if (!recording) {
+		std::printf("    could not open %s\n", path.c_str());
+		return false;
+	}
+
+	// Decode once to find the expected final state of each wand
+	WandList expected;
+	size_t events_recorded = 0;
+	T5_WandStreamEvent event;
+	WandRecording::Reader reader(*recording);
+	while (reader.next(event)) {
+		++events_recorded;
+		auto wand = T5Integration::find_wand(expected, event.wandId);
+		(wand ? *wand : expected.emplace_back()).update_from_stream_event(event);
+	}
+	std::printf("    %zu events recorded of %llu read, %zu bytes\n",
+			events_recorded,
+			(unsigned long long)events_read,
+			std::filesystem::file_size(path));
+	if (events_recorded != events_read)
+		return false;
+
+	WandService replay;
+	replay.replay_from(recording, WandReplayMode::AS_FAST_AS_POSSIBLE);
+	auto start = Clock::now();
+	replay.start(nullptr);
+	while (!replay.is_replay_finished())
+		std::this_thread::sleep_for(1ms);
+	auto elapsed = duration<double>(Clock::now() - start).count();
+
+	WandList replayed;
+	replay.get_wand_data(replayed);
+	replay.stop();
+	std::printf("    replayed at %.0f events/s\n", events_recorded / elapsed);
+
+	if (replayed.size() != expected.size())
+		return false;
+	for (size_t i = 0; i < expected.size(); ++i) {
+		auto& a = expected[i]._pose.posAim_GBD;
+		auto& b = replayed[i]._pose.posAim_GBD;
+		if (replayed[i]._handle != expected[i]._handle || replayed[i]._state != expected[i]._state || a.x != b.x || a.y != b.y || a.z != b.z)
+			return false;
+	}
+	std::filesystem::remove(path);
+	return true;
+}
+
+bool scenario_session_capture_replay(const Options& options) {
+	auto path = (std::filesystem::temp_directory_path() / "t5mock_session.t5sc").string();
+	const auto capture_time = 2s;
+
+	{
+		auto config = T5Mock::make_config(options.glasses_count, options.wands_per_glasses);
+		Session session(config, options.fps);
+		if (!session.service()->start_capture(path))
+			return false;
+
+		if (!session.run_until([&]() { return all_connected(session, options.glasses_count); }, 10s)) {
+			std::printf("    glasses did not connect\n");
+			return false;
+		}
+		T5Mock::set_ipd(0, 63.0);
+		session.run_for(capture_time);
+		session.service()->stop_capture();
+		session.service()->stop_service();
+	}
+	std::printf("    captured %zu bytes\n", std::filesystem::file_size(path));
+
+	Session session(path, options.fps);
+	if (!session.is_loaded()) {
+		std::printf("    could not load %s\n", path.c_str());
+		return false;
+	}
+	if (!session.run_until([&]() { return all_connected(session, options.glasses_count); }, 10s)) {
+		std::printf("    replayed glasses did not connect\n");
+		return false;
+	}
+	session.run_for(capture_time);
+
+	bool is_okay = true;
+	for (int i = 0; i < options.glasses_count; ++i) {
+		auto matches = T5Mock::get_replay_frame_matches(i);
+		auto mismatches = T5Mock::get_replay_frame_mismatches(i);
+		auto unmatched = T5Mock::get_replay_frames_unmatched(i);
+		auto wand_events = T5Mock::get_wand_events_read(i);
+		std::printf("    glasses %d: %llu frames matched, %llu differed, %llu unmatched, %llu wand events\n",
+				i,
+				(unsigned long long)matches,
+				(unsigned long long)mismatches,
+				(unsigned long long)unmatched,
+				(unsigned long long)wand_events);
+
+		if (matches == 0 || mismatches != 0)
+			is_okay = false;
+		if (options.wands_per_glasses > 0 && wand_events == 0)
+			is_okay = false;
+	}
+	if (session.service()->get_glasses(0)->get_ipd() != 63.0f) {
+		std::printf("    captured IPD change was not replayed\n");
+		is_okay = false;
+	}
+	session.report();
+	std::filesystem::remove(path);
+	return is_okay;
+}
+
+struct Scenario {
+	const char* name;
+	bool (*run)(const Options&);
+};
+
+const Scenario g_scenarios[] = {
+	{ "connect", scenario_connect },
+	{ "reserved_elsewhere", scenario_reserved_elsewhere },
+	{ "scripted_reconnect", scenario_scripted_reconnect },
+	{ "tracking_dropout", scenario_tracking_dropout },
+	{ "hot_plug", scenario_hot_plug },
+	{ "parameter_watch", scenario_parameter_watch },
+	{ "warm_standby", scenario_warm_standby },
+	{ "swap_chain_depth", scenario_swap_chain_depth },
+	{ "render_scale", scenario_render_scale },
+	{ "render_rate", scenario_render_rate },
+	{ "render_thread", scenario_render_thread },
+	{ "frame_stats", scenario_frame_stats },
+	{ "metrics", scenario_metrics },
+	{ "frame_timer", scenario_frame_timer },
+	{ "spectator", scenario_spectator },
+	{ "haptics", scenario_haptics },
+	{ "wand_record_replay", scenario_wand_record_replay },
+	{ "session_capture_replay", scenario_session_capture_replay },
+};
+
+void print_call_counts() {
+	for (int i = 0; i < static_cast<int>(T5Mock::Call::Count); ++i) {
+		auto call = static_cast<T5Mock::Call>(i);
+		if (auto count = T5Mock::get_call_count(call))
+			std::printf("    %-34s %llu\n", T5Mock::call_name(call), (unsigned long long)count);
+	}
+	std::printf("    exclusivity group 1 overlaps: %llu\n", (unsigned long long)T5Mock::get_exclusivity_violations());
+}
+
+int main(int argc, char** argv) {
+	Options options;
+	for (int i = 1; i < argc; ++i) {
+		auto has_value = i + 1 < argc;
+		if (!std::strcmp(argv[i], "--glasses") && has_value)
+			options.glasses_count = std::max(1, std::atoi(argv[++i]));
+		else if (!std::strcmp(argv[i], "--wands") && has_value)
+			options.wands_per_glasses = std::clamp(std::atoi(argv[++i]), 0, 2);
+		else if (!std::strcmp(argv[i], "--fps") && has_value)
+			options.fps = std::max(0, std::atoi(argv[++i]));
+		else if (!std::strcmp(argv[i], "--scenario") && has_value)
+			options.scenario = argv[++i];
+		else {
+			std::printf("usage: %s [--glasses N] [--wands 0-2] [--fps N (0 = unpaced)] [--scenario NAME]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	HeadlessObjectRegistry registry;
+
+	int failures = 0;
+	for (auto& scenario : g_scenarios) {
+		if (!options.scenario.empty() && options.scenario != scenario.name)
+			continue;
+		std::printf("[ RUN  ] %s\n", scenario.name);
+		bool passed = scenario.run(options);
+		print_call_counts();
+		std::printf("[ %s ] %s\n", passed ? " OK " : "FAIL", scenario.name);
+		if (!passed)
+			++failures;
+	}
+	return failures == 0 ? 0 : 1;
+}
@@ -5,6 +5,7 @@
 #include <godot_cpp/classes/xr_server.hpp>
 #include <godot_cpp/core/error_macros.hpp>
 #include <godot_cpp/variant/variant.hpp>
+#include <memory>
 
 using godot::Projection;
 using godot::Quaternion;
@@ -18,21 +19,48 @@ namespace WandState = T5Integration::WandState;
 
 namespace GodotT5Integration {
 
+namespace {
+
+// Created when the module initializes and freed when it uninitializes,
+// while the engine's StringName table exists
+struct TrackerNames {
+	StringName default_pose = "default";
+	StringName trigger = "trigger";
+	StringName trigger_click = "trigger_click";
+	StringName stick = "stick";
+	StringName button_a = "button_a";
+	StringName button_b = "button_b";
+	StringName button_x = "button_x";
+	StringName button_y = "button_y";
+	StringName button_1 = "button_1";
+	StringName button_2 = "button_2";
+	StringName button_3 = "button_3";
+	StringName button_t5 = "button_t5";
+};
+
+std::unique_ptr<TrackerNames> g_tracker_names;
+
+} // namespace
+
+void initialize_tracker_names() {
+	g_tracker_names = std::make_unique<TrackerNames>();
+}
+
+void uninitialize_tracker_names() {
+	g_tracker_names.reset();
+}
+
 GodotT5Glasses::GodotT5Glasses(std::string_view id) :
 		Glasses(id) {
-	set_swap_chain_size(g_swap_chain_length);
+	set_swap_chain_depth(g_swap_chain_length);
 }
 
-Transform3D GodotT5Glasses::get_head_transform(Vector3 eye_offset) {
-	Quaternion orientation;
-	Vector3 position;
-
-	get_glasses_orientation(orientation.x, orientation.y, orientation.z, orientation.w);
-	get_glasses_position(position.x, position.y, position.z);
+namespace {
 
+Transform3D to_head_transform(const T5_Vec3 &t5_position, const T5_Quat &t5_orientation, Vector3 eye_offset) {
 	// Tiltfive -> Godot axis
-	position = Vector3(position.x, position.z, -position.y);
-	orientation = Quaternion(orientation.x, orientation.z, -orientation.y, orientation.w);
+	Vector3 position(t5_position.x, t5_position.z, -t5_position.y);
+	Quaternion orientation(t5_orientation.x, t5_orientation.z, -t5_orientation.y, t5_orientation.w);
 	orientation = orientation.inverse();
 
 	Transform3D headPose;
@@ -48,6 +76,29 @@ Transform3D GodotT5Glasses::get_head_transform(Vector3 eye_offset) {
 	return headPose * axisAdjust * eye_pose;
 }
 
+} // namespace
+
+Transform3D GodotT5Glasses::get_head_transform(Vector3 eye_offset) {
+	T5_Vec3 position;
+	T5_Quat orientation;
+	get_pose(position, orientation);
+	return to_head_transform(position, orientation, eye_offset);
+}
+
+Transform3D GodotT5Glasses::get_frame_transform(Vector3 eye_offset) {
+	T5_Vec3 position;
+	T5_Quat orientation;
+	get_frame_pose(position, orientation);
+	return to_head_transform(position, orientation, eye_offset);
+}
+
+Transform3D GodotT5Glasses::get_spectator_transform() {
+	T5_Vec3 position;
+	T5_Quat orientation;
+	get_spectator_pose(position, orientation);
+	return to_head_transform(position, orientation, Vector3());
+}
+
 Vector3 GodotT5Glasses::get_eye_offset(Glasses::Eye eye) {
 	float dir = (eye == Glasses::Left ? -1.0f : 1.0f);
 	auto ipd = get_ipd();
@@ -55,7 +106,7 @@ Vector3 GodotT5Glasses::get_eye_offset(Glasses::Eye eye) {
 }
 
 Transform3D GodotT5Glasses::get_eye_transform(Glasses::Eye eye) {
-	return get_head_transform(get_eye_offset(eye));
+	return get_frame_transform(get_eye_offset(eye));
 }
 
 Transform3D GodotT5Glasses::get_wand_transform(int wand_num) {
@@ -76,6 +127,22 @@ Transform3D GodotT5Glasses::get_wand_transform(int wand_num) {
 	return wandPose;
 }
 
+Vector3 GodotT5Glasses::get_wand_linear_velocity(int wand_num) {
+	Vector3 velocity;
+	Glasses::get_wand_linear_velocity(wand_num, velocity.x, velocity.y, velocity.z);
+
+	// Tiltfive -> Godot axis
+	return Vector3(velocity.x, velocity.z, -velocity.y);
+}
+
+Vector3 GodotT5Glasses::get_wand_angular_velocity(int wand_num) {
+	Vector3 velocity;
+	Glasses::get_wand_angular_velocity(wand_num, velocity.x, velocity.y, velocity.z);
+
+	// Tiltfive -> Godot axis
+	return Vector3(velocity.x, velocity.z, -velocity.y);
+}
+
 PackedFloat64Array GodotT5Glasses::get_projection_for_eye(Glasses::Eye view, double aspect, double z_near, double z_far) {
 	PackedFloat64Array arr;
 	arr.resize(16); // 4x4 matrix
@@ -104,6 +171,7 @@ void GodotT5Glasses::on_glasses_reserved() {
 	_head->set_tracker_name(buffer);
 	_head->set_tracker_desc("Players head");
 	xr_server->add_tracker(_head);
+	index_trackers();
 }
 
 void GodotT5Glasses::on_glasses_released() {
@@ -113,6 +181,8 @@ void GodotT5Glasses::on_glasses_released() {
 
 		xr_server->remove_tracker(_head);
 	}
+	remove_spectator();
+	unindex_trackers();
 }
 
 void GodotT5Glasses::on_glasses_dropped() {
@@ -122,21 +192,24 @@ void GodotT5Glasses::on_glasses_dropped() {
 
 		xr_server->remove_tracker(_head);
 	}
+	remove_spectator();
+	unindex_trackers();
 }
 
 void GodotT5Glasses::on_tracking_updated() {
 	if (_head.is_valid()) {
 		if (is_tracking()) {
 			_head->set_pose(
-					"default",
+					g_tracker_names->default_pose,
 					get_head_transform(),
 					Vector3(),
 					Vector3(),
 					godot::XRPose::XR_TRACKING_CONFIDENCE_HIGH);
 		} else {
-			_head->invalidate_pose("default");
+			_head->invalidate_pose(g_tracker_names->default_pose);
 		}
 	}
+	update_spectator();
 
 	auto num_wands = get_num_wands();
 	for (int wand_idx = 0; wand_idx < num_wands; ++wand_idx) {
@@ -159,6 +232,49 @@ Vector2 GodotT5Glasses::get_render_size() {
 	return Vector2(width, height);
 }
 
+void GodotT5Glasses::update_spectator() {
+	if (!is_spectator_enabled()) {
+		remove_spectator();
+		return;
+	}
+
+	if (_spectator.is_null()) {
+		XRServer *xr_server = XRServer::get_singleton();
+		ERR_FAIL_NULL(xr_server);
+
+		char buffer[64];
+		ERR_FAIL_COND(snprintf(buffer, 64, "/user/%s/spectator", get_id().c_str()) > 64);
+
+		_spectator.instantiate();
+		_spectator->set_tracker_type(XRServer::TRACKER_HEAD);
+		_spectator->set_tracker_name(buffer);
+		_spectator->set_tracker_desc("Players head, smoothed for spectators");
+		xr_server->add_tracker(_spectator);
+	}
+
+	if (is_spectator_tracking()) {
+		_spectator->set_pose(
+				g_tracker_names->default_pose,
+				get_spectator_transform(),
+				Vector3(),
+				Vector3(),
+				godot::XRPose::XR_TRACKING_CONFIDENCE_HIGH);
+	} else {
+		_spectator->invalidate_pose(g_tracker_names->default_pose);
+	}
+}
+
+void GodotT5Glasses::remove_spectator() {
+	if (_spectator.is_null())
+		return;
+
+	XRServer *xr_server = XRServer::get_singleton();
+	ERR_FAIL_NULL(xr_server);
+
+	xr_server->remove_tracker(_spectator);
+	_spectator.unref();
+}
+
 void GodotT5Glasses::add_tracker() {
 	int new_idx = _wand_trackers.size();
 	int new_id = new_idx + 1;
@@ -174,16 +290,37 @@ void GodotT5Glasses::add_tracker() {
 	positional_tracker->set_tracker_desc("Tracks wand");
 
 	_wand_trackers.push_back(positional_tracker);
+	_wand_tracker_index.insert(positional_tracker->get_tracker_name(), new_idx);
+	_wand_input_cache.push_back(WandInputCache());
+	if (_tracker_index)
+		_tracker_index->insert(positional_tracker->get_tracker_name(), TrackerAssociation{ _glasses_idx, new_idx });
+}
+
+void GodotT5Glasses::index_trackers() {
+	if (!_tracker_index)
+		return;
+	// Trackers outlive a release, they are indexed again
+	for (int wand_idx = 0; wand_idx < _wand_trackers.size(); ++wand_idx)
+		_tracker_index->insert(_wand_trackers[wand_idx]->get_tracker_name(), TrackerAssociation{ _glasses_idx, wand_idx });
+}
+
+void GodotT5Glasses::unindex_trackers() {
+	if (!_tracker_index)
+		return;
+	for (auto& tracker : _wand_trackers)
+		_tracker_index->erase(tracker->get_tracker_name());
 }
 
 void GodotT5Glasses::update_wand(int wand_idx) {
 	auto xr_server = XRServer::get_singleton();
 
 	auto tracker = _wand_trackers[wand_idx];
+	auto& cache = _wand_input_cache[wand_idx];
 
 	if (is_wand_state_changed(wand_idx, WandState::CONNECTED)) {
 		if (is_wand_state_set(wand_idx, WandState::CONNECTED)) {
 			xr_server->add_tracker(tracker);
+			cache = WandInputCache();
 		} else {
 			xr_server->remove_tracker(tracker);
 			return;
@@ -191,49 +328,78 @@ void GodotT5Glasses::update_wand(int wand_idx) {
 	}
 	if (is_wand_state_set(wand_idx, WandState::POSE_VALID)) {
 		auto wand_transform = get_wand_transform(wand_idx);
-		tracker->set_pose("default", wand_transform, Vector3(), Vector3(), godot::XRPose::XR_TRACKING_CONFIDENCE_HIGH);
+		tracker->set_pose(
+				g_tracker_names->default_pose,
+				wand_transform,
+				get_wand_linear_velocity(wand_idx),
+				get_wand_angular_velocity(wand_idx),
+				godot::XRPose::XR_TRACKING_CONFIDENCE_HIGH);
 	} else {
-		tracker->invalidate_pose("default");
+		tracker->invalidate_pose(g_tracker_names->default_pose);
 	}
 	if (is_wand_state_set(wand_idx, WandState::ANALOG_VALID)) {
+		bool publish_all = !cache.is_analog_published;
+
 		float trigger_value;
 		get_wand_trigger(wand_idx, trigger_value);
-		tracker->set_input("trigger", Variant(trigger_value));
 		Vector2 stick;
 		get_wand_stick(wand_idx, stick.x, stick.y);
-		tracker->set_input("stick", Variant(stick));
 
+		bool trigger_click = publish_all ? trigger_value > _trigger_click_threshold : cache.trigger_click;
 		if (trigger_value > _trigger_click_threshold + g_trigger_hysteresis_range) {
-			tracker->set_input("trigger_click", Variant(true));
+			trigger_click = true;
 		} else if (trigger_value < (_trigger_click_threshold - g_trigger_hysteresis_range)) {
-			tracker->set_input("trigger_click", Variant(false));
+			trigger_click = false;
 		}
+
+		if (publish_all || trigger_value != cache.trigger)
+			tracker->set_input(g_tracker_names->trigger, Variant(trigger_value));
+		if (publish_all || stick != cache.stick)
+			tracker->set_input(g_tracker_names->stick, Variant(stick));
+		if (publish_all || trigger_click != cache.trigger_click)
+			tracker->set_input(g_tracker_names->trigger_click, Variant(trigger_click));
+
+		cache.trigger = trigger_value;
+		cache.stick = stick;
+		cache.trigger_click = trigger_click;
+		cache.is_analog_published = true;
 	}
 	if (is_wand_state_set(wand_idx, WandState::BUTTONS_VALID)) {
 		WandButtons buttons;
 		get_wand_buttons(wand_idx, buttons);
 
-		tracker->set_input("button_a", Variant(buttons.a));
-		tracker->set_input("button_b", Variant(buttons.b));
-		tracker->set_input("button_x", Variant(buttons.x));
-		tracker->set_input("button_y", Variant(buttons.y));
-		tracker->set_input("button_1", Variant(buttons.one));
-		tracker->set_input("button_2", Variant(buttons.two));
-		tracker->set_input("button_3", Variant(buttons.three));
-		tracker->set_input("button_t5", Variant(buttons.t5));
+		bool publish_all = !cache.is_buttons_published;
+		auto& previous = cache.buttons;
+		if (publish_all || buttons.a != previous.a)
+			tracker->set_input(g_tracker_names->button_a, Variant(buttons.a));
+		if (publish_all || buttons.b != previous.b)
+			tracker->set_input(g_tracker_names->button_b, Variant(buttons.b));
+		if (publish_all || buttons.x != previous.x)
+			tracker->set_input(g_tracker_names->button_x, Variant(buttons.x));
+		if (publish_all || buttons.y != previous.y)
+			tracker->set_input(g_tracker_names->button_y, Variant(buttons.y));
+		if (publish_all || buttons.one != previous.one)
+			tracker->set_input(g_tracker_names->button_1, Variant(buttons.one));
+		if (publish_all || buttons.two != previous.two)
+			tracker->set_input(g_tracker_names->button_2, Variant(buttons.two));
+		if (publish_all || buttons.three != previous.three)
+			tracker->set_input(g_tracker_names->button_3, Variant(buttons.three));
+		if (publish_all || buttons.t5 != previous.t5)
+			tracker->set_input(g_tracker_names->button_t5, Variant(buttons.t5));
+
+		previous = buttons;
+		cache.is_buttons_published = true;
 	}
 }
 
 bool GodotT5Glasses::get_tracker_association(StringName tracker_name, int &out_wand_idx) {
-	for (out_wand_idx = 0; out_wand_idx < _wand_trackers.size(); ++out_wand_idx) {
-		auto b1 = tracker_name.to_utf8_buffer();
-		auto b2 = _wand_trackers[out_wand_idx]->get_tracker_name().to_utf8_buffer();
-
-		if (tracker_name == _wand_trackers[out_wand_idx]->get_tracker_name())
-			return true;
+	auto found = _wand_tracker_index.find(tracker_name);
+	if (found == _wand_tracker_index.end()) {
+		out_wand_idx = -1;
+		return false;
 	}
-	out_wand_idx = -1;
-	return false;
+	out_wand_idx = found->value;
+	return true;
 }
 
 } //namespace GodotT5Integration
\ No newline at end of file
@@ -1,12 +1,15 @@
 #pragma once
 #include <Glasses.h>
 #include <godot_cpp/classes/global_constants.hpp>
+#include <godot_cpp/classes/image.hpp>
 #include <godot_cpp/classes/packed_data_container.hpp>
 #include <godot_cpp/classes/ref.hpp>
 #include <godot_cpp/classes/xr_positional_tracker.hpp>
+#include <godot_cpp/templates/hash_map.hpp>
 #include <godot_cpp/variant/rid.hpp>
 #include <godot_cpp/variant/transform3d.hpp>
 
+using godot::Image;
 using godot::PackedFloat64Array;
 using godot::Ref;
 using godot::RID;
@@ -20,14 +23,39 @@ using T5Integration::Glasses;
 
 namespace GodotT5Integration {
 
+// Default swap chain depth
 constexpr int g_swap_chain_length = 3;
 constexpr float g_trigger_hysteresis_range = 0.002; // Sort of arbitrary assume 8 bit DAC +/-(1/256)/2
 
 class GodotT5Service;
 
+// Wand trackers of every reserved glasses by tracker name. Kept by the
+// glasses as they add trackers and are reserved, released or dropped.
+struct TrackerAssociation {
+	int glasses_idx;
+	int wand_idx;
+};
+using TrackerIndex = godot::HashMap<StringName, TrackerAssociation>;
+
+// Interns the tracker pose and input names, called when the module
+// initializes and uninitializes
+void initialize_tracker_names();
+void uninitialize_tracker_names();
+
 class GodotT5Glasses : public Glasses {
 	friend GodotT5Service;
 
+	// Last values given to the wand tracker so
+	// set_input is only called on change
+	struct WandInputCache {
+		bool is_analog_published = false;
+		bool is_buttons_published = false;
+		float trigger;
+		Vector2 stick;
+		bool trigger_click;
+		T5Integration::WandButtons buttons;
+	};
+
 public:
 	using Ptr = std::shared_ptr<GodotT5Glasses>;
 
@@ -38,15 +66,34 @@ public:
 	bool is_reserved();
 
 	Vector2 get_render_size();
+	// Latest tracked pose, for the head tracker
 	virtual Transform3D get_head_transform(Vector3 eye_offset = Vector3());
+	// Pose of the frame being rendered
+	virtual Transform3D get_frame_transform(Vector3 eye_offset = Vector3());
+	// Spectator pose, for the spectator tracker
+	virtual Transform3D get_spectator_transform();
 	virtual Vector3 get_eye_offset(Glasses::Eye eye);
 	virtual Transform3D get_eye_transform(Glasses::Eye eye);
 	virtual PackedFloat64Array get_projection_for_eye(Glasses::Eye view, double aspect, double z_near, double z_far);
 
 	virtual Transform3D get_wand_transform(int wand_num);
+	virtual Vector3 get_wand_linear_velocity(int wand_num);
+	virtual Vector3 get_wand_angular_velocity(int wand_num);
 
 	virtual RID get_color_texture() = 0;
 
+	// The mirror holds a copy of the left eye of the last frame
+	// rendered, for showing on a monitor without rendering again
+	void set_mirror_enabled(bool is_enabled) { _is_mirror_enabled = is_enabled; }
+	bool is_mirror_enabled() { return _is_mirror_enabled; }
+	// Called by the renderer after the frame is drawn. Reads the
+	// frame back, or drops the mirror once it's disabled. False if the
+	// renderer can't read it.
+	virtual bool update_mirror() { return false; }
+	// The latest frame read back, null if there's none since the last
+	// call. Called from the main thread.
+	virtual Ref<Image> get_mirror_image() { return Ref<Image>(); }
+
 	StringName get_wand_tracker_name(int wand_idx);
 
 	bool get_tracker_association(StringName tracker_name, int& out_wand_idx);
@@ -62,10 +109,21 @@ protected:
 
 private:
 	void add_tracker();
+	void index_trackers();
+	void unindex_trackers();
 	void update_wand(int wand_idx);
+	void update_spectator();
+	void remove_spectator();
 
 	Ref<XRPositionalTracker> _head;
+	Ref<XRPositionalTracker> _spectator;
+	std::atomic<bool> _is_mirror_enabled = false;
 	std::vector<Ref<XRPositionalTracker>> _wand_trackers;
+	godot::HashMap<StringName, int> _wand_tracker_index;
+	std::vector<WandInputCache> _wand_input_cache;
+	// Shared with the service, set when the glasses are created
+	std::shared_ptr<TrackerIndex> _tracker_index;
+	int _glasses_idx = -1;
 
 	float _trigger_click_threshold;
 };
@@ -36,12 +36,22 @@ GodotT5Service::GodotT5Service() :
 		T5Service() {}
 
 std::unique_ptr<Glasses> GodotT5Service::create_glasses(const std::string_view id) {
+	std::unique_ptr<GodotT5Glasses> glasses;
 	if (get_graphics_api() == kT5_GraphicsApi_GL)
-		return std::unique_ptr<Glasses>(new OpenGLGlasses(id));
+		glasses.reset(new OpenGLGlasses(id, _texture_pool));
 	else if (get_graphics_api() == kT5_GraphicsApi_Vulkan)
-		return std::unique_ptr<Glasses>(new VulkanGlasses(id));
+		glasses.reset(new VulkanGlasses(id));
+	ERR_FAIL_NULL_V_MSG(glasses, std::unique_ptr<Glasses>(), "Unknown graphics API");
 
-	ERR_FAIL_V_MSG(std::unique_ptr<Glasses>(), "Unknown graphics API");
+	// New glasses are added at the end of the list
+	glasses->_tracker_index = _tracker_index;
+	glasses->_glasses_idx = _glasses_list.size();
+	return glasses;
+}
+
+void GodotT5Service::release_standby() {
+	T5Service::release_standby();
+	_texture_pool->clear();
 }
 
 void GodotT5Service::use_opengl_api() {
@@ -69,15 +79,15 @@ void GodotT5Service::use_vulkan_api() {
 }
 
 bool GodotT5Service::get_tracker_association(StringName tracker_name, int& out_glasses_idx, int& out_wand_idx) {
-	for (out_glasses_idx = 0; out_glasses_idx < _glasses_list.size(); ++out_glasses_idx) {
-		auto godot_glasses = std::static_pointer_cast<GodotT5Glasses>(_glasses_list[out_glasses_idx]);
-		if (godot_glasses->get_tracker_association(tracker_name, out_wand_idx)) {
-			return true;
-		}
+	auto found = _tracker_index->find(tracker_name);
+	if (found == _tracker_index->end()) {
+		out_glasses_idx = -1;
+		out_wand_idx = -1;
+		return false;
 	}
-	out_glasses_idx = -1;
-	out_wand_idx = -1;
-	return false;
+	out_glasses_idx = found->value.glasses_idx;
+	out_wand_idx = found->value.wand_idx;
+	return true;
 }
 
 void GodotT5Math::rotate_vector(float quat_x, float quat_y, float quat_z, float quat_w, float& vec_x, float& vec_y, float& vec_z, bool inverse) {
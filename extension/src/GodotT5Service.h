@@ -2,9 +2,11 @@
 #include <Glasses.h>
 #include <GodotT5Glasses.h>
 #include <ObjectRegistry.h>
+#include <TexturePool.h>
 #include <godot_cpp/classes/global_constants.hpp>
 #include <godot_cpp/classes/ref.hpp>
 #include <godot_cpp/classes/xr_positional_tracker.hpp>
+#include <godot_cpp/templates/hash_map.hpp>
 #include <godot_cpp/variant/transform3d.hpp>
 
 namespace GodotT5Integration {
@@ -39,6 +41,17 @@ public:
 	void use_vulkan_api();
 
 	bool get_tracker_association(StringName tracker_name, int& out_glasses_idx, int& out_wand_idx);
+
+	// Also frees the pooled OpenGL textures
+	void release_standby() override;
+
+private:
+	// OpenGL swap chain textures shared by all glasses. Glasses hold a
+	// reference as they're destroyed after the service's members.
+	TexturePool::Ptr _texture_pool = std::make_shared<TexturePool>();
+
+	// Shared with the glasses, which keep it as their trackers change
+	std::shared_ptr<TrackerIndex> _tracker_index = std::make_shared<TrackerIndex>();
 };
 
 class GodotT5Math : public T5Integration::T5Math {
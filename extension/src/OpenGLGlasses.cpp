@@ -5,40 +5,26 @@
 #include <godot_cpp/classes/xr_server.hpp>
 #include <godot_cpp/core/error_macros.hpp>
 
-using godot::Image;
 using godot::RenderingServer;
-using godot::TypedArray;
 
 namespace GodotT5Integration {
 
-OpenGLGlasses::OpenGLGlasses(std::string_view id) :
-		GodotT5Glasses(id) {
-	_swap_chain_textures.resize(g_swap_chain_length);
+OpenGLGlasses::OpenGLGlasses(std::string_view id, TexturePool::Ptr texture_pool) :
+		GodotT5Glasses(id), _texture_pool(texture_pool) {
 }
 
-void OpenGLGlasses::SwapChainTextures::allocate_textures(int width, int height) {
-	auto render_server = RenderingServer::get_singleton();
-
-	if (is_allocated)
-		deallocate_textures();
-
-	Ref<Image> dummy_image = Image::create(width, height, false, godot::Image::FORMAT_RGBA8);
-	godot::Color bg(0, 0, 0);
-	dummy_image->fill(bg);
-
-	TypedArray<Image> image_arr;
-	image_arr.append(dummy_image);
-	image_arr.append(dummy_image);
-
-	render_tex.instantiate();
-	render_tex->create_from_images(image_arr);
+OpenGLGlasses::~OpenGLGlasses() {
+	deallocate_textures();
+}
 
-	is_allocated = true;
+OpenGLGlasses::SwapChainTextures::SwapChainTextures(TexturePool::Ptr pool, int width, int height) :
+		pool(pool), width(width), height(height) {
+	render_tex = pool->acquire(width, height);
 }
 
-void OpenGLGlasses::SwapChainTextures::deallocate_textures() {
-	render_tex.unref();
-	is_allocated = false;
+OpenGLGlasses::SwapChainTextures::~SwapChainTextures() {
+	if (render_tex.is_valid())
+		pool->release(render_tex, width, height);
 }
 
 void OpenGLGlasses::allocate_textures() {
@@ -46,18 +32,19 @@ void OpenGLGlasses::allocate_textures() {
 
 	int width, height;
 	Glasses::get_display_size(width, height);
-	for (int i = 0; i < _swap_chain_textures.size(); i++) {
-		_swap_chain_textures[i].allocate_textures(width, height);
-		set_swap_chain_texture_array(i, render_server->texture_get_native_handle(_swap_chain_textures[i].render_tex->get_rid()));
+	// The textures belong to the swap chain, which returns them once
+	// the renderer has moved on to the next one
+	for (int i = 0; i < get_swap_chain_size(); i++) {
+		auto textures = std::make_shared<SwapChainTextures>(_texture_pool, width, height);
+		set_swap_chain_texture_array(i, render_server->texture_get_native_handle(textures->render_tex));
+		set_swap_chain_resources(i, textures);
 	}
 }
 
 void OpenGLGlasses::deallocate_textures() {
-	auto render_server = RenderingServer::get_singleton();
-
-	for (int i = 0; i < _swap_chain_textures.size(); i++) {
-		_swap_chain_textures[i].deallocate_textures();
+	for (int i = 0; i < get_swap_chain_size(); i++) {
 		set_swap_chain_texture_array(i, 0);
+		set_swap_chain_resources(i, nullptr);
 	}
 }
 
@@ -70,7 +57,9 @@ void OpenGLGlasses::on_stop_display() {
 }
 
 RID OpenGLGlasses::get_color_texture() {
-	int current_frame = get_current_frame_idx();
-	return _swap_chain_textures[current_frame].render_tex->get_rid();
+	// The renderer takes swap chain changes a frame late
+	auto textures = static_cast<SwapChainTextures*>(get_frame_resources());
+	ERR_FAIL_NULL_V(textures, RID());
+	return textures->render_tex;
 }
 } //namespace GodotT5Integration
\ No newline at end of file
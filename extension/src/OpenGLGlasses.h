@@ -1,26 +1,28 @@
 #pragma once
 #include <GodotT5Glasses.h>
-#include <godot_cpp/classes/image_texture.hpp>
-#include <godot_cpp/classes/texture2d_array.hpp>
+#include <TexturePool.h>
 #include <godot_cpp/variant/rid.hpp>
 
 using godot::RID;
-using godot::Texture2DArray;
 using godot::Transform3D;
 
 namespace GodotT5Integration {
 
 class OpenGLGlasses : public GodotT5Glasses {
-	struct SwapChainTextures {
-		void allocate_textures(int width, int height);
-		void deallocate_textures();
-
-		bool is_allocated = false;
-		Ref<Texture2DArray> render_tex;
+	// Returned to the pool once the renderer has moved on
+	struct SwapChainTextures : public SwapChainResources {
+		SwapChainTextures(TexturePool::Ptr pool, int width, int height);
+		~SwapChainTextures() override;
+
+		TexturePool::Ptr pool;
+		RID render_tex;
+		int width = 0;
+		int height = 0;
 	};
 
 public:
-	OpenGLGlasses(std::string_view id);
+	OpenGLGlasses(std::string_view id, TexturePool::Ptr texture_pool);
+	~OpenGLGlasses();
 
 	virtual RID get_color_texture() override;
 
@@ -32,6 +34,6 @@ private:
 	virtual void on_stop_display() override;
 
 private:
-	std::vector<SwapChainTextures> _swap_chain_textures;
+	TexturePool::Ptr _texture_pool;
 };
 } //namespace GodotT5Integration
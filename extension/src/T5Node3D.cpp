@@ -201,8 +201,8 @@ void T5Node3D::_pose_changed(Object *p_obj) {
 GodotT5Glasses::Ptr T5Node3D::get_associated_glasses() {
 	auto service = std::static_pointer_cast<GodotT5Service>(ObjectRegistry::service());
 	if (!_indexes_associated) {
-		service->get_tracker_association(tracker_name, _glasses_idx, _wand_idx);
-		_indexes_associated = true;
+		// Not found until the glasses are reserved
+		_indexes_associated = service->get_tracker_association(tracker_name, _glasses_idx, _wand_idx);
 	}
 	if (_glasses_idx >= 0) {
 		return service->get_glasses(_glasses_idx);
@@ -213,8 +213,8 @@ GodotT5Glasses::Ptr T5Node3D::get_associated_glasses() {
 int T5Node3D::get_associated_wand_num() {
 	if (!_indexes_associated) {
 		auto service = std::static_pointer_cast<GodotT5Service>(ObjectRegistry::service());
-		service->get_tracker_association(tracker_name, _glasses_idx, _wand_idx);
-		_indexes_associated = true;
+		// Not found until the glasses are reserved
+		_indexes_associated = service->get_tracker_association(tracker_name, _glasses_idx, _wand_idx);
 	}
 	return _wand_idx;
 }
@@ -0,0 +1,54 @@
+#include <TexturePool.h>
+#include <godot_cpp/classes/rendering_server.hpp>
+#include <godot_cpp/core/error_macros.hpp>
+#include <godot_cpp/variant/typed_array.hpp>
+
+using godot::RenderingServer;
+using godot::TypedArray;
+
+namespace GodotT5Integration {
+
+TexturePool::~TexturePool() {
+	clear();
+}
+
+RID TexturePool::acquire(int width, int height) {
+	for (auto it = _free_textures.begin(); it != _free_textures.end(); ++it) {
+		if (it->width == width && it->height == height) {
+			RID texture = it->texture;
+			_free_textures.erase(it);
+			return texture;
+		}
+	}
+
+	auto render_server = RenderingServer::get_singleton();
+	ERR_FAIL_NULL_V(render_server, RID());
+
+	if (_blank_layer.is_null() || _blank_layer->get_width() != width || _blank_layer->get_height() != height) {
+		_blank_layer = Image::create(width, height, false, Image::FORMAT_RGBA8);
+		_blank_layer->fill(godot::Color(0, 0, 0));
+	}
+
+	TypedArray<Image> layers;
+	layers.append(_blank_layer);
+	layers.append(_blank_layer);
+
+	return render_server->texture_2d_layered_create(layers, RenderingServer::TEXTURE_LAYERED_2D_ARRAY);
+}
+
+void TexturePool::release(RID texture, int width, int height) {
+	if (texture.is_valid())
+		_free_textures.push_back({ texture, width, height });
+}
+
+void TexturePool::clear() {
+	auto render_server = RenderingServer::get_singleton();
+	if (render_server) {
+		for (auto& entry : _free_textures)
+			render_server->free_rid(entry.texture);
+	}
+	_free_textures.clear();
+	_blank_layer.unref();
+}
+
+} //namespace GodotT5Integration
@@ -0,0 +1,46 @@
+#pragma once
+#include <godot_cpp/classes/image.hpp>
+#include <godot_cpp/classes/ref.hpp>
+#include <godot_cpp/variant/rid.hpp>
+#include <memory>
+#include <vector>
+
+using godot::Image;
+using godot::Ref;
+using godot::RID;
+
+namespace GodotT5Integration {
+
+// Two layer RGBA8 textures for the OpenGL swap chains. Textures
+// released when a display stops are handed to the next display of
+// the same size instead of being freed and created again.
+class TexturePool {
+public:
+	using Ptr = std::shared_ptr<TexturePool>;
+
+	TexturePool() = default;
+	TexturePool(const TexturePool&) = delete;
+	TexturePool& operator=(const TexturePool&) = delete;
+	~TexturePool();
+
+	RID acquire(int width, int height);
+	void release(RID texture, int width, int height);
+	// Frees the textures not in use
+	void clear();
+
+	size_t get_free_count() const { return _free_textures.size(); }
+
+private:
+	struct FreeTexture {
+		RID texture;
+		int width;
+		int height;
+	};
+
+	std::vector<FreeTexture> _free_textures;
+	// Cleared layer content shared by every texture created at
+	// this size. Filled once instead of once per texture.
+	Ref<Image> _blank_layer;
+};
+
+} //namespace GodotT5Integration
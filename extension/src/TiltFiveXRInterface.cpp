@@ -1,5 +1,6 @@
 #include "TiltFiveXRInterface.h"
 #include <godot_cpp/classes/os.hpp>
+#include <godot_cpp/classes/performance.hpp>
 #include <godot_cpp/classes/project_settings.hpp>
 #include <godot_cpp/classes/rendering_server.hpp>
 #include <godot_cpp/core/class_db.hpp>
@@ -9,6 +10,65 @@ using namespace godot;
 using GodotT5Integration::GodotT5ObjectRegistry;
 using T5Integration::GlassesEvent;
 using Eye = GodotT5Integration::Glasses::Eye;
+using T5Integration::FrameStats;
+using T5Integration::RollingHistogram;
+
+namespace {
+
+enum FrameMonitor {
+	SUBMIT_INTERVAL_P50,
+	SUBMIT_INTERVAL_P95,
+	SUBMIT_INTERVAL_P99,
+	POSE_AGE_P50,
+	POSE_AGE_P95,
+	POSE_AGE_P99,
+	SUBMIT_DURATION_P50,
+	SUBMIT_DURATION_P95,
+	SUBMIT_DURATION_P99,
+	SKIPPED_NOT_CONNECTED,
+	SKIPPED_NOT_TRACKING,
+	SUBMIT_ERRORS,
+	FRAME_MONITOR_COUNT
+};
+
+const char* const g_frame_monitor_names[FRAME_MONITOR_COUNT] = {
+	"Submit interval p50 (ms)",
+	"Submit interval p95 (ms)",
+	"Submit interval p99 (ms)",
+	"Pose age p50 (ms)",
+	"Pose age p95 (ms)",
+	"Pose age p99 (ms)",
+	"Submit duration p50 (ms)",
+	"Submit duration p95 (ms)",
+	"Submit duration p99 (ms)",
+	"Frames skipped, not connected",
+	"Frames skipped, not tracking",
+	"Submit errors"
+};
+
+StringName metric_monitor_id(const std::string& name) {
+	return String("Tilt Five/") + name.c_str();
+}
+
+StringName frame_monitor_id(const StringName& glasses_id, int monitor) {
+	return String("Tilt Five ") + String(glasses_id) + "/" + g_frame_monitor_names[monitor];
+}
+
+double to_msec(std::chrono::microseconds time) {
+	return time.count() / 1000.0;
+}
+
+Dictionary to_dictionary(const RollingHistogram::Summary& summary) {
+	Dictionary dictionary;
+	dictionary["count"] = summary.count;
+	dictionary["p50_usec"] = static_cast<int64_t>(summary.p50.count());
+	dictionary["p95_usec"] = static_cast<int64_t>(summary.p95.count());
+	dictionary["p99_usec"] = static_cast<int64_t>(summary.p99.count());
+	dictionary["max_usec"] = static_cast<int64_t>(summary.max.count());
+	return dictionary;
+}
+
+} // namespace
 
 void TiltFiveXRInterface::_bind_methods() {
 	// Methods.
@@ -22,6 +82,25 @@ void TiltFiveXRInterface::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_glasses_name", "glasses_id"), &TiltFiveXRInterface::get_glasses_name);
 	ClassDB::bind_method(D_METHOD("get_gameboard_type", "glasses_id"), &TiltFiveXRInterface::get_gameboard_type);
 	ClassDB::bind_method(D_METHOD("get_gameboard_extents", "gameboard_type"), &TiltFiveXRInterface::get_gameboard_extents);
+	ClassDB::bind_method(D_METHOD("start_session_capture", "path"), &TiltFiveXRInterface::start_session_capture);
+	ClassDB::bind_method(D_METHOD("stop_session_capture"), &TiltFiveXRInterface::stop_session_capture);
+	ClassDB::bind_method(D_METHOD("release_standby_textures"), &TiltFiveXRInterface::release_standby_textures);
+	ClassDB::bind_method(D_METHOD("get_swap_chain_stats", "glasses_id"), &TiltFiveXRInterface::get_swap_chain_stats);
+	ClassDB::bind_method(D_METHOD("get_frame_stats", "glasses_id"), &TiltFiveXRInterface::get_frame_stats);
+	ClassDB::bind_method(D_METHOD("get_frame_timings"), &TiltFiveXRInterface::get_frame_timings);
+	ClassDB::bind_method(D_METHOD("reset_frame_timings"), &TiltFiveXRInterface::reset_frame_timings);
+	ClassDB::bind_method(D_METHOD("get_render_scale", "glasses_id"), &TiltFiveXRInterface::get_render_scale);
+	ClassDB::bind_method(D_METHOD("set_render_rate", "glasses_id", "rate"), &TiltFiveXRInterface::set_render_rate);
+	ClassDB::bind_method(D_METHOD("get_render_rate", "glasses_id"), &TiltFiveXRInterface::get_render_rate);
+	ClassDB::bind_method(D_METHOD("request_render", "glasses_id"), &TiltFiveXRInterface::request_render);
+	ClassDB::bind_method(D_METHOD("set_spectator_enabled", "glasses_id", "is_enabled"), &TiltFiveXRInterface::set_spectator_enabled);
+	ClassDB::bind_method(D_METHOD("is_spectator_enabled", "glasses_id"), &TiltFiveXRInterface::is_spectator_enabled);
+	ClassDB::bind_method(D_METHOD("set_mirror_enabled", "glasses_id", "is_enabled"), &TiltFiveXRInterface::set_mirror_enabled);
+	ClassDB::bind_method(D_METHOD("is_mirror_enabled", "glasses_id"), &TiltFiveXRInterface::is_mirror_enabled);
+	ClassDB::bind_method(D_METHOD("get_mirror_texture", "glasses_id"), &TiltFiveXRInterface::get_mirror_texture);
+	ClassDB::bind_method(D_METHOD("_viewport_exited", "glasses_idx"), &TiltFiveXRInterface::_viewport_exited);
+	ClassDB::bind_method(D_METHOD("_get_frame_monitor", "glasses_idx", "monitor"), &TiltFiveXRInterface::_get_frame_monitor);
+	ClassDB::bind_method(D_METHOD("_get_metric", "monitor_idx"), &TiltFiveXRInterface::_get_metric);
 
 	// Properties.
 	ClassDB::bind_method(D_METHOD("set_application_id", "application_id"), &TiltFiveXRInterface::set_application_id);
@@ -36,6 +115,30 @@ void TiltFiveXRInterface::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_trigger_click_threshold"), &TiltFiveXRInterface::get_trigger_click_threshold);
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "trigger_click_threshold"), "set_trigger_click_threshold", "get_trigger_click_threshold");
 
+	ClassDB::bind_method(D_METHOD("set_swap_chain_depth", "depth"), &TiltFiveXRInterface::set_swap_chain_depth);
+	ClassDB::bind_method(D_METHOD("get_swap_chain_depth"), &TiltFiveXRInterface::get_swap_chain_depth);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "swap_chain_depth"), "set_swap_chain_depth", "get_swap_chain_depth");
+
+	ClassDB::bind_method(D_METHOD("set_standby_grace_period", "seconds"), &TiltFiveXRInterface::set_standby_grace_period);
+	ClassDB::bind_method(D_METHOD("get_standby_grace_period"), &TiltFiveXRInterface::get_standby_grace_period);
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "standby_grace_period"), "set_standby_grace_period", "get_standby_grace_period");
+
+	ClassDB::bind_method(D_METHOD("set_dynamic_resolution", "is_enabled"), &TiltFiveXRInterface::set_dynamic_resolution);
+	ClassDB::bind_method(D_METHOD("get_dynamic_resolution"), &TiltFiveXRInterface::get_dynamic_resolution);
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "dynamic_resolution"), "set_dynamic_resolution", "get_dynamic_resolution");
+
+	ClassDB::bind_method(D_METHOD("set_render_scale_min", "scale"), &TiltFiveXRInterface::set_render_scale_min);
+	ClassDB::bind_method(D_METHOD("get_render_scale_min"), &TiltFiveXRInterface::get_render_scale_min);
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "render_scale_min"), "set_render_scale_min", "get_render_scale_min");
+
+	ClassDB::bind_method(D_METHOD("set_render_scale_max", "scale"), &TiltFiveXRInterface::set_render_scale_max);
+	ClassDB::bind_method(D_METHOD("get_render_scale_max"), &TiltFiveXRInterface::get_render_scale_max);
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "render_scale_max"), "set_render_scale_max", "get_render_scale_max");
+
+	ClassDB::bind_method(D_METHOD("set_target_frame_rate", "frame_rate"), &TiltFiveXRInterface::set_target_frame_rate);
+	ClassDB::bind_method(D_METHOD("get_target_frame_rate"), &TiltFiveXRInterface::get_target_frame_rate);
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "target_frame_rate"), "set_target_frame_rate", "get_target_frame_rate");
+
 	ClassDB::bind_method(D_METHOD("set_debug_logging", "debug_logging"), &TiltFiveXRInterface::set_debug_logging);
 	ClassDB::bind_method(D_METHOD("get_debug_logging"), &TiltFiveXRInterface::get_debug_logging);
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "debug_logging"), "set_debug_logging", "get_debug_logging");
@@ -49,6 +152,7 @@ void TiltFiveXRInterface::_bind_methods() {
 	BIND_ENUM_CONSTANT(E_SERVICE_RUNNING);
 	BIND_ENUM_CONSTANT(E_SERVICE_T5_UNAVAILABLE);
 	BIND_ENUM_CONSTANT(E_SERVICE_T5_INCOMPATIBLE_VERSION);
+	BIND_ENUM_CONSTANT(E_SERVICE_T5_ATTENTION_REQUIRED);
 
 	BIND_ENUM_CONSTANT(E_GLASSES_ADDED);
 	BIND_ENUM_CONSTANT(E_GLASSES_LOST);
@@ -60,6 +164,10 @@ void TiltFiveXRInterface::_bind_methods() {
 	BIND_ENUM_CONSTANT(E_GLASSES_NOT_TRACKING);
 	BIND_ENUM_CONSTANT(E_GLASSES_STOPPED_ON_ERROR);
 
+	BIND_ENUM_CONSTANT(RENDER_FULL_RATE);
+	BIND_ENUM_CONSTANT(RENDER_HALF_RATE);
+	BIND_ENUM_CONSTANT(RENDER_ON_CHANGE);
+
 	BIND_ENUM_CONSTANT(NO_GAMEBOARD_SET);
 	BIND_ENUM_CONSTANT(LE_GAMEBOARD);
 	BIND_ENUM_CONSTANT(XE_GAMEBOARD);
@@ -96,48 +204,96 @@ void TiltFiveXRInterface::set_trigger_click_threshold(float threshold) {
 	}
 }
 
-bool TiltFiveXRInterface::get_debug_logging() {
-	return GodotT5ObjectRegistry::logger()->get_debug();
+int TiltFiveXRInterface::get_swap_chain_depth() {
+	return _swap_chain_depth;
 }
 
-void TiltFiveXRInterface::set_debug_logging(bool is_debug) {
-	GodotT5ObjectRegistry::logger()->set_debug(is_debug);
-}
+void TiltFiveXRInterface::set_swap_chain_depth(int depth) {
+	_swap_chain_depth = depth > 1 ? depth : 1;
 
-TiltFiveXRInterface::GlassesIndexEntry* TiltFiveXRInterface::lookup_glasses_entry(StringName glasses_id) {
 	for (auto& entry : _glasses_index) {
-		if (glasses_id == entry.id) {
-			return &entry;
+		if (!entry.glasses.expired()) {
+			entry.glasses.lock()->set_swap_chain_depth(_swap_chain_depth);
 		}
 	}
-	return nullptr;
 }
 
-TiltFiveXRInterface::GlassesIndexEntry* TiltFiveXRInterface::lookup_glasses_by_render_target(RID test_render_target) {
-	auto render_server = RenderingServer::get_singleton();
+float TiltFiveXRInterface::get_standby_grace_period() {
+	return _standby_grace_period;
+}
 
-	for (auto& entry : _glasses_index) {
-		auto viewport = Object::cast_to<SubViewport>(ObjectDB::get_instance(entry.viewport_id));
-		if (!viewport)
-			continue;
-		auto glasses_render_target = render_server->viewport_get_render_target(viewport->get_viewport_rid());
-		if (test_render_target == glasses_render_target) {
-			return &entry;
-		}
-	}
-	return nullptr;
+void TiltFiveXRInterface::set_standby_grace_period(float seconds) {
+	_standby_grace_period = seconds > 0.0f ? seconds : 0.0f;
+	if (t5_service)
+		t5_service->set_standby_grace_period(std::chrono::milliseconds(static_cast<int64_t>(_standby_grace_period * 1000.0f)));
+}
+
+bool TiltFiveXRInterface::get_dynamic_resolution() {
+	return _is_dynamic_resolution;
 }
 
-TiltFiveXRInterface::GlassesIndexEntry* TiltFiveXRInterface::lookup_glasses_by_viewport(RID test_viewport) {
+void TiltFiveXRInterface::set_dynamic_resolution(bool is_enabled) {
+	if (_is_dynamic_resolution == is_enabled)
+		return;
+	// The Compatibility renderer ignores scaling_3d_scale
+	ERR_FAIL_COND_MSG(is_enabled && _initialised && t5_service->get_graphics_api() != kT5_GraphicsApi_Vulkan, "Dynamic resolution needs the Forward+ or Mobile renderer");
+	_is_dynamic_resolution = is_enabled;
+
 	for (auto& entry : _glasses_index) {
-		auto viewport = Object::cast_to<SubViewport>(ObjectDB::get_instance(entry.viewport_id));
-		if (!viewport)
-			continue;
-		if (test_viewport == viewport->get_viewport_rid()) {
-			return &entry;
+		if (!entry.glasses.expired()) {
+			apply_dynamic_resolution(entry, _is_dynamic_resolution);
 		}
 	}
-	return nullptr;
+	publish_render_entries();
+}
+
+float TiltFiveXRInterface::get_render_scale_min() {
+	return _render_scale_min;
+}
+
+void TiltFiveXRInterface::set_render_scale_min(float scale) {
+	_render_scale_min = scale;
+	update_render_scale_limits();
+}
+
+float TiltFiveXRInterface::get_render_scale_max() {
+	return _render_scale_max;
+}
+
+void TiltFiveXRInterface::set_render_scale_max(float scale) {
+	_render_scale_max = scale;
+	update_render_scale_limits();
+}
+
+float TiltFiveXRInterface::get_target_frame_rate() {
+	return _target_frame_rate;
+}
+
+void TiltFiveXRInterface::set_target_frame_rate(float frame_rate) {
+	_target_frame_rate = frame_rate > 1.0f ? frame_rate : 1.0f;
+	update_render_scale_limits();
+}
+
+bool TiltFiveXRInterface::get_debug_logging() {
+	return GodotT5ObjectRegistry::logger()->get_debug();
+}
+
+void TiltFiveXRInterface::set_debug_logging(bool is_debug) {
+	GodotT5ObjectRegistry::logger()->set_debug(is_debug);
+}
+
+TiltFiveXRInterface::GlassesIndexEntry* TiltFiveXRInterface::lookup_glasses_entry(StringName glasses_id) {
+	auto found = _glasses_id_index.find(glasses_id);
+	if (found == _glasses_id_index.end())
+		return nullptr;
+	return &_glasses_index[found->value];
+}
+
+TiltFiveXRInterface::RenderEntry* TiltFiveXRInterface::lookup_glasses_by_render_target(RID test_render_target) {
+	auto found = _render_entries.render_target_index.find(test_render_target);
+	if (found == _render_entries.render_target_index.end())
+		return nullptr;
+	return &_render_entries.entries[found->value];
 }
 
 bool TiltFiveXRInterface::_is_initialized() const {
@@ -155,6 +311,7 @@ bool TiltFiveXRInterface::_initialize() {
 
 	t5_service = GodotT5ObjectRegistry::service();
 	ERR_FAIL_COND_V_MSG(!t5_service, false, "Couldn't obtain GodotT5Service singleton");
+	_frame_timer = t5_service->get_frame_timer();
 
 	RenderingServer* rendering_server = RenderingServer::get_singleton();
 	ERR_FAIL_NULL_V(rendering_server, false);
@@ -163,8 +320,15 @@ bool TiltFiveXRInterface::_initialize() {
 		t5_service->use_vulkan_api();
 	} else {
 		t5_service->use_opengl_api();
+		if (_is_dynamic_resolution) {
+			WARN_PRINT("Dynamic resolution needs the Forward+ or Mobile renderer, turning it off");
+			_is_dynamic_resolution = false;
+		}
 	}
 
+	set_standby_grace_period(_standby_grace_period);
+	add_metric_monitors();
+
 	auto ai = application_id.ascii();
 	auto av = application_version.ascii();
 
@@ -177,6 +341,8 @@ bool TiltFiveXRInterface::_initialize() {
 
 void TiltFiveXRInterface::_uninitialize() {
 	if (_initialised) {
+		remove_frame_monitors();
+		remove_metric_monitors();
 		if (t5_service->is_service_started()) {
 			t5_service->stop_service();
 		}
@@ -223,12 +389,27 @@ void TiltFiveXRInterface::_start_display(TiltFiveXRInterface::GlassesIndexEntry&
 		WARN_PRINT("Glasses need to be reserved to display viewport");
 		return;
 	}
+	if (entry.viewport_id.is_valid() && entry.viewport_id != viewport->get_instance_id())
+		_stop_display(entry);
+
 	glasses->start_display();
 	entry.viewport_id = viewport->get_instance_id();
 	entry.gameboard_id = gameboard->get_instance_id();
 
+	// Looked up by _pre_draw_viewport for every viewport every frame
+	entry.render_target = RenderingServer::get_singleton()->viewport_get_render_target(viewport->get_viewport_rid());
+	// Deferred so a viewport that is only being moved is back in the
+	// tree by the time it's checked
+	if (!viewport->is_connected("tree_exited", Callable(this, "_viewport_exited")))
+		viewport->connect("tree_exited", Callable(this, "_viewport_exited").bind(entry.idx), Object::CONNECT_DEFERRED);
+
 	viewport->set_use_xr(true);
 	viewport->set_update_mode(godot::SubViewport::UpdateMode::UPDATE_ALWAYS);
+
+	update_render_scale_limits();
+	if (_is_dynamic_resolution)
+		apply_dynamic_resolution(entry, true);
+	publish_render_entries();
 }
 
 void TiltFiveXRInterface::stop_display(const StringName glasses_id) {
@@ -239,14 +420,196 @@ void TiltFiveXRInterface::stop_display(const StringName glasses_id) {
 
 void TiltFiveXRInterface::_stop_display(GlassesIndexEntry& entry) {
 	auto glasses = entry.glasses.lock();
+	if (_is_dynamic_resolution)
+		apply_dynamic_resolution(entry, false);
 	auto viewport = Object::cast_to<SubViewport>(ObjectDB::get_instance(entry.viewport_id));
 	if (viewport) {
 		viewport->set_use_xr(false);
 		viewport->set_update_mode(godot::SubViewport::UpdateMode::UPDATE_DISABLED);
+		if (viewport->is_connected("tree_exited", Callable(this, "_viewport_exited")))
+			viewport->disconnect("tree_exited", Callable(this, "_viewport_exited"));
 	}
 	glasses->stop_display();
 	entry.viewport_id = ObjectID();
 	entry.gameboard_id = ObjectID();
+	entry.render_target = RID();
+	update_render_scale_limits();
+	publish_render_entries();
+}
+
+void TiltFiveXRInterface::apply_dynamic_resolution(GlassesIndexEntry& entry, bool is_enabled) {
+	auto viewport = Object::cast_to<SubViewport>(ObjectDB::get_instance(entry.viewport_id));
+	if (!viewport)
+		return;
+	RenderingServer::get_singleton()->viewport_set_measure_render_time(viewport->get_viewport_rid(), is_enabled);
+	viewport->set_scaling_3d_scale(is_enabled ? entry.glasses.lock()->get_render_scale() : 1.0f);
+}
+
+void TiltFiveXRInterface::update_render_scale_limits() {
+	// Displayed viewports share the frame time evenly
+	int displayed_count = 0;
+	for (auto& entry : _glasses_index) {
+		if (entry.render_target.is_valid())
+			++displayed_count;
+	}
+
+	T5Integration::RenderScaleLimits limits;
+	limits.min_scale = _render_scale_min;
+	limits.max_scale = _render_scale_max;
+	limits.frame_budget = std::chrono::microseconds(static_cast<int64_t>(1000000.0f / _target_frame_rate / std::max(displayed_count, 1)));
+
+	for (auto& entry : _glasses_index) {
+		if (!entry.glasses.expired()) {
+			entry.glasses.lock()->set_render_scale_limits(limits);
+		}
+	}
+}
+
+void TiltFiveXRInterface::publish_render_entries() {
+	RenderEntries render_entries;
+	render_entries.entries.reserve(_glasses_index.size());
+	render_entries.is_dynamic_resolution = _is_dynamic_resolution;
+	for (auto& entry : _glasses_index) {
+		auto viewport = Object::cast_to<SubViewport>(ObjectDB::get_instance(entry.viewport_id));
+		if (entry.render_target.is_valid())
+			render_entries.render_target_index.insert(entry.render_target, static_cast<int>(render_entries.entries.size()));
+		render_entries.entries.push_back({ entry.glasses, viewport ? viewport->get_viewport_rid() : RID(), entry.gameboard_id, entry.render_target });
+	}
+	_render_entries_handoff.publish(render_entries);
+}
+
+bool TiltFiveXRInterface::update_render_scale(RenderEntry& entry, GodotT5Glasses& glasses) {
+	if (!entry.viewport.is_valid())
+		return false;
+
+	// Measurements trail the frame just drawn by a few frames
+	auto rendering_server = RenderingServer::get_singleton();
+	auto cpu_time = std::chrono::microseconds(static_cast<int64_t>(rendering_server->viewport_get_measured_render_time_cpu(entry.viewport) * 1000.0));
+	auto gpu_time = std::chrono::microseconds(static_cast<int64_t>(rendering_server->viewport_get_measured_render_time_gpu(entry.viewport) * 1000.0));
+	return glasses.add_frame_time(cpu_time, gpu_time);
+}
+
+void TiltFiveXRInterface::apply_render_scales(const std::vector<float>& render_scales) {
+	if (!_is_dynamic_resolution)
+		return;
+	for (size_t idx = 0; idx < render_scales.size() && idx < _glasses_index.size(); ++idx) {
+		auto viewport = Object::cast_to<SubViewport>(ObjectDB::get_instance(_glasses_index[idx].viewport_id));
+		if (viewport && viewport->get_scaling_3d_scale() != render_scales[idx])
+			viewport->set_scaling_3d_scale(render_scales[idx]);
+	}
+}
+
+void TiltFiveXRInterface::add_frame_monitors(GlassesIndexEntry& entry) {
+	auto performance = Performance::get_singleton();
+	ERR_FAIL_NULL(performance);
+	for (int monitor = 0; monitor < FRAME_MONITOR_COUNT; ++monitor) {
+		auto id = frame_monitor_id(entry.id, monitor);
+		if (performance->has_custom_monitor(id))
+			continue;
+		Array args;
+		args.append(entry.idx);
+		args.append(monitor);
+		performance->add_custom_monitor(id, Callable(this, "_get_frame_monitor"), args);
+	}
+}
+
+void TiltFiveXRInterface::add_metric_monitors() {
+	auto performance = Performance::get_singleton();
+	ERR_FAIL_NULL(performance);
+	auto metrics = t5_service->get_metrics();
+	for (int monitor_idx = 0; monitor_idx < metrics->get_monitor_count(); ++monitor_idx) {
+		auto id = metric_monitor_id(metrics->get_monitor_name(monitor_idx));
+		if (performance->has_custom_monitor(id))
+			continue;
+		Array args;
+		args.append(monitor_idx);
+		performance->add_custom_monitor(id, Callable(this, "_get_metric"), args);
+	}
+}
+
+void TiltFiveXRInterface::remove_metric_monitors() {
+	auto performance = Performance::get_singleton();
+	if (!performance || !t5_service)
+		return;
+	auto metrics = t5_service->get_metrics();
+	for (int monitor_idx = 0; monitor_idx < metrics->get_monitor_count(); ++monitor_idx) {
+		auto id = metric_monitor_id(metrics->get_monitor_name(monitor_idx));
+		if (performance->has_custom_monitor(id))
+			performance->remove_custom_monitor(id);
+	}
+}
+
+double TiltFiveXRInterface::_get_metric(int monitor_idx) {
+	if (!t5_service)
+		return 0.0;
+	return t5_service->get_metrics()->read_monitor(monitor_idx);
+}
+
+void TiltFiveXRInterface::remove_frame_monitors() {
+	auto performance = Performance::get_singleton();
+	if (!performance)
+		return;
+	for (auto& entry : _glasses_index) {
+		for (int monitor = 0; monitor < FRAME_MONITOR_COUNT; ++monitor) {
+			auto id = frame_monitor_id(entry.id, monitor);
+			if (performance->has_custom_monitor(id))
+				performance->remove_custom_monitor(id);
+		}
+	}
+}
+
+double TiltFiveXRInterface::_get_frame_monitor(int glasses_idx, int monitor) {
+	ERR_FAIL_INDEX_V(glasses_idx, _glasses_index.size(), 0.0);
+	auto glasses = _glasses_index[glasses_idx].glasses.lock();
+	if (!glasses)
+		return 0.0;
+
+	auto report = glasses->get_frame_stats();
+	switch (monitor) {
+		case SUBMIT_INTERVAL_P50:
+			return to_msec(report.submit_interval.p50);
+		case SUBMIT_INTERVAL_P95:
+			return to_msec(report.submit_interval.p95);
+		case SUBMIT_INTERVAL_P99:
+			return to_msec(report.submit_interval.p99);
+		case POSE_AGE_P50:
+			return to_msec(report.pose_age.p50);
+		case POSE_AGE_P95:
+			return to_msec(report.pose_age.p95);
+		case POSE_AGE_P99:
+			return to_msec(report.pose_age.p99);
+		case SUBMIT_DURATION_P50:
+			return to_msec(report.submit_duration.p50);
+		case SUBMIT_DURATION_P95:
+			return to_msec(report.submit_duration.p95);
+		case SUBMIT_DURATION_P99:
+			return to_msec(report.submit_duration.p99);
+		case SKIPPED_NOT_CONNECTED:
+			return static_cast<double>(report.skipped_not_connected);
+		case SKIPPED_NOT_TRACKING:
+			return static_cast<double>(report.skipped_not_tracking);
+		case SUBMIT_ERRORS: {
+			uint64_t errors = 0;
+			for (auto& [result, count] : report.errors)
+				errors += count;
+			return static_cast<double>(errors);
+		}
+		default:
+			return 0.0;
+	}
+}
+
+void TiltFiveXRInterface::_viewport_exited(int glasses_idx) {
+	// Reparenting also takes a viewport out of the tree, only stop
+	// displaying one that has been or is about to be freed
+	ERR_FAIL_INDEX(glasses_idx, _glasses_index.size());
+	auto& entry = _glasses_index[glasses_idx];
+	if (!entry.render_target.is_valid())
+		return;
+	auto viewport = Object::cast_to<SubViewport>(ObjectDB::get_instance(entry.viewport_id));
+	if (viewport && !viewport->is_queued_for_deletion())
+		return;
+	_stop_display(entry);
 }
 
 void TiltFiveXRInterface::release_glasses(const StringName glasses_id) {
@@ -306,6 +669,166 @@ TiltFiveXRInterface::GameBoardType TiltFiveXRInterface::get_gameboard_type(const
 	return static_cast<GameBoardType>(entry->glasses.lock()->get_gameboard_type());
 }
 
+bool TiltFiveXRInterface::start_session_capture(const String path) {
+	if (!t5_service)
+		return false;
+
+	auto file_path = ProjectSettings::get_singleton()->globalize_path(path);
+	return t5_service->start_capture(file_path.utf8().get_data());
+}
+
+void TiltFiveXRInterface::stop_session_capture() {
+	if (t5_service)
+		t5_service->stop_capture();
+}
+
+void TiltFiveXRInterface::release_standby_textures() {
+	if (t5_service)
+		t5_service->release_standby();
+}
+
+Dictionary TiltFiveXRInterface::get_swap_chain_stats(const StringName glasses_id) {
+	Dictionary stats;
+	auto entry = lookup_glasses_entry(glasses_id);
+	ERR_FAIL_COND_V_MSG(!entry, stats, "Glasses id was not found");
+
+	auto swap_chain_stats = entry->glasses.lock()->get_swap_chain_stats();
+	stats["depth"] = swap_chain_stats.depth;
+	stats["frames_in_flight"] = swap_chain_stats.frames_in_flight;
+	stats["frames_sent"] = static_cast<int64_t>(swap_chain_stats.frames_sent);
+	stats["early_reuses"] = static_cast<int64_t>(swap_chain_stats.early_reuses);
+	stats["frames_resent"] = static_cast<int64_t>(swap_chain_stats.frames_resent);
+	stats["start_usec"] = static_cast<int64_t>(swap_chain_stats.start_time.count());
+	return stats;
+}
+
+Dictionary TiltFiveXRInterface::get_frame_stats(const StringName glasses_id) {
+	Dictionary stats;
+	auto entry = lookup_glasses_entry(glasses_id);
+	ERR_FAIL_COND_V_MSG(!entry, stats, "Glasses id was not found");
+
+	auto report = entry->glasses.lock()->get_frame_stats();
+	stats["submit_interval"] = to_dictionary(report.submit_interval);
+	stats["pose_age"] = to_dictionary(report.pose_age);
+	stats["submit_duration"] = to_dictionary(report.submit_duration);
+	stats["frames_submitted"] = static_cast<int64_t>(report.frames_submitted);
+	stats["skipped_not_connected"] = static_cast<int64_t>(report.skipped_not_connected);
+	stats["skipped_not_tracking"] = static_cast<int64_t>(report.skipped_not_tracking);
+	// Keyed by T5_Result code
+	Dictionary errors;
+	for (auto& [result, count] : report.errors)
+		errors[static_cast<int64_t>(result)] = static_cast<int64_t>(count);
+	stats["errors"] = errors;
+	return stats;
+}
+
+Dictionary TiltFiveXRInterface::get_frame_timings() {
+	Dictionary timings;
+	ERR_FAIL_COND_V_MSG(!_frame_timer, timings, "Tilt Five interface was never initialized");
+
+	const std::pair<FrameTimer::Stage, const char*> stages[] = {
+		{ FrameTimer::PROCESS, "process" },
+		{ FrameTimer::PRE_DRAW, "pre_draw_viewport" },
+		{ FrameTimer::END_FRAME, "end_frame" },
+		{ FrameTimer::SCHEDULER, "scheduler" },
+	};
+	for (auto& [stage, name] : stages) {
+		auto report = _frame_timer->get_report(stage);
+		auto timing = to_dictionary(report.summary);
+		timing["frames"] = static_cast<int64_t>(report.frames);
+		timing["mean_usec"] = report.frames ? report.total.count() / 1000.0 / report.frames : 0.0;
+		timings[name] = timing;
+	}
+	return timings;
+}
+
+void TiltFiveXRInterface::reset_frame_timings() {
+	if (_frame_timer)
+		_frame_timer->clear();
+}
+
+float TiltFiveXRInterface::get_render_scale(const StringName glasses_id) {
+	auto entry = lookup_glasses_entry(glasses_id);
+	ERR_FAIL_COND_V_MSG(!entry, 1.0f, "Glasses id was not found");
+
+	return entry->glasses.lock()->get_render_scale();
+}
+
+void TiltFiveXRInterface::set_render_rate(const StringName glasses_id, RenderRateType rate) {
+	auto entry = lookup_glasses_entry(glasses_id);
+	ERR_FAIL_COND_MSG(!entry, "Glasses id was not found");
+
+	entry->glasses.lock()->set_render_rate(static_cast<T5Integration::RenderRate>(rate));
+}
+
+TiltFiveXRInterface::RenderRateType TiltFiveXRInterface::get_render_rate(const StringName glasses_id) {
+	auto entry = lookup_glasses_entry(glasses_id);
+	ERR_FAIL_COND_V_MSG(!entry, RENDER_FULL_RATE, "Glasses id was not found");
+
+	return static_cast<RenderRateType>(entry->glasses.lock()->get_render_rate());
+}
+
+void TiltFiveXRInterface::request_render(const StringName glasses_id) {
+	auto entry = lookup_glasses_entry(glasses_id);
+	ERR_FAIL_COND_MSG(!entry, "Glasses id was not found");
+
+	entry->glasses.lock()->request_render();
+}
+
+void TiltFiveXRInterface::set_spectator_enabled(const StringName glasses_id, bool is_enabled) {
+	auto entry = lookup_glasses_entry(glasses_id);
+	ERR_FAIL_COND_MSG(!entry, "Glasses id was not found");
+
+	entry->glasses.lock()->set_spectator_enabled(is_enabled);
+}
+
+bool TiltFiveXRInterface::is_spectator_enabled(const StringName glasses_id) {
+	auto entry = lookup_glasses_entry(glasses_id);
+	ERR_FAIL_COND_V_MSG(!entry, false, "Glasses id was not found");
+
+	return entry->glasses.lock()->is_spectator_enabled();
+}
+
+void TiltFiveXRInterface::set_mirror_enabled(const StringName glasses_id, bool is_enabled) {
+	if (!t5_service)
+		return;
+	auto entry = lookup_glasses_entry(glasses_id);
+	ERR_FAIL_COND_MSG(!entry, "Glasses id was not found");
+	// The frame is read back with the RenderingDevice
+	ERR_FAIL_COND_MSG(is_enabled && t5_service->get_graphics_api() != kT5_GraphicsApi_Vulkan, "The mirror needs the Forward+ or Mobile renderer");
+
+	entry->glasses.lock()->set_mirror_enabled(is_enabled);
+	if (!is_enabled)
+		entry->mirror_texture.unref();
+}
+
+bool TiltFiveXRInterface::is_mirror_enabled(const StringName glasses_id) {
+	auto entry = lookup_glasses_entry(glasses_id);
+	ERR_FAIL_COND_V_MSG(!entry, false, "Glasses id was not found");
+
+	return entry->glasses.lock()->is_mirror_enabled();
+}
+
+Ref<Texture2D> TiltFiveXRInterface::get_mirror_texture(const StringName glasses_id) {
+	auto entry = lookup_glasses_entry(glasses_id);
+	ERR_FAIL_COND_V_MSG(!entry, Ref<Texture2D>(), "Glasses id was not found");
+
+	auto glasses = entry->glasses.lock();
+	if (!glasses->is_mirror_enabled())
+		return Ref<Texture2D>();
+
+	// The texture is kept and updated in place, so a material showing
+	// it follows the frames
+	auto image = glasses->get_mirror_image();
+	if (image.is_valid()) {
+		if (entry->mirror_texture.is_valid() && entry->mirror_texture->get_width() == image->get_width() && entry->mirror_texture->get_height() == image->get_height())
+			entry->mirror_texture->update(image);
+		else
+			entry->mirror_texture = ImageTexture::create_from_image(image);
+	}
+	return entry->mirror_texture;
+}
+
 AABB TiltFiveXRInterface::get_gameboard_extents(GameBoardType gameboard_type) {
 	AABB result;
 	if (!t5_service)
@@ -368,7 +891,7 @@ Transform3D TiltFiveXRInterface::_get_camera_transform() {
 		return Transform3D();
 	}
 
-	auto hmd_transform = _render_glasses->get_head_transform();
+	auto hmd_transform = _render_glasses->get_frame_transform();
 
 	// Should be the gameboard scale set in _pre_draw_viewport.
 	auto world_scale = xr_server->get_world_scale();
@@ -416,21 +939,41 @@ PackedFloat64Array TiltFiveXRInterface::_get_projection_for_view(uint32_t p_view
 	return _render_glasses->get_projection_for_eye(p_view == 0 ? Eye::Left : Eye::Right, aspect, z_near * world_scale, z_far * world_scale);
 }
 
+void TiltFiveXRInterface::_pre_render() {
+	// Displays started or stopped since the last frame
+	_render_entries_handoff.take(_render_entries);
+	// Frames are only taken from the thread that provided the
+	// graphics context, which is this one
+	for (auto& entry : _render_entries.entries) {
+		if (auto glasses = entry.glasses.lock())
+			glasses->initialize_pending_graphics();
+	}
+}
+
 bool TiltFiveXRInterface::_pre_draw_viewport(const RID& render_target) {
 	ERR_FAIL_NULL_V_MSG(xr_server, false, "XRServer unavailable");
 	ERR_FAIL_COND_V_MSG(_render_glasses, false, "Rendering viewport already set");
 	auto entry = lookup_glasses_by_render_target(render_target);
 	ERR_FAIL_COND_V_MSG(!entry, false, "Viewport does not have associated glasses");
+	FrameTimer::Scope timed(*_frame_timer, FrameTimer::PRE_DRAW);
 
-	_render_glasses = entry->glasses.lock();
-
-	if (!_render_glasses->is_reserved())
+	auto glasses = entry->glasses.lock();
+	if (!glasses || !glasses->is_reserved())
 		return false;
 
 	auto gameboard = Object::cast_to<T5Origin3D>(ObjectDB::get_instance(entry->gameboard_id));
 	if (!gameboard)
 		return false;
 
+	// Skipping here saves the whole draw, culling included
+	if (!glasses->should_render_frame()) {
+		entry->resending = true;
+		return false;
+	}
+
+	_render_glasses = glasses;
+	_render_glasses->begin_frame();
+
 	xr_server->set_world_origin(gameboard->get_global_transform());
 	xr_server->set_world_scale(gameboard->get_gameboard_scale());
 
@@ -444,12 +987,44 @@ void TiltFiveXRInterface::_post_draw_viewport(const RID& render_target, const Re
 }
 
 void TiltFiveXRInterface::_end_frame() {
-	for (auto& entry : _glasses_index) {
-		if (entry.rendering) {
-			entry.glasses.lock()->send_frame();
-			entry.rendering = false;
+	if (!_frame_timer)
+		return;
+
+	{
+		FrameTimer::Scope timed(*_frame_timer, FrameTimer::END_FRAME);
+		bool is_scale_changed = false;
+		for (auto& entry : _render_entries.entries) {
+			auto glasses = entry.glasses.lock();
+			if (!glasses)
+				continue;
+			if (entry.rendering) {
+				glasses->update_mirror();
+				glasses->send_frame();
+				if (_render_entries.is_dynamic_resolution && update_render_scale(entry, *glasses))
+					is_scale_changed = true;
+				entry.rendering = false;
+			} else if (entry.resending) {
+				glasses->resend_frame();
+				entry.resending = false;
+			} else {
+				// Lets the main thread free textures replaced while
+				// the glasses weren't drawn
+				glasses->take_swap_chain();
+			}
+		}
+		if (is_scale_changed) {
+			std::vector<float> render_scales;
+			render_scales.reserve(_render_entries.entries.size());
+			for (auto& entry : _render_entries.entries) {
+				auto glasses = entry.glasses.lock();
+				render_scales.push_back(glasses ? glasses->get_render_scale() : 1.0f);
+			}
+			_render_scale_handoff.publish(render_scales);
 		}
 	}
+	// Includes the viewports drawn since the last end
+	_frame_timer->end_frame(FrameTimer::PRE_DRAW);
+	_frame_timer->end_frame(FrameTimer::END_FRAME);
 }
 
 PackedStringArray TiltFiveXRInterface::_get_suggested_tracker_names() const {
@@ -489,6 +1064,9 @@ void TiltFiveXRInterface::log_service_events() {
 				case T5ServiceEvent::E_T5_INCOMPATIBLE_VERSION:
 					LOG_MESSAGE("Tilt Five Incompatible Version");
 					break;
+				case T5ServiceEvent::E_T5_ATTENTION_REQUIRED:
+					LOG_MESSAGE("Tilt Five Control Panel Requires Attention");
+					break;
 			}
 		}
 	}
@@ -537,9 +1115,14 @@ void TiltFiveXRInterface::_process() {
 	if (!t5_service)
 		return;
 
+	auto process_start = FrameTimer::Clock::now();
 	t5_service->update_connection();
 	t5_service->update_tracking();
 
+	std::vector<float> render_scales;
+	if (_render_scale_handoff.take(render_scales))
+		apply_render_scales(render_scales);
+
 	_service_events.clear();
 	t5_service->get_service_events(_service_events);
 	log_service_events();
@@ -554,17 +1137,23 @@ void TiltFiveXRInterface::_process() {
 		auto glasses_idx = _glasses_events[i].glasses_num;
 		switch (_glasses_events[i].event) {
 			case GlassesEvent::E_ADDED: {
-				if (_glasses_index.size() != glasses_idx) {
+				// Glasses plugged back in keep their index
+				if (_glasses_index.size() < glasses_idx) {
 					WARN_PRINT("Glasses index");
 				}
-				_glasses_index.resize(glasses_idx + 1);
+				if (_glasses_index.size() <= glasses_idx)
+					_glasses_index.resize(glasses_idx + 1);
 				auto glasses = t5_service->get_glasses(glasses_idx);
 				glasses->set_trigger_click_threshold(_trigger_click_threshold);
+				glasses->set_swap_chain_depth(_swap_chain_depth);
 
 				_glasses_index[glasses_idx].glasses = glasses;
 				_glasses_index[glasses_idx].id = glasses->get_id().c_str();
 				_glasses_index[glasses_idx].idx = glasses_idx;
-				_glasses_index[glasses_idx].rendering = false;
+				_glasses_id_index.insert(_glasses_index[glasses_idx].id, glasses_idx);
+				update_render_scale_limits();
+				add_frame_monitors(_glasses_index[glasses_idx]);
+				publish_render_entries();
 
 			} break;
 			case GlassesEvent::E_CONNECTED: {
@@ -590,6 +1179,10 @@ void TiltFiveXRInterface::_process() {
 		}
 		emit_signal("glasses_event", _glasses_index[_glasses_events[i].glasses_num].id, (int)_glasses_events[i].event);
 	}
+
+	_frame_timer->add(FrameTimer::PROCESS, FrameTimer::Clock::now() - process_start);
+	_frame_timer->end_frame(FrameTimer::PROCESS);
+	_frame_timer->end_frame(FrameTimer::SCHEDULER);
 }
 
 RID TiltFiveXRInterface::_get_color_texture() {
@@ -3,24 +3,33 @@
 
 #include <godot_cpp/classes/xr_interface_extension.hpp>
 
+#include <godot_cpp/classes/image_texture.hpp>
 #include <godot_cpp/classes/sub_viewport.hpp>
+#include <godot_cpp/classes/texture2d.hpp>
 #include <godot_cpp/classes/xr_server.hpp>
 #include <godot_cpp/core/binder_common.hpp>
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
 #include <godot_cpp/variant/packed_string_array.hpp>
 
 #include <GodotT5Glasses.h>
 #include <GodotT5Service.h>
+#include <Handoff.h>
 #include <T5Origin3D.h>
 
 using godot::AABB;
+using godot::Dictionary;
+using godot::ImageTexture;
 using godot::ObjectID;
 using godot::PackedFloat64Array;
 using godot::PackedStringArray;
+using godot::Ref;
 using godot::Rect2;
 using godot::RID;
 using godot::String;
 using godot::StringName;
 using godot::SubViewport;
+using godot::Texture2D;
 using godot::Transform3D;
 using godot::Variant;
 using godot::Vector2;
@@ -28,7 +37,9 @@ using godot::XRInterfaceExtension;
 using godot::XRServer;
 using GodotT5Integration::GodotT5Glasses;
 using GodotT5Integration::GodotT5Service;
+using T5Integration::FrameTimer;
 using T5Integration::GlassesEvent;
+using T5Integration::Handoff;
 using T5Integration::T5ServiceEvent;
 
 // ID assigned to this Godot plugin
@@ -52,7 +63,32 @@ class TiltFiveXRInterface : public XRInterfaceExtension {
 		std::weak_ptr<GodotT5Glasses> glasses;
 		ObjectID viewport_id;
 		ObjectID gameboard_id;
-		bool rendering;
+		// Render target of the viewport, valid while it is displayed
+		RID render_target;
+		// Updated from the glasses' mirror image
+		Ref<ImageTexture> mirror_texture;
+	};
+
+	// The render thread's copy of an index entry, published by the
+	// main thread when glasses are added or a display starts or stops
+	struct RenderEntry {
+		std::weak_ptr<GodotT5Glasses> glasses;
+		// The viewport's RenderingServer RID, the node is only touched
+		// on the main thread
+		RID viewport;
+		ObjectID gameboard_id;
+		RID render_target;
+		bool rendering = false;
+		// Skipped by the render rate, the last frame is resent
+		bool resending = false;
+	};
+
+	struct RenderEntries {
+		std::vector<RenderEntry> entries;
+		// Positions in entries by the render target of the viewport
+		// being displayed
+		godot::HashMap<RID, int> render_target_index;
+		bool is_dynamic_resolution = false;
 	};
 
 public:
@@ -64,7 +100,8 @@ public:
 		E_SERVICE_STOPPED					= T5ServiceEvent::E_STOPPED,
 		E_SERVICE_RUNNING					= T5ServiceEvent::E_RUNNING,
 		E_SERVICE_T5_UNAVAILABLE			= T5ServiceEvent::E_T5_UNAVAILABLE,
-		E_SERVICE_T5_INCOMPATIBLE_VERSION	= T5ServiceEvent::E_T5_INCOMPATIBLE_VERSION
+		E_SERVICE_T5_INCOMPATIBLE_VERSION	= T5ServiceEvent::E_T5_INCOMPATIBLE_VERSION,
+		E_SERVICE_T5_ATTENTION_REQUIRED		= T5ServiceEvent::E_T5_ATTENTION_REQUIRED
     };
 
 	enum GlassesEventType
@@ -79,6 +116,13 @@ public:
 		E_GLASSES_NOT_TRACKING		= GlassesEvent::E_NOT_TRACKING,
 		E_GLASSES_STOPPED_ON_ERROR 	= GlassesEvent::E_STOPPED_ON_ERROR
 	};
+
+	enum RenderRateType
+	{
+		RENDER_FULL_RATE	= static_cast<int>(T5Integration::RenderRate::FULL),
+		RENDER_HALF_RATE	= static_cast<int>(T5Integration::RenderRate::HALF),
+		RENDER_ON_CHANGE	= static_cast<int>(T5Integration::RenderRate::ON_CHANGE)
+	};
 	// clang-format on
 
 	// Property setters and getters.
@@ -92,6 +136,28 @@ public:
 	float get_trigger_click_threshold();
 	void set_trigger_click_threshold(float threshold);
 
+	// Swap chain slots of glasses whose display starts after this is set
+	int get_swap_chain_depth();
+	void set_swap_chain_depth(int depth);
+
+	// Seconds the textures of a stopped display are kept for reuse
+	float get_standby_grace_period();
+	void set_standby_grace_period(float seconds);
+
+	// Scales the 3D resolution of each displayed viewport to keep
+	// its render time within its share of the target frame rate
+	bool get_dynamic_resolution();
+	void set_dynamic_resolution(bool is_enabled);
+
+	float get_render_scale_min();
+	void set_render_scale_min(float scale);
+
+	float get_render_scale_max();
+	void set_render_scale_max(float scale);
+
+	float get_target_frame_rate();
+	void set_target_frame_rate(float frame_rate);
+
 	bool get_debug_logging();
 	void set_debug_logging(bool is_debug);
 
@@ -110,6 +176,46 @@ public:
 
 	String get_glasses_name(const StringName glasses_id);
 
+	bool start_session_capture(const String path);
+	void stop_session_capture();
+
+	// Frees textures kept on standby, on a low memory warning say
+	void release_standby_textures();
+
+	Dictionary get_swap_chain_stats(const StringName glasses_id);
+	// Frame pacing and submit results over the last few hundred
+	// frames. Also shown as Performance monitors under
+	// "Tilt Five <glasses id>".
+	Dictionary get_frame_stats(const StringName glasses_id);
+
+	// CPU time per engine frame of _process, of _pre_draw_viewport and
+	// _end_frame over all glasses, and of the service scheduler (part
+	// of _process). Percentiles cover the last few hundred frames, the
+	// mean every frame since the reset.
+	Dictionary get_frame_timings();
+	void reset_frame_timings();
+
+	float get_render_scale(const StringName glasses_id);
+
+	// Engine frames the glasses don't render resend their last frame
+	void set_render_rate(const StringName glasses_id, RenderRateType rate);
+	RenderRateType get_render_rate(const StringName glasses_id);
+	// Renders the next frame of glasses at RENDER_ON_CHANGE
+	void request_render(const StringName glasses_id);
+
+	// Adds the tracker /user/<glasses id>/spectator following the
+	// spectator pose, read along with the glasses pose
+	void set_spectator_enabled(const StringName glasses_id, bool is_enabled);
+	bool is_spectator_enabled(const StringName glasses_id);
+
+	// Reads back the left eye of each frame the glasses render into a
+	// texture the main window can show. Forward+ and Mobile only.
+	void set_mirror_enabled(const StringName glasses_id, bool is_enabled);
+	bool is_mirror_enabled(const StringName glasses_id);
+	// Null until the first frame is read back. The same texture is
+	// updated with each frame, call it from _process to keep it current.
+	Ref<Texture2D> get_mirror_texture(const StringName glasses_id);
+
 	// Overriden from XRInterfaceExtension
 	virtual StringName _get_name() const override;
 	virtual uint32_t _get_capabilities() const override;
@@ -129,6 +235,7 @@ public:
 	virtual Transform3D _get_transform_for_view(uint32_t view, const Transform3D &cam_transform) override;
 	virtual PackedFloat64Array _get_projection_for_view(uint32_t view, double aspect, double z_near, double z_far) override;
 
+	virtual void _pre_render() override;
 	virtual bool _pre_draw_viewport(const RID &render_target);
 	virtual void _post_draw_viewport(const RID &render_target, const Rect2 &screen_rect) override;
 	virtual void _end_frame() override;
@@ -154,26 +261,59 @@ protected:
 	void _stop_display(GlassesIndexEntry &entry);
 
 	GlassesIndexEntry *lookup_glasses_entry(StringName glasses_id);
-	GlassesIndexEntry *lookup_glasses_by_render_target(RID render_target);
-	GlassesIndexEntry *lookup_glasses_by_viewport(RID render_target);
+	RenderEntry *lookup_glasses_by_render_target(RID render_target);
+
+	void _viewport_exited(int glasses_idx);
+	double _get_frame_monitor(int glasses_idx, int monitor);
+	double _get_metric(int monitor_idx);
 
 private:
 	void log_service_events();
 	void log_glasses_events();
 
+	void apply_dynamic_resolution(GlassesIndexEntry &entry, bool is_enabled);
+	void update_render_scale_limits();
+	bool update_render_scale(RenderEntry &entry, GodotT5Glasses &glasses);
+	void apply_render_scales(const std::vector<float> &render_scales);
+	void publish_render_entries();
+
+	// Each glasses' FrameStats, under "Tilt Five <glasses id>"
+	void add_frame_monitors(GlassesIndexEntry &entry);
+	void remove_frame_monitors();
+	// The service wide metrics, under "Tilt Five"
+	void add_metric_monitors();
+	void remove_metric_monitors();
+
 	bool _initialised = false;
 	XRServer *xr_server = nullptr;
 
 	String application_id;
 	String application_version;
 	float _trigger_click_threshold = 0.5;
+	float _standby_grace_period = 10.0;
+	int _swap_chain_depth = GodotT5Integration::g_swap_chain_length;
+	bool _is_dynamic_resolution = false;
+	float _render_scale_min = 0.5;
+	float _render_scale_max = 1.0;
+	float _target_frame_rate = 60.0;
 	bool _is_debug_logging = false;
 
 	std::vector<GlassesIndexEntry> _glasses_index;
+	// Positions in _glasses_index by glasses id
+	godot::HashMap<StringName, int> _glasses_id_index;
+	// Only used by the render thread, taken in _pre_render
+	Handoff<RenderEntries> _render_entries_handoff;
+	RenderEntries _render_entries;
+	// Render scales by glasses index, published by the render thread
+	// when one changes and applied to the viewports in _process
+	Handoff<std::vector<float>> _render_scale_handoff;
 	std::vector<GlassesEvent> _glasses_events;
 	std::vector<T5ServiceEvent> _service_events;
 
 	GodotT5Service::Ptr t5_service;
+	// Kept after the service is released, the render thread may
+	// still be timing a frame
+	FrameTimer::Ptr _frame_timer;
 
 	GodotT5Glasses::Ptr _render_glasses;
 
@@ -183,5 +323,6 @@ private:
 VARIANT_ENUM_CAST(TiltFiveXRInterface::GameBoardType)
 VARIANT_ENUM_CAST(TiltFiveXRInterface::ServiceEventType);
 VARIANT_ENUM_CAST(TiltFiveXRInterface::GlassesEventType);
+VARIANT_ENUM_CAST(TiltFiveXRInterface::RenderRateType);
 
 #endif // ! TILT_FIVE_XR_INTERFACE_H
\ No newline at end of file
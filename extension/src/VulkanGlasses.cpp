@@ -1,6 +1,7 @@
 #include <ObjectRegistry.h>
 #include <VulkanGlasses.h>
 #include <Wand.h>
+#include <godot_cpp/classes/engine.hpp>
 #include <godot_cpp/classes/rd_texture_format.hpp>
 #include <godot_cpp/classes/rd_texture_view.hpp>
 #include <godot_cpp/classes/rendering_device.hpp>
@@ -8,6 +9,7 @@
 #include <godot_cpp/classes/xr_server.hpp>
 #include <godot_cpp/core/error_macros.hpp>
 
+using godot::Engine;
 using godot::RDTextureFormat;
 using godot::RDTextureView;
 using godot::RenderingDevice;
@@ -18,13 +20,12 @@ namespace GodotT5Integration {
 
 VulkanGlasses::VulkanGlasses(std::string_view id) :
 		GodotT5Glasses(id) {
-	_swap_chain_textures.resize(g_swap_chain_length);
 }
 
-void VulkanGlasses::SwapChainTextures::allocate_textures(int width, int height) {
-	if (is_allocated)
-		deallocate_textures();
+VulkanGlasses::~VulkanGlasses() {
+}
 
+VulkanGlasses::SwapChainTextures::SwapChainTextures(int width, int height) {
 	auto render_server = RenderingServer::get_singleton();
 	auto render_device = render_server->get_rendering_device();
 
@@ -53,16 +54,13 @@ void VulkanGlasses::SwapChainTextures::allocate_textures(int width, int height)
 
 	left_tex_handle = render_device->get_driver_resource(RenderingDevice::DRIVER_RESOURCE_VULKAN_IMAGE_VIEW, left_eye_tex, 0);
 	right_tex_handle = render_device->get_driver_resource(RenderingDevice::DRIVER_RESOURCE_VULKAN_IMAGE_VIEW, right_eye_tex, 0);
-
-	is_allocated = true;
 }
 
-void VulkanGlasses::SwapChainTextures::deallocate_textures() {
-	if (!is_allocated)
-		return;
-
+VulkanGlasses::SwapChainTextures::~SwapChainTextures() {
 	auto render_server = RenderingServer::get_singleton();
-	auto render_device = render_server->get_rendering_device();
+	auto render_device = render_server ? render_server->get_rendering_device() : nullptr;
+	if (!render_device)
+		return;
 
 	if (right_eye_tex.is_valid())
 		render_device->free_rid(right_eye_tex);
@@ -70,36 +68,29 @@ void VulkanGlasses::SwapChainTextures::deallocate_textures() {
 		render_device->free_rid(left_eye_tex);
 	if (render_tex.is_valid())
 		render_device->free_rid(render_tex);
-
-	left_tex_handle = 0;
-	right_tex_handle = 0;
-
-	is_allocated = false;
 }
 
 void VulkanGlasses::allocate_textures() {
-	auto render_server = RenderingServer::get_singleton();
-	auto render_device = render_server->get_rendering_device();
-
 	int width, height;
 	Glasses::get_display_size(width, height);
-	for (int i = 0; i < _swap_chain_textures.size(); i++) {
-		_swap_chain_textures[i].allocate_textures(width, height);
+	// The textures belong to the swap chain, which frees them once
+	// the renderer has moved on to the next one
+	for (int i = 0; i < get_swap_chain_size(); i++) {
+		auto textures = std::make_shared<SwapChainTextures>(width, height);
 		set_swap_chain_texture_pair(
 				i,
-				reinterpret_cast<intptr_t>(&_swap_chain_textures[i].left_tex_handle),
-				reinterpret_cast<intptr_t>(&_swap_chain_textures[i].right_tex_handle));
+				reinterpret_cast<intptr_t>(&textures->left_tex_handle),
+				reinterpret_cast<intptr_t>(&textures->right_tex_handle));
+		set_swap_chain_resources(i, textures);
 	}
 
 	set_upside_down_texture(true);
 }
 
 void VulkanGlasses::deallocate_textures() {
-	auto render_server = RenderingServer::get_singleton();
-
-	for (int i = 0; i < _swap_chain_textures.size(); i++) {
-		_swap_chain_textures[i].deallocate_textures();
+	for (int i = 0; i < get_swap_chain_size(); i++) {
 		set_swap_chain_texture_pair(i, 0, 0);
+		set_swap_chain_resources(i, nullptr);
 	}
 }
 
@@ -111,8 +102,50 @@ void VulkanGlasses::on_stop_display() {
 	deallocate_textures();
 }
 
+uint64_t VulkanGlasses::get_render_frame() {
+	return Engine::get_singleton()->get_frames_drawn();
+}
+
+int VulkanGlasses::get_frames_in_flight() {
+	// The copy queued by t5SendFrameToGlasses is covered by the
+	// fence Godot waits on before reusing that frame's resources
+	auto render_device = RenderingServer::get_singleton()->get_rendering_device();
+	return render_device ? render_device->get_frame_delay() : 0;
+}
+
+bool VulkanGlasses::update_mirror() {
+	if (!is_mirror_enabled())
+		return true;
+
+	auto source = static_cast<SwapChainTextures*>(get_frame_resources());
+	if (!source)
+		return false;
+
+	auto render_device = RenderingServer::get_singleton()->get_rendering_device();
+	ERR_FAIL_NULL_V(render_device, false);
+
+	int width, height;
+	Glasses::get_display_size(width, height);
+
+	// Godot 4.1 can't show a RenderingDevice texture on a Texture2D, so
+	// the left eye layer is read back. This waits for the GPU to finish
+	// the frame.
+	auto data = render_device->texture_get_data(source->render_tex, 0);
+	ERR_FAIL_COND_V(data.size() != width * height * 4, false);
+	_mirror_handoff.publish(Image::create_from_data(width, height, false, Image::FORMAT_RGBA8, data));
+	return true;
+}
+
+Ref<Image> VulkanGlasses::get_mirror_image() {
+	Ref<Image> image;
+	_mirror_handoff.take(image);
+	return image;
+}
+
 RID VulkanGlasses::get_color_texture() {
-	int current_frame = get_current_frame_idx();
-	return _swap_chain_textures[current_frame].render_tex;
+	// The renderer takes swap chain changes a frame late
+	auto textures = static_cast<SwapChainTextures*>(get_frame_resources());
+	ERR_FAIL_NULL_V(textures, RID());
+	return textures->render_tex;
 }
 } //namespace GodotT5Integration
\ No newline at end of file
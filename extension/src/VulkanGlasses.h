@@ -1,30 +1,37 @@
 #pragma once
 #include <GodotT5Glasses.h>
+#include <Handoff.h>
 #include <godot_cpp/variant/rid.hpp>
 
 using godot::RID;
+using T5Integration::Handoff;
 
 namespace GodotT5Integration {
 
 class VulkanGlasses : public GodotT5Glasses {
-	struct SwapChainTextures {
-		void allocate_textures(int width, int height);
-		void deallocate_textures();
+	// The swap chain is handed the addresses of the image view
+	// handles, which stay put for the life of the textures
+	struct SwapChainTextures : public SwapChainResources {
+		SwapChainTextures(int width, int height);
+		~SwapChainTextures() override;
 
-		bool is_allocated = false;
 		RID render_tex;
 		RID left_eye_tex;
 		RID right_eye_tex;
 
-		intptr_t left_tex_handle;
-		intptr_t right_tex_handle;
+		intptr_t left_tex_handle = 0;
+		intptr_t right_tex_handle = 0;
 	};
 
 public:
 	VulkanGlasses(std::string_view id);
+	virtual ~VulkanGlasses();
 
 	virtual RID get_color_texture() override;
 
+	virtual bool update_mirror() override;
+	virtual Ref<Image> get_mirror_image() override;
+
 private:
 	void allocate_textures();
 	void deallocate_textures();
@@ -32,7 +39,11 @@ private:
 	virtual void on_start_display() override;
 	virtual void on_stop_display() override;
 
+	virtual uint64_t get_render_frame() override;
+	virtual int get_frames_in_flight() override;
+
 private:
-	std::vector<SwapChainTextures> _swap_chain_textures;
+	// Read back by the renderer for the main thread
+	Handoff<Ref<Image>> _mirror_handoff;
 };
 } //namespace GodotT5Integration
@@ -1,3 +1,4 @@
+#include <GodotT5Glasses.h>
 #include <T5Camera3D.h>
 #include <T5Controller3D.h>
 #include <T5Gameboard.h>
@@ -22,12 +23,15 @@ void initialize_tiltfive_types(ModuleInitializationLevel p_level) {
 	ClassDB::register_class<T5Node3D>();
 	ClassDB::register_class<T5Controller3D>();
 	ClassDB::register_class<T5Gameboard>();
+
+	GodotT5Integration::initialize_tracker_names();
 }
 
 void uninitialize_tiltfive_types(ModuleInitializationLevel p_level) {
 	if (p_level != MODULE_INITIALIZATION_LEVEL_SCENE) {
 		return;
 	}
+	GodotT5Integration::uninitialize_tracker_names();
 }
 
 extern "C" {